@@ -35,6 +35,7 @@
 
 #include <pdal/GDALUtils.hpp>
 #include <pdal/Kernel.hpp>
+#include <pdal/PluginDirectory.hpp>
 #include <pdal/PluginManager.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/pdal_config.hpp>
@@ -87,6 +88,7 @@ private:
     std::string m_showOptions;
     bool m_showJSON;
     std::string m_log;
+    std::string m_pluginManifest;
 };
 
 
@@ -283,6 +285,8 @@ void App::addArgs(ProgramArgs& args)
     Arg& json = args.add("showjson", "List options or drivers as JSON output",
         m_showJSON);
     json.setHidden();
+    args.add("plugin-manifest", "Write a manifest of the plugins in the "
+        "specified directory", m_pluginManifest);
 }
 
 namespace
@@ -393,7 +397,19 @@ int App::execute(StringList& cmdArgs, LogPtr& log)
         return ret;
     }
 
-    if (m_showVersion)
+    if (m_pluginManifest.size())
+    {
+        try
+        {
+            PluginDirectory::writeManifest(m_pluginManifest);
+        }
+        catch (const pdal_error& err)
+        {
+            Utils::printError(err.what());
+            return 1;
+        }
+    }
+    else if (m_showVersion)
         outputVersion();
     else if (m_showDrivers)
         outputDrivers();
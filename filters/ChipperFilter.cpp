@@ -60,9 +60,17 @@ This procedure is then recursively applied to the created blocks until
 they contains only one or two partitions.  In the case of one or two
 partitions we are done, and we simply store away the contents of the
 blocks.
+
+Each block touches only its own range of the arrays, so large blocks are
+split on separate threads.  The point indices of finished blocks are
+stored in a single permutation array, from which the output views are
+created once all blocks are done.
 **/
 
+#include <algorithm>
+
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -78,10 +86,83 @@ CREATE_STATIC_STAGE(ChipperFilter, s_info)
 
 std::string ChipperFilter::getName() const { return s_info.name; }
 
+
+bool ChipperFilter::usedDimensions(StringList& dims) const
+{
+    dims = { "X", "Y" };
+    return true;
+}
+
+namespace
+{
+
+// Blocks with fewer points than this are split on the current thread.
+const PointId MinParallelSplit = 100000;
+
+// Run func(begin, end) over [0, size) in roughly equal ranges, one per
+// thread in the pool.
+template<typename FUNC>
+void parallelFor(ThreadPool& pool, size_t size, FUNC func)
+{
+    if (size == 0)
+        return;
+    size_t chunk = (size + pool.numThreads() - 1) / pool.numThreads();
+    for (size_t begin = 0; begin < size; begin += chunk)
+    {
+        size_t end = (std::min)(begin + chunk, size);
+        pool.add([&func, begin, end](){ func(begin, end); });
+    }
+    pool.await();
+}
+
+// Sort the references by position.  Ranges are sorted on separate threads
+// and then merged pairwise.
+void sortRefs(std::vector<ChipPtRef>& v, ThreadPool& pool)
+{
+    if (v.empty())
+        return;
+    std::vector<size_t> bounds;
+    size_t chunk = (v.size() + pool.numThreads() - 1) / pool.numThreads();
+    for (size_t begin = 0; begin < v.size(); begin += chunk)
+    {
+        size_t end = (std::min)(begin + chunk, v.size());
+        bounds.push_back(begin);
+        pool.add([&v, begin, end]()
+            { std::sort(v.begin() + begin, v.begin() + end); });
+    }
+    bounds.push_back(v.size());
+    pool.await();
+
+    while (bounds.size() > 2)
+    {
+        std::vector<size_t> next;
+        size_t ranges = bounds.size() - 1;
+        for (size_t r = 0; r + 1 < ranges; r += 2)
+        {
+            auto begin = v.begin() + bounds[r];
+            auto middle = v.begin() + bounds[r + 1];
+            auto end = v.begin() + bounds[r + 2];
+            pool.add([begin, middle, end]()
+                { std::inplace_merge(begin, middle, end); });
+            next.push_back(bounds[r]);
+        }
+        if (ranges % 2)
+            next.push_back(bounds[ranges - 1]);
+        next.push_back(v.size());
+        pool.await();
+        bounds.swap(next);
+    }
+}
+
+} // unnamed namespace
+
+
 void ChipperFilter::addArgs(ProgramArgs& args)
 {
     args.add("capacity", "Maximum number of points per cell", m_threshold,
         (PointId) 5000u);
+    args.add("threads", "Number of threads used for chipping (0 uses all "
+        "available hardware threads)", m_threads, (size_t)0);
 }
 
 
@@ -91,52 +172,55 @@ PointViewSet ChipperFilter::run(PointViewPtr view)
         return m_outViews;
 
     m_inView = view;
-    load(*view.get(), m_xvec, m_yvec, m_spare);
+    ThreadPool pool(m_threads);
+    load(*view.get(), m_xvec, m_yvec, m_spare, pool);
     partition(m_xvec.size());
-    decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1);
+    m_perm.resize(m_xvec.size());
+    decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1, pool);
+    pool.await();
+    makeViews();
     return m_outViews;
 }
 
 
 void ChipperFilter::load(PointView& view, ChipRefList& xvec, ChipRefList& yvec,
-    ChipRefList& spare)
+    ChipRefList& spare, ThreadPool& pool)
 {
-    point_count_t idx;
-    std::vector<ChipPtRef>::iterator it;
-
-    xvec.reserve(view.size());
-    yvec.reserve(view.size());
+    xvec.resize(view.size());
+    yvec.resize(view.size());
     spare.resize(view.size());
 
-    for (PointId i = 0; i < view.size(); ++i)
+    parallelFor(pool, view.size(), [&](size_t begin, size_t end)
     {
-        ChipPtRef xref;
-
-        xref.m_pos = view.getFieldAs<double>(Dimension::Id::X, i);
-        xref.m_ptindex = i;
-        xvec.push_back(xref);
-
-        ChipPtRef yref;
+        for (PointId i = begin; i < end; ++i)
+        {
+            ChipPtRef& xref = xvec[i];
+            xref.m_pos = view.getFieldAs<double>(Dimension::Id::X, i);
+            xref.m_ptindex = i;
 
-        yref.m_pos = view.getFieldAs<double>(Dimension::Id::Y, i);
-        yref.m_ptindex = i;
-        yvec.push_back(yref);
-    }
+            ChipPtRef& yref = yvec[i];
+            yref.m_pos = view.getFieldAs<double>(Dimension::Id::Y, i);
+            yref.m_ptindex = i;
+        }
+    });
 
     // Sort xvec and assign other index in yvec to sorted indices in xvec.
-    std::stable_sort(xvec.begin(), xvec.end());
-    for (size_t i = 0; i < xvec.size(); ++i)
+    sortRefs(xvec.m_vec, pool);
+    parallelFor(pool, xvec.size(), [&](size_t begin, size_t end)
     {
-        idx = xvec[i].m_ptindex;
-        yvec[idx].m_oindex = i;
-    }
+        for (size_t i = begin; i < end; ++i)
+            yvec[xvec[i].m_ptindex].m_oindex = i;
+    });
 
     // Sort yvec.
-    std::stable_sort(yvec.begin(), yvec.end());
+    sortRefs(yvec.m_vec, pool);
 
     // Iterate through the yvector, setting the xvector appropriately.
-    for (size_t i = 0; i < yvec.size(); ++i)
-        xvec[yvec[i].m_oindex].m_oindex = i;
+    parallelFor(pool, yvec.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            xvec[yvec[i].m_oindex].m_oindex = i;
+    });
 }
 
 
@@ -171,6 +255,7 @@ void ChipperFilter::partition(point_count_t size)
     // distributed among the partitions.
     double total(0.0);
     double partition_size = static_cast<double>(size) / num_partitions;
+    m_partitions.clear();
     m_partitions.push_back(0);
     for (size_t i = 0; i < num_partitions; ++i)
     {
@@ -182,7 +267,7 @@ void ChipperFilter::partition(point_count_t size)
 
 
 void ChipperFilter::decideSplit(ChipRefList& v1, ChipRefList& v2, ChipRefList& spare,
-    PointId pleft, PointId pright)
+    PointId pleft, PointId pright, ThreadPool& pool)
 {
     double v1range;
     double v2range;
@@ -194,13 +279,13 @@ void ChipperFilter::decideSplit(ChipRefList& v1, ChipRefList& v2, ChipRefList& s
     v1range = v1[right].m_pos - v1[left].m_pos;
     v2range = v2[right].m_pos - v2[left].m_pos;
     if (v1range > v2range)
-        split(v1, v2, spare, pleft, pright);
+        split(v1, v2, spare, pleft, pright, pool);
     else
-        split(v2, v1, spare, pleft, pright);
+        split(v2, v1, spare, pleft, pright, pool);
 }
 
 void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& spare,
-    PointId pleft, PointId pright)
+    PointId pleft, PointId pright, ThreadPool& pool)
 {
     PointId lstart;
     PointId rstart;
@@ -252,18 +337,35 @@ void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& s
             }
         }
 
-        decideSplit(wide, spare, narrow, pleft, pcenter);
-        decideSplit(wide, spare, narrow, pcenter, pright);
+        // The two halves are independent, so hand one off to another
+        // thread if it's big enough to be worth it.
+        if (right - left + 1 >= MinParallelSplit)
+            pool.add([this, &wide, &spare, &narrow, pleft, pcenter, &pool]()
+                { decideSplit(wide, spare, narrow, pleft, pcenter, pool); });
+        else
+            decideSplit(wide, spare, narrow, pleft, pcenter, pool);
+        decideSplit(wide, spare, narrow, pcenter, pright, pool);
     }
 }
 
 void ChipperFilter::emit(ChipRefList& wide, PointId widemin, PointId widemax)
 {
-    PointViewPtr view = m_inView->makeNew();
-    for (size_t idx = widemin; idx <= widemax; ++idx)
-        view->appendPoint(*m_inView.get(), wide[idx].m_ptindex);
+    for (PointId idx = widemin; idx <= widemax; ++idx)
+        m_perm[idx] = wide[idx].m_ptindex;
+}
 
-    m_outViews.insert(view);
+
+// Create the output views in partition order, which is the order in which
+// the chips were emitted when splitting was done serially.
+void ChipperFilter::makeViews()
+{
+    for (size_t p = 0; p + 1 < m_partitions.size(); ++p)
+    {
+        PointViewPtr view = m_inView->makeNew();
+        for (PointId idx = m_partitions[p]; idx < m_partitions[p + 1]; ++idx)
+            view->appendPoint(*m_inView.get(), m_perm[idx]);
+        m_outViews.insert(view);
+    }
 }
 
 } // namespace pdal
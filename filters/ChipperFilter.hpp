@@ -49,6 +49,7 @@ namespace pdal
 {
 
 class Stage;
+class ThreadPool;
 
 
 class PDAL_DLL ChipperFilter;
@@ -64,9 +65,12 @@ private:
     uint32_t m_oindex;
 
 public:
+    // Ties are broken by point index so that an unstable sort of
+    // references in point order gives the same result as a stable sort.
     bool operator < (const ChipPtRef& pt) const
     {
-        return m_pos < pt.m_pos;
+        return m_pos < pt.m_pos ||
+            (m_pos == pt.m_pos && m_ptindex < pt.m_ptindex);
     }
 };
 
@@ -114,24 +118,30 @@ class PDAL_DLL ChipperFilter : public pdal::Filter
 public:
     ChipperFilter() {}
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual PointViewSet run(PointViewPtr view);
 
     void load(PointView& view, ChipRefList& xvec,
-        ChipRefList& yvec, ChipRefList& spare);
+        ChipRefList& yvec, ChipRefList& spare, ThreadPool& pool);
     void partition(point_count_t size);
     void decideSplit(ChipRefList& v1, ChipRefList& v2,
-        ChipRefList& spare, PointId left, PointId right);
+        ChipRefList& spare, PointId left, PointId right, ThreadPool& pool);
     void split(ChipRefList& wide, ChipRefList& narrow,
-        ChipRefList& spare, PointId left, PointId right);
+        ChipRefList& spare, PointId left, PointId right, ThreadPool& pool);
     void emit(ChipRefList& wide, PointId widemin, PointId widemax);
+    void makeViews();
 
     PointId m_threshold;
+    size_t m_threads;
     PointViewPtr m_inView;
     PointViewSet m_outViews;
     std::vector<PointId> m_partitions;
+    // Point indices ordered such that the points of each chip are
+    // contiguous.  Chip N is [m_partitions[N], m_partitions[N + 1]).
+    std::vector<PointId> m_perm;
     ChipRefList m_xvec;
     ChipRefList m_yvec;
     ChipRefList m_spare;
@@ -67,6 +67,65 @@ CropFilter::ViewGeom::ViewGeom(ViewGeom&& vg) :
 
 std::string CropFilter::getName() const { return s_info.name; }
 
+
+bool CropFilter::usedDimensions(StringList& dims) const
+{
+    dims = { "X", "Y", "Z" };
+    return true;
+}
+
+
+// Points outside the bounds of every crop region are discarded.  Regions
+// with an assigned SRS may be reprojected to the SRS of the points, so
+// they don't limit the hint.
+bool CropFilter::readHint(ReadHint& hint) const
+{
+    StringList outside = m_options.getValues("outside");
+    if (outside.size() && Utils::tolower(outside.front()) != "false")
+        return true;
+    if (m_options.getValues("a_srs").size())
+        return true;
+
+    BOX2D region;
+    try
+    {
+        for (const std::string& s : m_options.getValues("bounds"))
+        {
+            Bounds bounds;
+            std::istringstream iss(s);
+            if (!(iss >> bounds))
+                return true;
+            region.grow(bounds.to2d());
+        }
+        for (const std::string& s : m_options.getValues("polygon"))
+            region.grow(Polygon(s).bounds().to2d());
+
+        StringList centers = m_options.getValues("point");
+        if (centers.size())
+        {
+            StringList distance = m_options.getValues("distance");
+            double d;
+            if (distance.empty() || !Utils::fromString(distance.front(), d))
+                return true;
+            for (const std::string& s : centers)
+            {
+                filter::Point center;
+                center.update(s);
+                region.grow(BOX2D(center.x - d, center.y - d,
+                    center.x + d, center.y + d));
+            }
+        }
+    }
+    catch (const pdal_error&)
+    {
+        // Invalid regions are reported when options are processed.
+        return true;
+    }
+    if (!region.empty())
+        hint.limit(region);
+    return true;
+}
+
 CropFilter::CropFilter() : m_cropOutside(false)
 {}
 
@@ -56,6 +56,8 @@ public:
     CropFilter();
     ~CropFilter();
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
+    virtual bool readHint(ReadHint& hint) const;
 
 private:
     // This is just a way to marry a (multi)polygon with a list of its
@@ -51,6 +51,12 @@ CREATE_STATIC_STAGE(DecimationFilter, s_info)
 
 std::string DecimationFilter::getName() const { return s_info.name; }
 
+
+bool DecimationFilter::usedDimensions(StringList& /*dims*/) const
+{
+    return true;
+}
+
 void DecimationFilter::addArgs(ProgramArgs& args)
 {
     args.add("step", "Points to delete between each kept point", m_step, 1U);
@@ -48,6 +48,7 @@ public:
         {}
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     uint32_t m_step;
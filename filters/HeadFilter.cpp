@@ -50,4 +50,10 @@ std::string HeadFilter::getName() const
     return s_info.name;
 }
 
+
+bool HeadFilter::usedDimensions(StringList& /*dims*/) const
+{
+    return true;
+}
+
 } // namespace pdal
@@ -48,6 +48,18 @@ CREATE_STATIC_STAGE(MergeFilter, s_info)
 
 std::string MergeFilter::getName() const { return s_info.name; }
 
+
+bool MergeFilter::usedDimensions(StringList& /*dims*/) const
+{
+    return true;
+}
+
+
+bool MergeFilter::readHint(ReadHint& /*hint*/) const
+{
+    return true;
+}
+
 void MergeFilter::ready(PointTableRef table)
 {
     SpatialReference srs = getSpatialReference();
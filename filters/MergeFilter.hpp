@@ -47,6 +47,8 @@ public:
     {}
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
+    virtual bool readHint(ReadHint& hint) const;
 
 private:
     PointViewPtr m_view;
@@ -63,6 +63,76 @@ std::string RangeFilter::getName() const
 }
 
 
+bool RangeFilter::usedDimensions(StringList& dims) const
+{
+    for (const std::string& spec : m_options.getValues("limits"))
+    {
+        for (std::string r : Utils::split2(spec, ','))
+        {
+            Utils::trim(r);
+            try
+            {
+                DimRange range;
+                range.parse(r);
+                dims.push_back(range.m_name);
+            }
+            catch (const DimRange::error&)
+            {
+                // Reported when options are processed.
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// Ranges on the same dimension are combined with "or", so a dimension is
+// limited to the union of its ranges unless one of them is negated.
+bool RangeFilter::readHint(ReadHint& hint) const
+{
+    struct Limit
+    {
+        Limit() : m_min((std::numeric_limits<double>::max)()),
+            m_max(std::numeric_limits<double>::lowest()), m_negated(false)
+        {}
+
+        double m_min;
+        double m_max;
+        bool m_negated;
+    };
+
+    std::map<Dimension::Id, Limit> limits;
+    for (const std::string& spec : m_options.getValues("limits"))
+    {
+        for (std::string r : Utils::split2(spec, ','))
+        {
+            Utils::trim(r);
+            DimRange range;
+            try
+            {
+                range.parse(r);
+            }
+            catch (const DimRange::error&)
+            {
+                return true;
+            }
+            Dimension::Id id = Dimension::id(range.m_name);
+            if (id == Dimension::Id::Unknown)
+                continue;
+            Limit& l = limits[id];
+            l.m_min = (std::min)(l.m_min, range.m_lower_bound);
+            l.m_max = (std::max)(l.m_max, range.m_upper_bound);
+            l.m_negated = l.m_negated || range.m_negate;
+        }
+    }
+    for (auto& l : limits)
+        if (!l.second.m_negated)
+            hint.limit(l.first, l.second.m_min, l.second.m_max);
+    return true;
+}
+
+
 RangeFilter::RangeFilter()
 {}
 
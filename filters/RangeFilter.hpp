@@ -53,6 +53,8 @@ public:
     ~RangeFilter();
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
+    virtual bool readHint(ReadHint& hint) const;
 
 private:
     StringList m_rangeSpec;
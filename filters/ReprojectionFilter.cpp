@@ -57,6 +57,13 @@ CREATE_STATIC_STAGE(ReprojectionFilter, s_info)
 
 std::string ReprojectionFilter::getName() const { return s_info.name; }
 
+
+bool ReprojectionFilter::usedDimensions(StringList& dims) const
+{
+    dims = { "X", "Y", "Z" };
+    return true;
+}
+
 ReprojectionFilter::ReprojectionFilter()
     : m_inferInputSRS(true)
     , m_in_ref_ptr(NULL)
@@ -54,6 +54,7 @@ public:
     ~ReprojectionFilter();
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     virtual void addArgs(ProgramArgs& args);
@@ -48,6 +48,13 @@ CREATE_STATIC_STAGE(SortFilter, s_info)
 
 std::string SortFilter::getName() const { return s_info.name; }
 
+
+bool SortFilter::usedDimensions(StringList& dims) const
+{
+    dims = m_options.getValues("dimension");
+    return true;
+}
+
 void SortFilter::addArgs(ProgramArgs& args)
 {
     args.add("dimension", "Dimension on which to sort", m_dimName).
@@ -58,6 +58,7 @@ public:
     {}
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     // Dimension on which to sort.
@@ -38,6 +38,8 @@
 #include <iostream>
 #include <limits>
 
+#include <pdal/Reader.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 namespace pdal
@@ -52,7 +54,98 @@ static StaticPluginInfo const s_info
 
 CREATE_STATIC_STAGE(SplitterFilter, s_info)
 
-SplitterFilter::SplitterFilter() : m_viewMap(CoordCompare())
+namespace
+{
+
+// Reader that streams the packed points of a single tile back out of
+// its spill file so that they can be handed to the tile's writer.
+class SpillReader : public Reader, public Streamable
+{
+public:
+    SpillReader(const std::string& filename, const DimTypeList& srcDims,
+            const std::vector<std::string>& names,
+            const SpatialReference& srs) :
+        m_spillFilename(filename), m_srcDims(srcDims), m_names(names),
+        m_srs(srs), m_in(nullptr)
+    {}
+
+    ~SpillReader()
+        { FileUtils::closeFile(m_in); }
+
+    std::string getName() const
+        { return "readers.splitterspill"; }
+
+private:
+    std::string m_spillFilename;
+    DimTypeList m_srcDims;
+    std::vector<std::string> m_names;
+    SpatialReference m_srs;
+    DimTypeList m_dims;
+    std::vector<char> m_buf;
+    std::istream *m_in;
+
+    virtual void initialize()
+        { setSpatialReference(m_srs); }
+
+    virtual void addDimensions(PointLayoutPtr layout)
+    {
+        m_dims.clear();
+        size_t size = 0;
+        for (size_t i = 0; i < m_srcDims.size(); ++i)
+        {
+            Dimension::Type type = m_srcDims[i].m_type;
+            Dimension::Id id = layout->registerOrAssignDim(m_names[i], type);
+            m_dims.push_back(DimType(id, type));
+            size += Dimension::size(type);
+        }
+        m_buf.resize(size);
+    }
+
+    virtual void ready(PointTableRef)
+    {
+        FileUtils::closeFile(m_in);
+        m_in = FileUtils::openFile(m_spillFilename);
+        if (!m_in)
+            throwError("Unable to open spill file '" + m_spillFilename +
+                "'.");
+    }
+
+    bool readPoint()
+    {
+        m_in->read(m_buf.data(), m_buf.size());
+        return (bool)*m_in;
+    }
+
+    virtual bool processOne(PointRef& point)
+    {
+        if (!readPoint())
+            return false;
+        point.setPackedData(m_dims, m_buf.data());
+        return true;
+    }
+
+    virtual point_count_t read(PointViewPtr view, point_count_t count)
+    {
+        point_count_t cnt = 0;
+        while (cnt < count && readPoint())
+        {
+            view->setPackedPoint(m_dims, view->size(), m_buf.data());
+            cnt++;
+        }
+        return cnt;
+    }
+
+    virtual void done(PointTableRef)
+    {
+        FileUtils::closeFile(m_in);
+        m_in = nullptr;
+    }
+};
+
+} // unnamed namespace
+
+SplitterFilter::SplitterFilter() : m_viewMap(CoordCompare()),
+    m_tiles(CoordCompare())
 {}
 
 std::string SplitterFilter::getName() const { return s_info.name; }
@@ -66,6 +159,16 @@ void SplitterFilter::addArgs(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("buffer", "Size of buffer (overlap) to include around each tile.",
         m_buffer, 0.0);
+    args.add("filename", "Output filename template for tiles written in "
+        "streaming mode.  '#' is replaced with the tile's grid position.",
+        m_outFilename);
+    args.add("writer", "Writer used for tiles written in streaming mode "
+        "(inferred from filename if not set).", m_writerDriver);
+    args.add("max_open", "Maximum number of tile spill files held open "
+        "at once in streaming mode.", m_maxOpen, (size_t)64);
+    args.add("spill_points", "Number of points buffered in memory for each "
+        "tile before being spilled to disk in streaming mode.",
+        m_spillPoints, (point_count_t)5000);
 }
 
 void SplitterFilter::initialize() {
@@ -75,15 +178,104 @@ void SplitterFilter::initialize() {
             ") must be less than half of length (" << m_length << ")";
         throw pdal_error(oss.str());
     }
+    if (m_outFilename.size())
+    {
+        if (m_outFilename.find('#') == std::string::npos)
+            throwError("Option 'filename' must contain a '#' placeholder "
+                "for the tile position.");
+        if (m_writerDriver.empty())
+            m_writerDriver = m_factory.inferWriterDriver(m_outFilename);
+        if (m_writerDriver.empty())
+            throwError("Unable to determine writer for tile output '" +
+                m_outFilename + "'.");
+        if (m_maxOpen == 0)
+            m_maxOpen = 1;
+        if (m_spillPoints == 0)
+            m_spillPoints = 1;
+    }
+}
+
+
+// Streaming requires somewhere to send the tiles, so we only claim to
+// be streamable if an output filename template has been provided.
+bool SplitterFilter::pipelineStreamable() const
+{
+    if (m_options.getValues("filename").empty())
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+
+// Tiles written to files carry all dimensions.
+bool SplitterFilter::usedDimensions(StringList& dims) const
+{
+    if (m_options.getValues("filename").size())
+        return false;
+    dims = { "X", "Y" };
+    return true;
+}
+
+
+void SplitterFilter::ready(PointTableRef table)
+{
+    PointLayoutPtr layout(table.layout());
+
+    m_dims = layout->dimTypes();
+    m_dimNames.clear();
+    size_t size = 0;
+    for (const DimType& dt : m_dims)
+    {
+        m_dimNames.push_back(layout->dimName(dt.m_id));
+        size += Dimension::size(dt.m_type);
+    }
+    m_pointBuf.resize(size);
+}
+
+
+void SplitterFilter::spatialReferenceChanged(const SpatialReference& srs)
+{
+    m_srs = srs;
+}
+
+
+template<typename ADDFUNC>
+void SplitterFilter::split(double x, double y, ADDFUNC addPoint)
+{
+    double dx = x - m_xOrigin;
+    int xpos = dx / m_length;
+    if (dx < 0)
+        xpos--;
+
+    double dy = y - m_yOrigin;
+    int ypos = dy / m_length;
+    if (dy < 0)
+        ypos--;
+
+    addPoint(xpos, ypos);
+
+    if (m_buffer > 0.0) {
+        if (squareContains(xpos - 1, ypos, x, y)) {
+            addPoint(xpos - 1, ypos);
+        } else if (squareContains(xpos + 1, ypos, x, y)) {
+            addPoint(xpos + 1, ypos);
+        }
+        if (squareContains(xpos, ypos - 1, x, y)) {
+            addPoint(xpos, ypos - 1);
+        } else if (squareContains(xpos, ypos + 1, x, y)) {
+            addPoint(xpos, ypos + 1);
+        }
+    }
 }
 
+
 PointViewSet SplitterFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
 
-    auto addPoint = [this, &inView](PointId idx, int xpos, int ypos) {
+    PointId idx;
+    auto addPoint = [this, &inView, &idx](int xpos, int ypos) {
         Coord loc(xpos, ypos);
         PointViewPtr& outView = m_viewMap[loc];
         if (!outView)
@@ -100,34 +292,11 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
     // Overlay a grid of squares on the points (m_length sides).  Each square
     // corresponds to a new point buffer.  Place the points falling in the
     // each square in the corresponding point buffer.
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    for (idx = 0; idx < inView->size(); idx++)
     {
         double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
-        double dx = x - m_xOrigin;
-        int xpos = dx / m_length;
-        if (dx < 0)
-            xpos--;
-
         double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
-        double dy = y - m_yOrigin;
-        int ypos = dy / m_length;
-        if (dy < 0)
-            ypos--;
-
-        addPoint(idx, xpos, ypos);
-
-        if (m_buffer > 0.0) {
-            if (squareContains(xpos - 1, ypos, x, y)) {
-                addPoint(idx, xpos - 1, ypos);
-            } else if (squareContains(xpos + 1, ypos, x, y)) {
-                addPoint(idx, xpos + 1, ypos);
-            }
-            if (squareContains(xpos, ypos - 1, x, y)) {
-                addPoint(idx, xpos, ypos - 1);
-            } else if (squareContains(xpos, ypos + 1, x, y)) {
-                addPoint(idx, xpos, ypos + 1);
-            }
-        }
+        split(x, y, addPoint);
     }
 
     // Pull the buffers out of the map and stick them in the standard
@@ -137,6 +306,148 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
     return viewSet;
 }
 
+
+// In streaming mode, each point is packed into the buffer of the tile(s)
+// in which it falls.  Full buffers are spilled to a per-tile file.  Only
+// m_maxOpen spill files are kept open; the least recently used file is
+// closed when another needs to be opened.  The tiles are written once
+// all points have been seen.
+bool SplitterFilter::processOne(PointRef& point)
+{
+    if (m_outFilename.empty())
+        throwError("Option 'filename' must be set to split points in "
+            "streaming mode.");
+
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+
+    if (m_xOrigin != m_xOrigin)
+        m_xOrigin = x;
+    if (m_yOrigin != m_yOrigin)
+        m_yOrigin = y;
+
+    point.getPackedData(m_dims, m_pointBuf.data());
+    auto addPoint = [this](int xpos, int ypos)
+    {
+        Coord loc(xpos, ypos);
+        auto it = m_tiles.find(loc);
+        if (it == m_tiles.end())
+        {
+            it = m_tiles.insert(std::make_pair(loc, Tile())).first;
+            Tile& tile = it->second;
+            tile.m_filename = tileFilename(loc);
+            tile.m_spillFilename = tile.m_filename + ".spill";
+            FileUtils::deleteFile(tile.m_spillFilename);
+            tile.m_buf.reserve(m_pointBuf.size() * m_spillPoints);
+        }
+        Tile& tile = it->second;
+        tile.m_buf.insert(tile.m_buf.end(), m_pointBuf.begin(),
+            m_pointBuf.end());
+        tile.m_count++;
+        if (tile.m_buf.size() >= m_pointBuf.size() * m_spillPoints)
+            spill(tile);
+    };
+    split(x, y, addPoint);
+    return true;
+}
+
+
+std::string SplitterFilter::tileFilename(const Coord& loc) const
+{
+    std::string filename(m_outFilename);
+    std::string pos = std::to_string(loc.first) + "_" +
+        std::to_string(loc.second);
+    return filename.replace(filename.find('#'), 1, pos);
+}
+
+
+void SplitterFilter::spill(Tile& tile)
+{
+    if (tile.m_buf.empty())
+        return;
+
+    if (tile.m_spill)
+        m_openTiles.remove(&tile);
+    else
+    {
+        if (m_openTiles.size() >= m_maxOpen)
+        {
+            Tile *lru = m_openTiles.back();
+            m_openTiles.pop_back();
+            lru->m_spill.reset();
+        }
+        tile.m_spill.reset(new std::ofstream(tile.m_spillFilename,
+            std::ios::out | std::ios::binary | std::ios::app));
+        if (!*tile.m_spill)
+            throwError("Unable to open spill file '" + tile.m_spillFilename +
+                "'.");
+    }
+    m_openTiles.push_front(&tile);
+    tile.m_spill->write(tile.m_buf.data(), tile.m_buf.size());
+    if (!*tile.m_spill)
+        throwError("Error writing spill file '" + tile.m_spillFilename +
+            "'.");
+    tile.m_buf.clear();
+}
+
+
+void SplitterFilter::writeTile(Tile& tile)
+{
+    LogPtr l(log());
+    SpillReader reader(tile.m_spillFilename, m_dims, m_dimNames, m_srs);
+    reader.setLog(l);
+
+    Stage *writer = m_factory.createStage(m_writerDriver);
+    if (!writer)
+        throwError("Unable to create writer '" + m_writerDriver + "'.");
+    writer->setLog(l);
+    Options opts;
+    opts.add("filename", tile.m_filename);
+    writer->setOptions(opts);
+    writer->setInput(reader);
+
+    Streamable *s = dynamic_cast<Streamable *>(writer);
+    if (s && s->pipelineStreamable())
+    {
+        FixedPointTable table(10000);
+        s->prepare(table);
+        s->execute(table);
+    }
+    else
+    {
+        PointTable table;
+        writer->prepare(table);
+        writer->execute(table);
+    }
+    m_factory.destroyStage(writer);
+}
+
+
+void SplitterFilter::done(PointTableRef table)
+{
+    if (m_tiles.empty())
+        return;
+
+    // Flush everything to disk first so that we don't hold the remaining
+    // buffers while writing.
+    for (auto& t : m_tiles)
+        spill(t.second);
+    for (auto& t : m_tiles)
+        t.second.m_spill.reset();
+    m_openTiles.clear();
+
+    for (auto& t : m_tiles)
+    {
+        Tile& tile = t.second;
+        log()->get(LogLevel::Debug) << "Writing " << tile.m_count <<
+            " points to '" << tile.m_filename << "'." << std::endl;
+        writeTile(tile);
+        FileUtils::deleteFile(tile.m_spillFilename);
+    }
+    m_tiles.clear();
+}
+
+
 bool SplitterFilter::squareContains(int xpos, int ypos, double x, double y) const {
     double minx = m_xOrigin + xpos * m_length - m_buffer;
     double maxx = minx + m_length + 2 * m_buffer;
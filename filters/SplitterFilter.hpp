@@ -35,11 +35,17 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/Streamable.hpp>
+
+#include <fstream>
+#include <list>
+#include <memory>
 
 namespace pdal
 {
 
-class PDAL_DLL SplitterFilter : public pdal::Filter
+class PDAL_DLL SplitterFilter : public pdal::Filter, public Streamable
 {
 private:
     //This used to be a lambda, but the VS compiler exploded, I guess.
@@ -56,10 +62,27 @@ private:
         };
     };
 
+    // Points destined for a single tile when running in streaming mode.
+    // Points are packed into m_buf and spilled to m_spillFilename when
+    // the buffer fills.
+    struct Tile
+    {
+        Tile() : m_count(0)
+        {}
+
+        std::string m_filename;
+        std::string m_spillFilename;
+        std::vector<char> m_buf;
+        std::unique_ptr<std::ofstream> m_spill;
+        point_count_t m_count;
+    };
+
 public:
     SplitterFilter();
 
     std::string getName() const;
+    virtual bool pipelineStreamable() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     double m_length;
@@ -68,10 +91,32 @@ private:
     double m_buffer;
     std::map<Coord, PointViewPtr, CoordCompare> m_viewMap;
 
+    // Streaming mode.
+    std::string m_outFilename;
+    std::string m_writerDriver;
+    size_t m_maxOpen;
+    point_count_t m_spillPoints;
+    std::map<Coord, Tile, CoordCompare> m_tiles;
+    std::list<Tile *> m_openTiles;
+    DimTypeList m_dims;
+    std::vector<std::string> m_dimNames;
+    std::vector<char> m_pointBuf;
+    SpatialReference m_srs;
+    StageFactory m_factory;
+
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual void spatialReferenceChanged(const SpatialReference& srs);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    template<typename ADDFUNC>
+    void split(double x, double y, ADDFUNC addPoint);
     bool squareContains(int xpos, int ypos, double x, double y) const;
+    std::string tileFilename(const Coord& loc) const;
+    void spill(Tile& tile);
+    void writeTile(Tile& tile);
 
     SplitterFilter& operator=(const SplitterFilter&); // not implemented
     SplitterFilter(const SplitterFilter&); // not implemented
@@ -41,6 +41,7 @@
 #include <pdal/Polygon.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <json/json.h>
 
@@ -58,6 +59,29 @@ CREATE_STATIC_STAGE(StatsFilter, s_info)
 
 std::string StatsFilter::getName() const { return s_info.name; }
 
+
+// Statistics are computed for all dimensions unless some are listed.
+bool StatsFilter::usedDimensions(StringList& dims) const
+{
+    StringList names = m_options.getValues("dimensions");
+    if (names.empty())
+        return false;
+    for (const char *opt : { "enumerate", "count", "global", "cardinality" })
+    {
+        StringList l = m_options.getValues(opt);
+        names.insert(names.end(), l.begin(), l.end());
+    }
+    for (const std::string& name : names)
+        for (std::string s : Utils::split2(name, ','))
+        {
+            Utils::trim(s);
+            if (s.size())
+                dims.push_back(s);
+        }
+    dims.insert(dims.end(), { "X", "Y", "Z" });
+    return true;
+}
+
 namespace stats
 {
 
@@ -96,6 +120,12 @@ void Summary::extractMetadata(MetadataNode &m)
         computeGlobalStats();
         m.add("median", m_median);
         m.add("mad", m_mad);
+        for (size_t i = 0; i < m_quantileValues.size(); ++i)
+        {
+            MetadataNode q = m.addList("quantiles");
+            q.add("quantile", m_quantiles[i]);
+            q.add("value", m_quantileValues[i]);
+        }
     }
     else if (m_enumerate == Count)
     {
@@ -106,27 +136,137 @@ void Summary::extractMetadata(MetadataNode &m)
             m.addList("counts", val);
         }
     }
+    if (m_cardinality)
+        m.add("cardinality", (uint64_t)std::llround(cardinality()),
+            "estimated number of distinct values");
 }
 
 void Summary::computeGlobalStats()
 {
-    auto compute_median = [](std::vector<double> vals)
+    m_quantileValues.clear();
+    if (m_cnt == 0)
+        return;
+
+    if (m_approximate)
+    {
+        m_median = m_digest.quantile(.5);
+        for (double q : m_quantiles)
+            m_quantileValues.push_back(m_digest.quantile(q));
+
+        // The MAD is the distance d such that half of the values lie in
+        // [median - d, median + d].  Find it by bisection on the CDF.
+        double lo = 0;
+        double hi = (std::max)(m_max - m_median, m_median - m_min);
+        for (int i = 0; i < 100 && hi - lo > 1e-12 * (std::max)(1.0, hi); ++i)
+        {
+            double d = (lo + hi) / 2;
+            if (m_digest.cdf(m_median + d) - m_digest.cdf(m_median - d) < .5)
+                lo = d;
+            else
+                hi = d;
+        }
+        m_mad = (lo + hi) / 2;
+        return;
+    }
+
+    auto compute_quantile = [](std::vector<double>& vals, double q)
     {
-        std::nth_element(vals.begin(), vals.begin()+vals.size()/2, vals.end());
+        size_t pos = (std::min)(vals.size() - 1, (size_t)(q * vals.size()));
+        std::nth_element(vals.begin(), vals.begin() + pos, vals.end());
 
-        return *(vals.begin()+vals.size()/2);
+        return *(vals.begin() + pos);
     };
 
-    // TODO add quantiles
-    m_median = compute_median(m_data);
-    std::transform(m_data.begin(), m_data.end(), m_data.begin(),
+    std::vector<double> vals(m_data);
+    for (double q : m_quantiles)
+        m_quantileValues.push_back(compute_quantile(vals, q));
+    m_median = compute_quantile(vals, .5);
+    std::transform(vals.begin(), vals.end(), vals.begin(),
        [this](double v) { return std::fabs(v - this->m_median); });
-    m_mad = compute_median(m_data);
+    m_mad = compute_quantile(vals, .5);
+}
+
+
+void Summary::combine(point_count_t nb, double meanB, double m2b,
+    double m3b, double m4b, double minimum, double maximum)
+{
+    if (nb == 0)
+        return;
+
+    // Pairwise update of the central moments.  See Pebay, "Formulas for
+    // Robust, One-Pass Parallel Computation of Covariances and Arbitrary-
+    // Order Statistical Moments", SAND2008-6212.
+    double na = (double)m_cnt;
+    double n = na + nb;
+    double delta = meanB - M1;
+    double delta2 = delta * delta;
+    double m2a = M2;
+    double m3a = M3;
+
+    M1 += delta * nb / n;
+    M2 += m2b + delta2 * na * nb / n;
+    M3 += m3b + delta * delta2 * na * nb * (na - nb) / (n * n) +
+        3 * delta * (na * m2b - nb * m2a) / n;
+    M4 += m4b + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) /
+        (n * n * n) +
+        6 * delta2 * (na * na * m2b + nb * nb * m2a) / (n * n) +
+        4 * delta * (na * m3b - nb * m3a) / n;
+
+    m_avg += (meanB - m_avg) * nb / n;
+    m_min = (std::min)(m_min, minimum);
+    m_max = (std::max)(m_max, maximum);
+    m_cnt += nb;
+}
 
 
+void Summary::merge(const Summary& s)
+{
+    for (auto& v : s.m_values)
+        m_values[v.first] += v.second;
+    m_data.insert(m_data.end(), s.m_data.begin(), s.m_data.end());
+    if (m_approximate && s.m_approximate)
+        m_digest.merge(s.m_digest);
+    if (m_cardinality && s.m_cardinality)
+        m_hll.merge(s.m_hll);
+    combine(s.m_cnt, s.M1, s.M2, s.M3, s.M4, s.m_min, s.m_max);
 }
 
 
+void Summary::insert(const double *vals, size_t count)
+{
+    if (count == 0)
+        return;
+
+    // Simple passes over the array, which the compiler can vectorize.
+    double minimum = vals[0];
+    double maximum = vals[0];
+    double sum = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        minimum = (std::min)(minimum, vals[i]);
+        maximum = (std::max)(maximum, vals[i]);
+        sum += vals[i];
+    }
+    double mean = sum / count;
+
+    double m2 = 0;
+    double m3 = 0;
+    double m4 = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double d = vals[i] - mean;
+        double d2 = d * d;
+        m2 += d2;
+        m3 += d2 * d;
+        m4 += d2 * d2;
+    }
+
+    if (m_enumerate != NoEnum || m_cardinality)
+        for (size_t i = 0; i < count; ++i)
+            insertValue(vals[i]);
+    combine(count, mean, m2, m3, m4, minimum, maximum);
+}
+
 } // namespace stats
 
 using namespace stats;
@@ -145,11 +285,59 @@ bool StatsFilter::processOne(PointRef& point)
 
 void StatsFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    // Points are processed in blocks.  The values of each dimension in a
+    // block are copied to a contiguous array and added to the summary at
+    // once.
+    const PointId BlockSize = 4096;
+    // Views are split into ranges of a fixed size so that the ranges, and
+    // so the merged statistics, don't depend on the number of threads.
+    const PointId RangeSize = 1000000;
+
+    size_t numRanges = (view.size() + RangeSize - 1) / RangeSize;
+    numRanges = (std::max)(numRanges, (size_t)1);
+    size_t threads = m_threads ? m_threads : ThreadPool::hardwareThreads();
+    ThreadPool pool((std::min)(threads, numRanges));
+
+    // Each range is accumulated into its own copy of the summaries, which
+    // are merged in range order when all ranges are done.
+    std::vector<std::vector<Summary>> partials(numRanges);
+    for (auto& partial : partials)
+        for (auto& p : m_stats)
+        {
+            partial.push_back(p.second);
+            partial.back().reset();
+        }
+
+    for (size_t r = 0; r < numRanges; ++r)
     {
-        point.setPointId(idx);
-        processOne(point);
+        pool.add([this, r, RangeSize, BlockSize, &view, &partials]()
+        {
+            std::vector<Summary>& summaries = partials[r];
+            std::vector<double> vals(BlockSize);
+
+            PointId end = (std::min)(view.size(), (r + 1) * RangeSize);
+            for (PointId start = r * RangeSize; start < end;
+                start += BlockSize)
+            {
+                PointId last = (std::min)(end, start + BlockSize);
+                size_t i = 0;
+                for (auto& p : m_stats)
+                {
+                    Dimension::Id d = p.first;
+                    for (PointId idx = start; idx < last; ++idx)
+                        vals[idx - start] = view.getFieldAs<double>(d, idx);
+                    summaries[i++].insert(vals.data(), last - start);
+                }
+            }
+        });
+    }
+    pool.await();
+
+    for (auto& partial : partials)
+    {
+        size_t i = 0;
+        for (auto& p : m_stats)
+            p.second.merge(partial[i++]);
     }
 }
 
@@ -169,6 +357,26 @@ void StatsFilter::addArgs(ProgramArgs& args)
     args.add("global", "Dimensions to compute global stats (median, mad, mode)",
         m_global);
     args.add("count", "Dimensions whose values should be counted", m_counts);
+    args.add("approximate", "Compute global stats from a t-digest sketch "
+        "instead of storing all values", m_approximate);
+    args.add("compression", "Compression (accuracy) of the t-digest sketch "
+        "used with 'approximate'", m_compression, 100.0);
+    args.add("quantiles", "Quantiles ([0, 1]) to compute for global "
+        "dimensions", m_quantiles);
+    args.add("cardinality", "Dimensions whose number of distinct values "
+        "should be estimated", m_cardinality);
+    args.add("cardinality_precision", "Precision (4 - 18) of the cardinality "
+        "estimate", m_precision, 14);
+    args.add("threads", "Number of threads used to compute statistics "
+        "(0 uses all available hardware threads)", m_threads, (size_t)0);
+}
+
+
+void StatsFilter::initialize()
+{
+    if (m_precision < 4 || m_precision > 18)
+        throwError("Option 'cardinality_precision' must be in the range "
+            "[4, 18].");
 }
 
 
@@ -229,10 +437,40 @@ void StatsFilter::prepared(PointTableRef table)
         else
             dims[s] = Summary::Global;
     }
+
+    std::vector<double> quantiles;
+    for (auto& s : m_quantiles)
+    {
+        double q;
+        if (!Utils::fromString(s, q) || q < 0 || q > 1)
+            throwError("Invalid quantile '" + s + "'.  Quantiles must be "
+                "numbers in the range [0, 1].");
+        quantiles.push_back(q);
+    }
+
     // Create the summary objects.
     for (auto& dv : dims)
-        m_stats.insert(std::make_pair(layout->findDim(dv.first),
-            Summary(dv.first, dv.second)));
+    {
+        Summary summary(dv.first, dv.second);
+        if (dv.second == Summary::Global)
+        {
+            if (m_approximate)
+                summary.setApproximate(m_compression);
+            summary.setQuantiles(quantiles);
+        }
+        m_stats.insert(std::make_pair(layout->findDim(dv.first), summary));
+    }
+
+    // Set the cardinality flag for those dimensions specified.
+    for (auto& s : m_cardinality)
+    {
+        auto si = m_stats.find(layout->findDim(s));
+        if (si == m_stats.end())
+            getWarn() << "Dimension '" << s << "' listed in --cardinality "
+                "option does not exist.  Ignoring." << std::endl;
+        else
+            si->second.setCardinality(m_precision);
+    }
 }
 
 
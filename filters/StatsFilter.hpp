@@ -37,6 +37,9 @@
 #include <pdal/Filter.hpp>
 #include <pdal/Streamable.hpp>
 
+#include "private/HyperLogLog.hpp"
+#include "private/TDigest.hpp"
+
 namespace pdal
 {
 namespace stats
@@ -58,9 +61,41 @@ typedef std::vector<double> DataVector;
 
 public:
     Summary(std::string name, EnumType enumerate) :
-        m_name(name), m_enumerate(enumerate)
+        m_name(name), m_enumerate(enumerate), m_approximate(false),
+        m_cardinality(false), m_hll(4)
     { reset(); }
 
+    /**
+      Compute global statistics (median, MAD, quantiles) from a t-digest
+      sketch of the values rather than from a copy of all values.
+
+      \param compression  Accuracy of the sketch (see TDigest).
+    */
+    void setApproximate(double compression)
+    {
+        m_approximate = true;
+        m_digest = TDigest(compression);
+    }
+
+    /**
+      Estimate the number of distinct values with a HyperLogLog sketch.
+
+      \param precision  Precision of the sketch (see HyperLogLog).
+    */
+    void setCardinality(int precision)
+    {
+        m_cardinality = true;
+        m_hll = HyperLogLog(precision);
+    }
+
+    /**
+      Set the quantiles to be computed with global statistics.
+
+      \param quantiles  List of quantiles ([0, 1]).
+    */
+    void setQuantiles(const std::vector<double>& quantiles)
+        { m_quantiles = quantiles; }
+
     double minimum() const
         { return m_min; }
     double maximum() const
@@ -79,6 +114,10 @@ public:
         { return m_median; }
     double mad() const
         { return m_mad; }
+    const std::vector<double>& quantileValues() const
+        { return m_quantileValues; }
+    double cardinality() const
+        { return m_cardinality ? m_hll.estimate() : 0; }
     point_count_t count() const
         { return m_cnt; }
     std::string name() const
@@ -89,6 +128,24 @@ public:
     void extractMetadata(MetadataNode &m);
     void computeGlobalStats();
 
+    /**
+      Add the values accumulated by another summary to this one.  The
+      summaries should have been created with the same settings.
+
+      \param s  Summary to merge.
+    */
+    void merge(const Summary& s);
+
+    /**
+      Add a block of values.  Moments of the block are computed from the
+      contiguous array and then merged, which is faster than inserting
+      the values individually.
+
+      \param vals  Pointer to the values.
+      \param count  Number of values.
+    */
+    void insert(const double *vals, size_t count);
+
     void reset()
     {
         m_max = (std::numeric_limits<double>::lowest)();
@@ -98,6 +155,11 @@ public:
         m_median = 0.0;
         m_mad = 0.0;
         M1 = M2 = M3 = M4 = 0.0;
+        m_values.clear();
+        m_data.clear();
+        m_quantileValues.clear();
+        m_digest = TDigest(m_digest.compression());
+        m_hll = HyperLogLog(m_hll.precision());
     }
 
     void insert(double value)
@@ -111,18 +173,10 @@ public:
         m_min = (std::min)(m_min, value);
         m_max = (std::max)(m_max, value);
         m_avg += (value - m_avg) / m_cnt;
-        if (m_enumerate != NoEnum)
-            m_values[value]++;
-        if (m_enumerate == Global)
-        {
-            if (m_data.capacity() - m_data.size() < 10000)
-                m_data.reserve(m_data.capacity() + m_cnt);
-            m_data.push_back(value);
-        }
+        insertValue(value);
 
         // stolen from http://www.johndcook.com/blog/skewness_kurtosis/
 
-        n1 = n;
         delta = value - M1;
         delta_n = delta / n;
         delta_n2 = delta_n * delta_n;
@@ -135,6 +189,26 @@ public:
     }
 
 private:
+    // Record a value in the enumeration, global and cardinality data.
+    void insertValue(double value)
+    {
+        if (m_enumerate == Global && m_approximate)
+            m_digest.insert(value);
+        else if (m_enumerate != NoEnum)
+            m_values[value]++;
+        if (m_enumerate == Global && !m_approximate)
+        {
+            if (m_data.capacity() - m_data.size() < 10000)
+                m_data.reserve(m_data.capacity() + m_cnt);
+            m_data.push_back(value);
+        }
+        if (m_cardinality)
+            m_hll.insert(value);
+    }
+
+    void combine(point_count_t n, double mean, double m2, double m3,
+        double m4, double minimum, double maximum);
+
     std::string m_name;
     EnumType m_enumerate;
     double m_max;
@@ -146,6 +220,12 @@ private:
     DataVector m_data;
     point_count_t m_cnt;
     double M1, M2, M3, M4;
+    bool m_approximate;
+    TDigest m_digest;
+    bool m_cardinality;
+    HyperLogLog m_hll;
+    std::vector<double> m_quantiles;
+    std::vector<double> m_quantileValues;
 };
 
 } // namespace stats
@@ -159,6 +239,7 @@ public:
         {}
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
     const stats::Summary& getStats(Dimension::Id d) const;
     void reset();
@@ -167,6 +248,7 @@ private:
     StatsFilter& operator=(const StatsFilter&); // not implemented
     StatsFilter(const StatsFilter&); // not implemented
     virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
     virtual bool processOne(PointRef& point);
     virtual void prepared(PointTableRef table);
     virtual void done(PointTableRef table);
@@ -177,6 +259,12 @@ private:
     StringList m_enums;
     StringList m_counts;
     StringList m_global;
+    bool m_approximate;
+    double m_compression;
+    StringList m_quantiles;
+    StringList m_cardinality;
+    int m_precision;
+    size_t m_threads;
     std::map<Dimension::Id, stats::Summary> m_stats;
 };
 
@@ -50,4 +50,10 @@ std::string TailFilter::getName() const
     return s_info.name;
 }
 
+
+bool TailFilter::usedDimensions(StringList& /*dims*/) const
+{
+    return true;
+}
+
 } // namespace pdal
@@ -50,6 +50,13 @@ CREATE_STATIC_STAGE(TransformationFilter, s_info)
 
 std::string TransformationFilter::getName() const { return s_info.name; }
 
+
+bool TransformationFilter::usedDimensions(StringList& dims) const
+{
+    dims = { "X", "Y", "Z" };
+    return true;
+}
+
 TransformationMatrix transformationMatrixFromString(const std::string& s)
 {
     std::istringstream iss(s);
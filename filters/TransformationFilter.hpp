@@ -59,6 +59,7 @@ public:
     {}
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     TransformationFilter& operator=(const TransformationFilter&); // not implemented
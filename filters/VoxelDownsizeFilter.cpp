@@ -0,0 +1,257 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "VoxelDownsizeFilter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include <pdal/util/ProgramArgs.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "filters.voxeldownsize",
+    "Keep one point per voxel, selected without a spatial index",
+    "http://pdal.io/stages/filters.voxeldownsize.html"
+};
+
+CREATE_STATIC_STAGE(VoxelDownsizeFilter, s_info)
+
+std::string VoxelDownsizeFilter::getName() const
+{
+    return s_info.name;
+}
+
+
+void VoxelDownsizeFilter::addArgs(ProgramArgs& args)
+{
+    args.add("cell", "Cell size", m_cell, 1.0);
+    args.add("mode", "Point to keep in each voxel: 'center', 'centroid', "
+        "'first' or 'random'", m_modeString, "center");
+    args.add("seed", "Random number generator seed for 'random' mode",
+        m_seed, 0u);
+    args.add("sorted", "Input is sorted by ascending X.  When streaming, "
+        "voxels behind the current point are forgotten", m_sorted);
+}
+
+
+void VoxelDownsizeFilter::initialize()
+{
+    if (m_cell <= 0)
+        throwError("Option 'cell' must be positive.");
+
+    std::string mode = Utils::tolower(m_modeString);
+    if (mode == "center")
+        m_mode = Mode::Center;
+    else if (mode == "centroid")
+        m_mode = Mode::Centroid;
+    else if (mode == "first")
+        m_mode = Mode::First;
+    else if (mode == "random")
+        m_mode = Mode::Random;
+    else
+        throwError("Invalid mode '" + m_modeString + "'.  Must be one of "
+            "'center', 'centroid', 'first' or 'random'.");
+}
+
+
+// The point to keep in a voxel can only be chosen as points arrive when
+// the first point is kept.
+bool VoxelDownsizeFilter::pipelineStreamable() const
+{
+    StringList modes = m_options.getValues("mode");
+    if (modes.size() && Utils::tolower(modes.front()) != "first")
+        return false;
+    return Streamable::pipelineStreamable();
+}
+
+
+bool VoxelDownsizeFilter::usedDimensions(StringList& dims) const
+{
+    dims = { "X", "Y", "Z" };
+    return true;
+}
+
+
+void VoxelDownsizeFilter::ready(PointTableRef table)
+{
+    m_generator.seed(m_seed);
+    m_populated.clear();
+    m_haveLastX = false;
+    m_lastX = 0;
+}
+
+
+VoxelDownsizeFilter::Voxel VoxelDownsizeFilter::voxel(double x, double y,
+    double z) const
+{
+    return Voxel { (int64_t)std::floor(x / m_cell),
+        (int64_t)std::floor(y / m_cell), (int64_t)std::floor(z / m_cell) };
+}
+
+
+bool VoxelDownsizeFilter::processOne(PointRef& point)
+{
+    double x = point.getFieldAs<double>(Dimension::Id::X);
+    double y = point.getFieldAs<double>(Dimension::Id::Y);
+    double z = point.getFieldAs<double>(Dimension::Id::Z);
+
+    Voxel v = voxel(x, y, z);
+
+    // When points arrive in X order, no point can fall in a voxel behind
+    // the current one, so those voxels can be dropped.  This bounds memory
+    // by the number of populated voxels in a single slab of cells.
+    if (m_sorted)
+    {
+        if (m_haveLastX && v.m_x < m_lastX)
+            throwError("Points aren't sorted by ascending X.");
+        if (!m_haveLastX || v.m_x > m_lastX)
+            m_populated.clear();
+        m_haveLastX = true;
+        m_lastX = v.m_x;
+    }
+
+    // Keep the point if its voxel hasn't been seen.
+    return m_populated.insert(v).second;
+}
+
+
+PointViewSet VoxelDownsizeFilter::run(PointViewPtr view)
+{
+    std::unordered_map<Voxel, size_t, VoxelHash> index;
+    std::vector<Cell> cells;
+    // The cell of each point, which saves a second hash lookup when
+    // selecting the point nearest the centroid.
+    std::vector<size_t> pointCells;
+    if (m_mode == Mode::Centroid)
+        pointCells.resize(view->size());
+
+    std::uniform_real_distribution<double> uniform;
+    for (PointId id = 0; id < view->size(); ++id)
+    {
+        double x = view->getFieldAs<double>(Dimension::Id::X, id);
+        double y = view->getFieldAs<double>(Dimension::Id::Y, id);
+        double z = view->getFieldAs<double>(Dimension::Id::Z, id);
+
+        Voxel v = voxel(x, y, z);
+        auto it = index.insert(std::make_pair(v, cells.size())).first;
+        if (it->second == cells.size())
+        {
+            cells.push_back(Cell());
+            cells.back().m_id = id;
+            cells.back().m_dist = (std::numeric_limits<double>::max)();
+        }
+        Cell& cell = cells[it->second];
+        cell.m_count++;
+
+        switch (m_mode)
+        {
+        case Mode::Center:
+        {
+            double dx = x - (v.m_x + .5) * m_cell;
+            double dy = y - (v.m_y + .5) * m_cell;
+            double dz = z - (v.m_z + .5) * m_cell;
+            double dist = dx * dx + dy * dy + dz * dz;
+            if (dist < cell.m_dist)
+            {
+                cell.m_dist = dist;
+                cell.m_id = id;
+            }
+            break;
+        }
+        case Mode::Centroid:
+            cell.m_x += x;
+            cell.m_y += y;
+            cell.m_z += z;
+            pointCells[id] = it->second;
+            break;
+        case Mode::Random:
+            // Reservoir sampling: the nth point replaces the kept point
+            // with probability 1/n.
+            if (uniform(m_generator) * cell.m_count < 1.0)
+                cell.m_id = id;
+            break;
+        case Mode::First:
+            break;
+        }
+    }
+
+    if (m_mode == Mode::Centroid)
+    {
+        for (Cell& cell : cells)
+        {
+            cell.m_x /= cell.m_count;
+            cell.m_y /= cell.m_count;
+            cell.m_z /= cell.m_count;
+        }
+        for (PointId id = 0; id < view->size(); ++id)
+        {
+            Cell& cell = cells[pointCells[id]];
+            double dx = view->getFieldAs<double>(Dimension::Id::X, id) -
+                cell.m_x;
+            double dy = view->getFieldAs<double>(Dimension::Id::Y, id) -
+                cell.m_y;
+            double dz = view->getFieldAs<double>(Dimension::Id::Z, id) -
+                cell.m_z;
+            double dist = dx * dx + dy * dy + dz * dz;
+            if (dist < cell.m_dist)
+            {
+                cell.m_dist = dist;
+                cell.m_id = id;
+            }
+        }
+    }
+
+    // Keep the selected points in their original order.
+    std::vector<PointId> ids;
+    ids.reserve(cells.size());
+    for (const Cell& cell : cells)
+        ids.push_back(cell.m_id);
+    std::sort(ids.begin(), ids.end());
+
+    PointViewPtr output = view->makeNew();
+    for (PointId id : ids)
+        output->appendPoint(*view, id);
+
+    PointViewSet viewSet;
+    viewSet.insert(output);
+    return viewSet;
+}
+
+} // namespace pdal
@@ -0,0 +1,129 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <pdal/Filter.hpp>
+#include <pdal/Streamable.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace pdal
+{
+
+class PDAL_DLL VoxelDownsizeFilter : public Filter, public Streamable
+{
+public:
+    VoxelDownsizeFilter()
+    {}
+
+    std::string getName() const;
+    virtual bool pipelineStreamable() const;
+    virtual bool usedDimensions(StringList& dims) const;
+
+private:
+    enum class Mode
+    {
+        Center,
+        Centroid,
+        First,
+        Random
+    };
+
+    // Integer voxel coordinates.
+    struct Voxel
+    {
+        int64_t m_x;
+        int64_t m_y;
+        int64_t m_z;
+
+        bool operator == (const Voxel& other) const
+        {
+            return m_x == other.m_x && m_y == other.m_y && m_z == other.m_z;
+        }
+    };
+
+    struct VoxelHash
+    {
+        size_t operator () (const Voxel& v) const
+        {
+            uint64_t h = (uint64_t)v.m_x * 0x9e3779b97f4a7c15ULL;
+            h ^= (uint64_t)v.m_y * 0xc2b2ae3d27d4eb4fULL;
+            h ^= (uint64_t)v.m_z * 0x165667b19e3779f9ULL;
+            return (size_t)(h ^ (h >> 29));
+        }
+    };
+
+    // The point selected for a voxel, along with the state needed to
+    // select it.
+    struct Cell
+    {
+        Cell() : m_id(0), m_dist(0), m_x(0), m_y(0), m_z(0), m_count(0)
+        {}
+
+        PointId m_id;
+        double m_dist;
+        double m_x;
+        double m_y;
+        double m_z;
+        point_count_t m_count;
+    };
+
+    double m_cell;
+    std::string m_modeString;
+    Mode m_mode;
+    uint32_t m_seed;
+    bool m_sorted;
+    std::mt19937 m_generator;
+    std::unordered_set<Voxel, VoxelHash> m_populated;
+    bool m_haveLastX;
+    int64_t m_lastX;
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
+    virtual PointViewSet run(PointViewPtr view);
+
+    Voxel voxel(double x, double y, double z) const;
+
+    VoxelDownsizeFilter& operator=(const VoxelDownsizeFilter&); // not impl
+    VoxelDownsizeFilter(const VoxelDownsizeFilter&); // not implemented
+};
+
+} // namespace pdal
@@ -0,0 +1,91 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "HyperLogLog.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pdal
+{
+namespace stats
+{
+
+HyperLogLog::HyperLogLog(int precision) :
+    m_precision((std::min)((std::max)(precision, 4), 18)),
+    m_registers((size_t)1 << m_precision)
+{}
+
+
+void HyperLogLog::merge(const HyperLogLog& other)
+{
+    if (other.m_precision != m_precision)
+        throw pdal_error("Can't merge HyperLogLog sketches of differing "
+            "precision.");
+    for (size_t i = 0; i < m_registers.size(); ++i)
+        m_registers[i] = (std::max)(m_registers[i], other.m_registers[i]);
+}
+
+
+double HyperLogLog::estimate() const
+{
+    double m = (double)m_registers.size();
+    double alpha;
+    if (m_registers.size() == 16)
+        alpha = .673;
+    else if (m_registers.size() == 32)
+        alpha = .697;
+    else if (m_registers.size() == 64)
+        alpha = .709;
+    else
+        alpha = .7213 / (1 + 1.079 / m);
+
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t r : m_registers)
+    {
+        sum += std::ldexp(1.0, -(int)r);
+        if (r == 0)
+            zeros++;
+    }
+    double e = alpha * m * m / sum;
+
+    // Use linear counting for small cardinalities.
+    if (e <= 2.5 * m && zeros)
+        e = m * std::log(m / zeros);
+    return e;
+}
+
+} // namespace stats
+} // namespace pdal
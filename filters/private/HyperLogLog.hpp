@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+namespace stats
+{
+
+/**
+  Mergeable sketch for estimating the number of distinct values in bounded
+  memory (HyperLogLog, Flajolet et al.).
+
+  The sketch uses 2^precision one-byte registers.  The relative standard
+  error of the estimate is about 1.04 / sqrt(2^precision).
+*/
+class PDAL_DLL HyperLogLog
+{
+public:
+    /**
+      Create an empty sketch.
+
+      \param precision  Number of bits used to select a register ([4, 18]).
+    */
+    HyperLogLog(int precision = 14);
+
+    /**
+      Add a value to the sketch.
+
+      \param value  Value to add.
+    */
+    void insert(double value)
+    {
+        // Make sure that 0 and -0 hash the same.
+        if (value == 0)
+            value = 0;
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint64_t h = hash(bits);
+
+        size_t idx = (size_t)(h >> (64 - m_precision));
+        // Set a stop bit so that the rank is bounded when the remaining
+        // bits are all zero.
+        uint64_t rest = (h << m_precision) |
+            ((uint64_t)1 << (m_precision - 1));
+        uint8_t rank = 1;
+        while (!(rest & ((uint64_t)1 << 63)))
+        {
+            rank++;
+            rest <<= 1;
+        }
+        if (rank > m_registers[idx])
+            m_registers[idx] = rank;
+    }
+
+    /**
+      Add the values summarized by another sketch to this one.  The sketches
+      must have the same precision.
+
+      \param other  Sketch to merge.
+    */
+    void merge(const HyperLogLog& other);
+
+    /**
+      Estimate the number of distinct values inserted.
+
+      \return  Estimated distinct value count.
+    */
+    double estimate() const;
+
+    /**
+      Return the precision of the sketch.
+
+      \return  Sketch precision.
+    */
+    int precision() const
+        { return m_precision; }
+
+private:
+    int m_precision;
+    std::vector<uint8_t> m_registers;
+
+    // 64-bit finalizer from splitmix64.
+    static uint64_t hash(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+};
+
+} // namespace stats
+} // namespace pdal
@@ -0,0 +1,214 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "TDigest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pdal
+{
+namespace stats
+{
+
+namespace
+{
+
+const double PI = 3.14159265358979323846;
+
+}
+
+TDigest::TDigest(double compression) :
+    m_compression((std::max)(compression, 10.0)),
+    m_bufferSize((size_t)(m_compression * 5)),
+    m_min((std::numeric_limits<double>::max)()),
+    m_max((std::numeric_limits<double>::lowest)()), m_weight(0)
+{
+    m_buffer.reserve(m_bufferSize);
+}
+
+
+void TDigest::merge(const TDigest& other)
+{
+    other.compress();
+    if (other.m_centroids.empty())
+        return;
+    m_min = (std::min)(m_min, other.m_min);
+    m_max = (std::max)(m_max, other.m_max);
+    m_buffer.insert(m_buffer.end(), other.m_centroids.begin(),
+        other.m_centroids.end());
+    compress();
+}
+
+
+// Merge the buffered values into the centroid list.  Adjacent centroids
+// are combined as long as the combined centroid spans no more than one
+// unit of the scale function k(q) = compression / (2 * PI) * asin(2q - 1).
+void TDigest::compress() const
+{
+    if (m_buffer.empty())
+        return;
+
+    m_buffer.insert(m_buffer.end(), m_centroids.begin(), m_centroids.end());
+    std::sort(m_buffer.begin(), m_buffer.end());
+
+    double total = 0;
+    for (const Centroid& c : m_buffer)
+        total += c.m_weight;
+
+    auto k = [this](double q)
+        { return m_compression / (2 * PI) * std::asin(2 * q - 1); };
+
+    m_centroids.clear();
+    Centroid cur = m_buffer.front();
+    double soFar = 0;
+    double kLow = k(0);
+    for (size_t i = 1; i < m_buffer.size(); ++i)
+    {
+        const Centroid& next = m_buffer[i];
+        double proposed = cur.m_weight + next.m_weight;
+        if (k((soFar + proposed) / total) - kLow <= 1)
+        {
+            cur.m_mean += (next.m_mean - cur.m_mean) * next.m_weight /
+                proposed;
+            cur.m_weight = proposed;
+        }
+        else
+        {
+            soFar += cur.m_weight;
+            kLow = k(soFar / total);
+            m_centroids.push_back(cur);
+            cur = next;
+        }
+    }
+    m_centroids.push_back(cur);
+    m_weight = total;
+    m_buffer.clear();
+}
+
+
+// Each centroid is taken to represent the values around its mean, with half
+// its weight on either side.  Estimates are interpolated between the
+// means of adjacent centroids and the minimum and maximum values.
+double TDigest::quantile(double q) const
+{
+    compress();
+    if (m_centroids.empty())
+        return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0)
+        return m_min;
+    if (q >= 1)
+        return m_max;
+    if (m_centroids.size() == 1)
+        return m_centroids.front().m_mean;
+
+    double index = q * m_weight;
+    const Centroid& first = m_centroids.front();
+    if (index < first.m_weight / 2)
+        return m_min + (first.m_mean - m_min) * index / (first.m_weight / 2);
+
+    double cum = 0;
+    for (size_t i = 0; i + 1 < m_centroids.size(); ++i)
+    {
+        const Centroid& c1 = m_centroids[i];
+        const Centroid& c2 = m_centroids[i + 1];
+        double left = cum + c1.m_weight / 2;
+        double right = cum + c1.m_weight + c2.m_weight / 2;
+        if (index < right)
+            return c1.m_mean + (c2.m_mean - c1.m_mean) * (index - left) /
+                (right - left);
+        cum += c1.m_weight;
+    }
+
+    const Centroid& last = m_centroids.back();
+    double left = m_weight - last.m_weight / 2;
+    return last.m_mean + (m_max - last.m_mean) * (index - left) /
+        (last.m_weight / 2);
+}
+
+
+double TDigest::cdf(double x) const
+{
+    compress();
+    if (m_centroids.empty())
+        return std::numeric_limits<double>::quiet_NaN();
+    if (x < m_min)
+        return 0;
+    if (x >= m_max)
+        return 1;
+    if (m_centroids.size() == 1)
+        return (x - m_min) / (m_max - m_min);
+
+    const Centroid& first = m_centroids.front();
+    if (x < first.m_mean)
+        return (x - m_min) / (first.m_mean - m_min) *
+            (first.m_weight / 2) / m_weight;
+
+    double cum = 0;
+    for (size_t i = 0; i + 1 < m_centroids.size(); ++i)
+    {
+        const Centroid& c1 = m_centroids[i];
+        const Centroid& c2 = m_centroids[i + 1];
+        if (x < c2.m_mean)
+        {
+            double frac = (x - c1.m_mean) / (c2.m_mean - c1.m_mean);
+            return (cum + c1.m_weight / 2 +
+                frac * (c1.m_weight + c2.m_weight) / 2) / m_weight;
+        }
+        cum += c1.m_weight;
+    }
+
+    const Centroid& last = m_centroids.back();
+    double frac = (x - last.m_mean) / (m_max - last.m_mean);
+    return (m_weight - last.m_weight / 2 + frac * last.m_weight / 2) /
+        m_weight;
+}
+
+
+point_count_t TDigest::count() const
+{
+    compress();
+    return (point_count_t)std::llround(m_weight);
+}
+
+
+size_t TDigest::centroidCount() const
+{
+    compress();
+    return m_centroids.size();
+}
+
+} // namespace stats
+} // namespace pdal
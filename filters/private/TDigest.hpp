@@ -0,0 +1,157 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+namespace stats
+{
+
+/**
+  Mergeable sketch of a distribution for estimating quantiles in bounded
+  memory (the "merging t-digest" of Dunning and Ertl).
+
+  Values are gathered into centroids whose maximum size is smallest near
+  the tails of the distribution, so extreme quantiles are more accurate
+  than central ones.  Memory use is proportional to the compression
+  parameter and independent of the number of values inserted.
+*/
+class PDAL_DLL TDigest
+{
+public:
+    /**
+      Create an empty digest.
+
+      \param compression  Accuracy control.  Larger values give more
+        accurate estimates at the cost of more memory.  The number of
+        centroids retained is approximately this value.
+    */
+    TDigest(double compression = 100.0);
+
+    /**
+      Add a value to the digest.
+
+      \param value  Value to add.
+    */
+    void insert(double value)
+    {
+        if (value < m_min)
+            m_min = value;
+        if (value > m_max)
+            m_max = value;
+        m_buffer.push_back(Centroid(value, 1.0));
+        if (m_buffer.size() >= m_bufferSize)
+            compress();
+    }
+
+    /**
+      Add the values summarized by another digest to this one.
+
+      \param other  Digest to merge.
+    */
+    void merge(const TDigest& other);
+
+    /**
+      Estimate the value at a quantile.
+
+      \param q  Quantile ([0, 1]).
+      \return  Estimated value or NaN if the digest is empty.
+    */
+    double quantile(double q) const;
+
+    /**
+      Estimate the fraction of values less than or equal to a value.
+
+      \param x  Value.
+      \return  Estimated cumulative distribution at x or NaN if the
+        digest is empty.
+    */
+    double cdf(double x) const;
+
+    /**
+      Number of values summarized by the digest.
+
+      \return  Value count.
+    */
+    point_count_t count() const;
+
+    /**
+      Number of centroids currently retained.
+
+      \return  Centroid count.
+    */
+    size_t centroidCount() const;
+
+    /**
+      Return the compression parameter of the digest.
+
+      \return  Compression.
+    */
+    double compression() const
+        { return m_compression; }
+
+private:
+    struct Centroid
+    {
+        Centroid(double mean, double weight) : m_mean(mean), m_weight(weight)
+        {}
+
+        bool operator < (const Centroid& other) const
+            { return m_mean < other.m_mean; }
+
+        double m_mean;
+        double m_weight;
+    };
+
+    double m_compression;
+    size_t m_bufferSize;
+    double m_min;
+    double m_max;
+    // Compression of the buffered values is done lazily, so it happens
+    // in const member functions.
+    mutable std::vector<Centroid> m_centroids;
+    mutable std::vector<Centroid> m_buffer;
+    mutable double m_weight;
+
+    void compress() const;
+};
+
+} // namespace stats
+} // namespace pdal
@@ -34,33 +34,188 @@
 
 #include "BpfCompressor.hpp"
 
+#ifdef PDAL_HAVE_ZLIB
+#include <zlib.h>
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+#include <zstd.h>
+#endif // PDAL_HAVE_ZSTD
+
 namespace pdal
 {
 
+const size_t BpfCompressor::BlockSize;
+
+class BpfCompressor::Context
+{
+public:
+    Context(BpfCompression codec, int level) : m_codec(codec),
+        m_level(level), m_size(0)
+    {
+        switch (m_codec)
+        {
 #ifdef PDAL_HAVE_ZLIB
-void BpfCompressor::startBlock()
+        case BpfCompression::Zlib:
+            m_zstrm.zalloc = Z_NULL;
+            m_zstrm.zfree = Z_NULL;
+            m_zstrm.opaque = Z_NULL;
+            if (deflateInit(&m_zstrm, m_level) != Z_OK)
+                throw error("Could not initialize BPF compressor.");
+            break;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+        case BpfCompression::Zstd:
+            m_zstdCtx = ZSTD_createCCtx();
+            if (!m_zstdCtx)
+                throw error("Could not initialize BPF compressor.");
+            break;
+#endif // PDAL_HAVE_ZSTD
+        default:
+            throw error("Unsupported BPF compression type.");
+        }
+    }
+
+    ~Context()
+    {
+#ifdef PDAL_HAVE_ZLIB
+        if (m_codec == BpfCompression::Zlib)
+            deflateEnd(&m_zstrm);
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+        if (m_codec == BpfCompression::Zstd)
+            ZSTD_freeCCtx(m_zstdCtx);
+#endif // PDAL_HAVE_ZSTD
+    }
+
+    // Compress a block into the output buffer.
+    void compress(const char *buf, size_t size)
+    {
+        switch (m_codec)
+        {
+#ifdef PDAL_HAVE_ZLIB
+        case BpfCompression::Zlib:
+            m_buf.resize(deflateBound(&m_zstrm, (uLong)size));
+            deflateReset(&m_zstrm);
+            m_zstrm.avail_in = (uInt)size;
+            m_zstrm.next_in = (unsigned char *)buf;
+            m_zstrm.avail_out = (uInt)m_buf.size();
+            m_zstrm.next_out = (unsigned char *)m_buf.data();
+            if (::deflate(&m_zstrm, Z_FINISH) != Z_STREAM_END)
+                throw error("Couldn't compress BPF block.");
+            m_size = m_zstrm.total_out;
+            break;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+        case BpfCompression::Zstd:
+            m_buf.resize(ZSTD_compressBound(size));
+            m_size = ZSTD_compressCCtx(m_zstdCtx, m_buf.data(), m_buf.size(),
+                buf, size, m_level);
+            if (ZSTD_isError(m_size))
+                throw error("Couldn't compress BPF block.");
+            break;
+#endif // PDAL_HAVE_ZSTD
+        default:
+            break;
+        }
+    }
+
+    const char *data() const
+        { return m_buf.data(); }
+    size_t size() const
+        { return m_size; }
+
+private:
+    BpfCompression m_codec;
+    int m_level;
+    std::vector<char> m_buf;
+    size_t m_size;
+#ifdef PDAL_HAVE_ZLIB
+    z_stream m_zstrm;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+    ZSTD_CCtx *m_zstdCtx;
+#endif // PDAL_HAVE_ZSTD
+};
+
+
+BpfCompressor::BpfCompressor(OLeStream& out, size_t maxSize,
+        BpfCompression codec, int level, size_t threads) :
+    m_out(out), m_pool(codec == BpfCompression::None ? 1 : threads)
 {
-    // Initialize the stream.
-    m_strm.zalloc = Z_NULL;
-    m_strm.zfree = Z_NULL;
-    m_strm.opaque = Z_NULL;
-    if (deflateInit(&m_strm, Z_DEFAULT_COMPRESSION) != Z_OK)
-        throw error("Could not initialize BPF compressor.");
-
-    m_rawSize = 0;
-    m_compressedSize = 0;
-    uint32_t rawSize = 0;
-    uint32_t compressedSize = 0;
-
-    // Initiailize the streambuf with the backing buffer.
-    m_charbuf.initialize(m_inbuf.data(), m_inbuf.size());
+    if (codec == BpfCompression::None)
+        return;
+
+    m_inbuf.resize(maxSize);
+    size_t numBlocks = (std::max)((maxSize + BlockSize - 1) / BlockSize,
+        (size_t)1);
+    size_t numTasks = (std::min)(m_pool.numThreads(), numBlocks);
+    numTasks = (std::max)(numTasks, (size_t)1);
+
+    for (size_t i = 0; i < numTasks; ++i)
+        m_contexts.emplace_back(new Context(codec, level));
+}
+
+
+BpfCompressor::~BpfCompressor()
+{}
+
+
+bool BpfCompressor::supported(BpfCompression codec)
+{
+    switch (codec)
+    {
+    case BpfCompression::None:
+        return true;
+#ifdef PDAL_HAVE_ZLIB
+    case BpfCompression::Zlib:
+        return true;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+    case BpfCompression::Zstd:
+        return true;
+#endif // PDAL_HAVE_ZSTD
+    default:
+        return false;
+    }
+}
+
+
+int BpfCompressor::defaultLevel(BpfCompression codec)
+{
+    switch (codec)
+    {
+    case BpfCompression::Zlib:
+        return 6;
+    case BpfCompression::Zstd:
+        return 3;
+    default:
+        return 0;
+    }
+}
 
-    // Note our position so that we can rewind here.
-    m_blockStart.mark();
-    m_out << rawSize << compressedSize;
 
-    // Make a new stream from our charbuf and push it so that future writes
-    // to our stream go to the backing vector.
+bool BpfCompressor::validLevel(BpfCompression codec, int level)
+{
+    switch (codec)
+    {
+    case BpfCompression::Zlib:
+        return level >= 0 && level <= 9;
+#ifdef PDAL_HAVE_ZSTD
+    // Negative levels trade compression ratio for speed.
+    case BpfCompression::Zstd:
+        return level >= ZSTD_minCLevel() && level <= ZSTD_maxCLevel();
+#endif // PDAL_HAVE_ZSTD
+    default:
+        return true;
+    }
+}
+
+
+void BpfCompressor::startBlock()
+{
+    // Initiailize the streambuf with the backing buffer and push a stream
+    // so that future writes to our stream go to the backing vector.
+    m_charbuf.initialize(m_inbuf.data(), m_inbuf.size());
     m_out.pushStream(new std::ostream(&m_charbuf));
 }
 
@@ -68,76 +223,146 @@ void BpfCompressor::startBlock()
 void BpfCompressor::compress()
 {
     // Note our position so that we know how much we've written.
-    uint32_t rawWritten = (uint32_t)m_out.position();
+    size_t rawWritten = (size_t)m_out.position();
 
     // Pop our temp stream so that we can write the real output file.
-    m_out.popStream();
+    delete m_out.popStream();
 
-    m_rawSize += rawWritten;
+    // An empty block is written if there's no data.
+    size_t numBlocks = (std::max)((rawWritten + BlockSize - 1) / BlockSize,
+        (size_t)1);
 
-    // Deflate the data in the buffer and write it to the output stream.
-    m_strm.avail_in = rawWritten;
-    m_strm.next_in = (unsigned char *)m_inbuf.data();
-    m_strm.avail_out = CHUNKSIZE;
-    m_strm.next_out = m_tmpbuf;
-    while (m_strm.avail_in)
+    // Compress a block on each task and then write the blocks in order.
+    const size_t numTasks = m_contexts.size();
+    for (size_t first = 0; first < numBlocks; first += numTasks)
     {
-        int ret = ::deflate(&m_strm, Z_NO_FLUSH);
-        size_t written = CHUNKSIZE - m_strm.avail_out;
-        m_compressedSize += written;
-        m_out.put(m_tmpbuf, written);
-        m_strm.avail_out = CHUNKSIZE;
-        m_strm.next_out = m_tmpbuf;
+        size_t count = (std::min)(numTasks, numBlocks - first);
+        for (size_t task = 0; task < count; ++task)
+        {
+            m_pool.add([this, task, first, rawWritten]()
+            {
+                size_t start = (first + task) * BlockSize;
+                size_t size = (std::min)(BlockSize, rawWritten - start);
+                m_contexts[task]->compress(m_inbuf.data() + start, size);
+            });
+        }
+        m_pool.await();
+
+        for (size_t task = 0; task < count; ++task)
+        {
+            size_t start = (first + task) * BlockSize;
+            size_t size = (std::min)(BlockSize, rawWritten - start);
+            const Context& ctx = *m_contexts[task];
+
+            m_out << (uint32_t)size << (uint32_t)ctx.size();
+            m_out.put(ctx.data(), ctx.size());
+        }
     }
 
     // All data has been written.  Reinitialize input buffer's streambuf and
     // push it.
-    m_charbuf.initialize(m_inbuf.data(), m_inbuf.size());
-    m_out.pushStream(new std::ostream(&m_charbuf));
+    startBlock();
 }
 
 
 void BpfCompressor::finish()
 {
     // Pop our special stream so that we can write the the file.
-    m_out.popStream();
+    delete m_out.popStream();
+}
 
-    // Deflate and write the result to the output file.
-    int ret = Z_OK;
-    while (ret == Z_OK)
+
+class BpfDecompressor::Context
+{
+public:
+    Context(BpfCompression codec) : m_codec(codec)
     {
-        ret = ::deflate(&m_strm, Z_FINISH);
-        size_t written = CHUNKSIZE - m_strm.avail_out;
-        m_compressedSize += written;
-        m_out.put(m_tmpbuf, written);
-        m_strm.avail_out = CHUNKSIZE;
-        m_strm.next_out = m_tmpbuf;
+        switch (m_codec)
+        {
+#ifdef PDAL_HAVE_ZLIB
+        case BpfCompression::Zlib:
+            m_zstrm.zalloc = Z_NULL;
+            m_zstrm.zfree = Z_NULL;
+            m_zstrm.opaque = Z_NULL;
+            m_zstrm.avail_in = 0;
+            m_zstrm.next_in = Z_NULL;
+            if (inflateInit(&m_zstrm) != Z_OK)
+                throw BpfCompressor::error("Could not initialize BPF "
+                    "decompressor.");
+            break;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+        case BpfCompression::Zstd:
+            m_zstdCtx = ZSTD_createDCtx();
+            if (!m_zstdCtx)
+                throw BpfCompressor::error("Could not initialize BPF "
+                    "decompressor.");
+            break;
+#endif // PDAL_HAVE_ZSTD
+        default:
+            throw BpfCompressor::error("Unsupported BPF compression type.");
+        }
     }
-    if (ret != Z_STREAM_END)
-        throw error("Couldn't close BPF compression stream.");
-    deflateEnd(&m_strm);
 
-    // Mark our position so that we can get back here.
-    OStreamMarker blockEnd(m_out);
+    ~Context()
+    {
+#ifdef PDAL_HAVE_ZLIB
+        if (m_codec == BpfCompression::Zlib)
+            inflateEnd(&m_zstrm);
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+        if (m_codec == BpfCompression::Zstd)
+            ZSTD_freeDCtx(m_zstdCtx);
+#endif // PDAL_HAVE_ZSTD
+    }
 
-    // Rewind to the start of the block and write the size bytes.
-    m_blockStart.rewind();
-    m_out << (uint32_t)m_rawSize << (uint32_t)m_compressedSize;
+    bool decompress(const char *in, size_t inSize, char *out, size_t outSize)
+    {
+        switch (m_codec)
+        {
+#ifdef PDAL_HAVE_ZLIB
+        case BpfCompression::Zlib:
+            inflateReset(&m_zstrm);
+            m_zstrm.avail_in = (uInt)inSize;
+            m_zstrm.next_in = (unsigned char *)in;
+            m_zstrm.avail_out = (uInt)outSize;
+            m_zstrm.next_out = (unsigned char *)out;
+            return ::inflate(&m_zstrm, Z_FINISH) == Z_STREAM_END;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+        case BpfCompression::Zstd:
+            return ZSTD_decompressDCtx(m_zstdCtx, out, outSize,
+                in, inSize) == outSize;
+#endif // PDAL_HAVE_ZSTD
+        default:
+            return false;
+        }
+    }
 
-    // Set the position back to the end of the block.
-    blockEnd.rewind();
-}
+private:
+    BpfCompression m_codec;
+#ifdef PDAL_HAVE_ZLIB
+    z_stream m_zstrm;
+#endif // PDAL_HAVE_ZLIB
+#ifdef PDAL_HAVE_ZSTD
+    ZSTD_DCtx *m_zstdCtx;
+#endif // PDAL_HAVE_ZSTD
+};
 
-#else
 
-void BpfCompressor::startBlock()
+BpfDecompressor::BpfDecompressor(BpfCompression codec) :
+    m_context(new Context(codec))
 {}
-void BpfCompressor::compress()
-{}
-void BpfCompressor::finish()
+
+
+BpfDecompressor::~BpfDecompressor()
 {}
 
-#endif // PDAL_HAVE_ZLIB
 
-} // namespace pdal
+bool BpfDecompressor::decompress(const char *in, size_t inSize, char *out,
+    size_t outSize)
+{
+    return m_context->decompress(in, inSize, out, outSize);
+}
 
+} // namespace pdal
@@ -34,20 +34,28 @@
 
 #pragma once
 
+#include <memory>
 #include <stdexcept>
 #include <ostream>
+#include <vector>
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/util/Charbuf.hpp>
 #include <pdal/util/OStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
-#ifdef PDAL_HAVE_ZLIB
-#include <zlib.h>
-#endif // PDAL_HAVE_ZLIB
+#include "BpfHeader.hpp"
 
 namespace pdal
 {
 
+/**
+  Data written to the output stream between startBlock() and finish() is
+  buffered and written as a sequence of compressed blocks when compress()
+  is called.  Each block holds at most BlockSize bytes of raw data and is
+  preceded by its raw and compressed sizes.  Blocks are compressed
+  concurrently.
+*/
 class BpfCompressor
 {
 public:
@@ -57,34 +65,74 @@ public:
         {}
     };
 
-#ifdef PDAL_HAVE_ZLIB
-    BpfCompressor(OLeStream& out, size_t maxSize) :
-        m_out(out), m_inbuf(maxSize), m_blockStart(out), m_rawSize(0),
-        m_compressedSize(0)
-    {}
-#else
-    BpfCompressor(OLeStream&, size_t)
-    {}
-#endif // PDAL_HAVE_ZLIB
+    /// Maximum raw size of a compressed block.
+    static const size_t BlockSize = 1 << 20;
+
+    /**
+      Create a compressor.
+
+      \param out  Output stream.
+      \param maxSize  Maximum number of bytes written between startBlock()
+        and compress().
+      \param codec  Compression codec.  No buffers are allocated if the
+        codec is BpfCompression::None.
+      \param level  Codec-specific compression level.
+      \param threads  Number of threads used for compression.
+    */
+    BpfCompressor(OLeStream& out, size_t maxSize, BpfCompression codec,
+        int level, size_t threads = 1);
+    ~BpfCompressor();
 
     void startBlock();
     void finish();
     void compress();
 
+    /// Return true if the codec is available in this build.
+    static bool supported(BpfCompression codec);
+    /// Return the default compression level for a codec.
+    static int defaultLevel(BpfCompression codec);
+    /// Return true if the level is valid for a codec.
+    static bool validLevel(BpfCompression codec, int level);
+
 private:
-    static const int CHUNKSIZE = 1000000;
+    // Compression state and output buffer for a task.  The state is
+    // reset and reused for each block.
+    class Context;
 
-#ifdef PDAL_HAVE_ZLIB
     OLeStream& m_out;
     Charbuf m_charbuf;
     std::vector<char> m_inbuf;
-    z_stream m_strm;
-    unsigned char m_tmpbuf[CHUNKSIZE];
-    OStreamMarker m_blockStart;
-    size_t m_rawSize;
-    size_t m_compressedSize;
-#endif // PDAL_HAVE_ZLIB
+    ThreadPool m_pool;
+    std::vector<std::unique_ptr<Context>> m_contexts;
 };
 
-} // namespace pdal
 
+/**
+  Decompress blocks written by BpfCompressor.  A decompressor is not
+  thread-safe, but separate decompressors may be used concurrently.
+*/
+class BpfDecompressor
+{
+public:
+    BpfDecompressor(BpfCompression codec);
+    ~BpfDecompressor();
+
+    /**
+      Decompress a block.
+
+      \param in  Compressed data.
+      \param inSize  Size of the compressed data.
+      \param out  Output buffer.
+      \param outSize  Size of the raw data of the block.
+      \return  Whether the block was decompressed successfully.
+    */
+    bool decompress(const char *in, size_t inSize, char *out,
+        size_t outSize);
+
+private:
+    class Context;
+
+    std::unique_ptr<Context> m_context;
+};
+
+} // namespace pdal
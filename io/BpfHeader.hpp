@@ -78,6 +78,14 @@ struct BpfMuellerMatrix
 
     }
 
+    bool identity() const
+    {
+        for (size_t i = 0; i < 16; ++i)
+            if (m_vals[i] != (i % 5 == 0 ? 1.0 : 0.0))
+                return false;
+        return true;
+    }
+
     void apply(double& x, double& y, double& z)
     {
         double w = x * m_vals[12] + y * m_vals[13] + z * m_vals[14] +
@@ -109,12 +117,23 @@ enum class BpfCoordType
     ENU
 };
 
+// Values above Zlib are PDAL extensions to the specification.
 enum class BpfCompression
 {
     None,
     QuickLZ,
     FastLZ,
-    Zlib
+    Zlib,
+    Zstd
+};
+
+// Filters applied to the data of each dimension before compression.  As
+// a PDAL extension, these are stored in the high bits of the compression
+// byte of the header.
+enum class BpfFilter
+{
+    Shuffle = 0x10,
+    Delta = 0x20
 };
 
 struct BpfDimension
@@ -169,6 +188,10 @@ struct BpfHeader
 
     PDAL_DLL void setLog(const LogPtr& log)
          { m_log = log; }
+    BpfCompression compression() const
+        { return (BpfCompression)(m_compression & 0x0F); }
+    bool filtered(BpfFilter filter) const
+        { return m_compression & Utils::toNative(filter); }
     PDAL_DLL bool read(ILeStream& stream);
     bool write(OLeStream& stream);
     bool readV3(ILeStream& stream);
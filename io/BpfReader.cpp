@@ -33,12 +33,15 @@
 ****************************************************************************/
 
 #include "BpfReader.hpp"
+#include "BpfCompressor.hpp"
 
+#include <algorithm>
 #include <climits>
-
-#include <zlib.h>
+#include <cstring>
 
 #include <pdal/Options.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -57,6 +60,13 @@ CREATE_STATIC_STAGE(BpfReader, s_info)
 
 std::string BpfReader::getName() const { return s_info.name; }
 
+void BpfReader::addArgs(ProgramArgs& args)
+{
+    args.add("threads", "Number of threads used to decompress data (0 uses "
+        "all available hardware threads)", m_threads, (size_t)0);
+}
+
+
 QuickInfo BpfReader::inspect()
 {
     QuickInfo qi;
@@ -116,11 +126,24 @@ void BpfReader::initialize()
     {
         throwError(err.what());
     }
-#ifndef PDAL_HAVE_ZLIB
-    if (m_header.m_compression)
-        throwError("Can't read compressed BPF. PDAL wasn't built with "
-            "Zlib support.");
-#endif
+    switch (m_header.compression())
+    {
+    case BpfCompression::None:
+        break;
+    case BpfCompression::Zlib:
+        if (!BpfCompressor::supported(BpfCompression::Zlib))
+            throwError("Can't read compressed BPF. PDAL wasn't built with "
+                "Zlib support.");
+        break;
+    case BpfCompression::Zstd:
+        if (!BpfCompressor::supported(BpfCompression::Zstd))
+            throwError("Can't read compressed BPF. PDAL wasn't built with "
+                "Zstd support.");
+        break;
+    default:
+        throwError("Unsupported compression type " +
+            Utils::toString((int)m_header.compression()) + ".");
+    }
 
     std::string code;
     if (m_header.m_coordType == static_cast<int>(BpfCoordType::Cartesian))
@@ -206,6 +229,9 @@ void BpfReader::addDimensions(PointLayoutPtr layout)
         Dimension::Type type = Dimension::Type::Float;
 
         BpfDimension& dim = m_dims[i];
+        // Unused dimensions keep an unknown ID and aren't loaded.
+        if (!projected(dim.m_label))
+            continue;
         if (dim.m_label == "X" ||
             dim.m_label == "Y" ||
             dim.m_label == "Z")
@@ -280,21 +306,98 @@ void BpfReader::ready(PointTableRef)
     m_stream.seek(m_header.m_len);
     m_index = 0;
     m_start = m_stream.position();
-#ifdef PDAL_HAVE_ZLIB
+
+    m_xDim = m_yDim = m_zDim = m_timeDim = -1;
+    for (size_t d = 0; d < m_dims.size(); ++d)
+    {
+        const std::string& label = m_dims[d].m_label;
+        if (label == "X")
+            m_xDim = (int)d;
+        else if (label == "Y")
+            m_yDim = (int)d;
+        else if (label == "Z")
+            m_zDim = (int)d;
+        else if (Utils::iequals(label, "GpsTime"))
+            m_timeDim = (int)d;
+    }
+    m_hinted = hint().bounded() && m_xDim >= 0 && m_yDim >= 0 &&
+        m_zDim >= 0;
+
+    // Skip the file, including decompression, if no points can pass.
+    if (m_hinted && !hintOverlaps())
+    {
+        log()->get(LogLevel::Debug) << "Skipping '" << m_filename <<
+            "'.  No points within limits of downstream filters.\n";
+        m_index = numPoints();
+        return;
+    }
+
     if (m_header.m_compression)
     {
         m_deflateBuf.resize(numPoints() * m_dims.size() * sizeof(float));
-        size_t index = 0;
-        size_t bytesRead = 0;
-        do
+        try
+        {
+            readCompressedBlocks();
+        }
+        catch (const BpfCompressor::error& err)
         {
-            bytesRead = readBlock(m_deflateBuf, index);
-            index += bytesRead;
-        } while (bytesRead > 0 && index < m_deflateBuf.size());
+            throwError(err.what());
+        }
+        if (m_header.filtered(BpfFilter::Shuffle) ||
+            m_header.filtered(BpfFilter::Delta))
+            unfilter();
         m_charbuf.initialize(m_deflateBuf.data(), m_deflateBuf.size(), m_start);
         m_stream.pushStream(new std::istream(&m_charbuf));
     }
-#endif // PDAL_HAVE_ZLIB
+}
+
+
+// Test the bounds of the file's dimensions against the hint.  Bounds
+// are stored before the transformation is applied, so they're only
+// checked if there is no transformation.
+bool BpfReader::hintOverlaps()
+{
+    if (m_timeDim >= 0 && !hint().overlapsTime(m_dims[m_timeDim].m_min,
+            m_dims[m_timeDim].m_max))
+        return false;
+    if (!m_header.m_xform.identity())
+        return true;
+
+    BOX3D bounds(m_dims[m_xDim].m_min, m_dims[m_yDim].m_min,
+        m_dims[m_zDim].m_min, m_dims[m_xDim].m_max, m_dims[m_yDim].m_max,
+        m_dims[m_zDim].m_max);
+    return bounds.empty() || hint().overlaps(bounds);
+}
+
+
+// Test a point's position, before transformation, and time against the
+// hint.
+bool BpfReader::passesHint(double x, double y, double z, double time)
+{
+    m_header.m_xform.apply(x, y, z);
+    if (!hint().contains(x, y, z))
+        return false;
+    return m_timeDim < 0 || hint().containsTime(time);
+}
+
+
+bool BpfReader::passesHint(const std::vector<double>& vals)
+{
+    return passesHint(vals[m_xDim], vals[m_yDim], vals[m_zDim],
+        m_timeDim < 0 ? 0 : vals[m_timeDim]);
+}
+
+
+// Test a point that has been read (and transformed) against the hint.
+bool BpfReader::passesHint(const PointRef& point)
+{
+    using namespace Dimension;
+
+    if (!hint().contains(point.getFieldAs<double>(Id::X),
+            point.getFieldAs<double>(Id::Y), point.getFieldAs<double>(Id::Z)))
+        return false;
+    return m_timeDim < 0 ||
+        hint().containsTime(point.getFieldAs<double>(Id::GpsTime));
 }
 
 
@@ -308,17 +411,23 @@ void BpfReader::done(PointTableRef)
 
 bool BpfReader::processOne(PointRef& point)
 {
-    switch (m_header.m_pointFormat)
+    // Read until a point passes the hint.
+    while (!eof())
     {
-    case BpfFormat::PointMajor:
-        readPointMajor(point);
-        break;
-    case BpfFormat::DimMajor:
-        readDimMajor(point);
-        break;
-    case BpfFormat::ByteMajor:
-        readByteMajor(point);
-        break;
+        switch (m_header.m_pointFormat)
+        {
+        case BpfFormat::PointMajor:
+            readPointMajor(point);
+            break;
+        case BpfFormat::DimMajor:
+            readDimMajor(point);
+            break;
+        case BpfFormat::ByteMajor:
+            readByteMajor(point);
+            break;
+        }
+        if (!m_hinted || passesHint(point))
+            break;
     }
     return !eof() && (m_index < m_count);
 }
@@ -331,9 +440,8 @@ point_count_t BpfReader::read(PointViewPtr data, point_count_t count)
     case BpfFormat::PointMajor:
         return readPointMajor(data, count);
     case BpfFormat::DimMajor:
-        return readDimMajor(data, count);
     case BpfFormat::ByteMajor:
-        return readByteMajor(data, count);
+        return readColumns(data, count);
     }
     return 0;
 }
@@ -379,6 +487,7 @@ point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
     PointId nextId = view->size();
     PointId idx = m_index;
     point_count_t numRead = 0;
+    std::vector<double> vals(m_dims.size());
     seekPointMajor(idx);
     while (numRead < count && idx < numPoints())
     {
@@ -387,8 +496,13 @@ point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
             float f;
 
             m_stream >> f;
-            view->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
+            vals[d] = f + m_dims[d].m_offset;
         }
+        idx++;
+        if (m_hinted && !passesHint(vals))
+            continue;
+        for (size_t d = 0; d < m_dims.size(); ++d)
+            view->setField(m_dims[d].m_id, nextId, vals[d]);
 
         // Transformation only applies to X, Y and Z
         double x = view->getFieldAs<double>(Dimension::Id::X, nextId);
@@ -401,7 +515,6 @@ point_count_t BpfReader::readPointMajor(PointViewPtr view, point_count_t count)
         if (m_cb)
             m_cb(*view, nextId);
 
-        idx++;
         numRead++;
         nextId++;
     }
@@ -421,7 +534,6 @@ void BpfReader::readDimMajor(PointRef& point)
             m_streams.emplace_back(new ILeStream());
             m_streams.back()->open(m_filename);
 
-#ifdef PDAL_HAVE_ZLIB
             if (m_header.m_compression)
             {
                 m_charbufs.emplace_back(new Charbuf());
@@ -431,7 +543,6 @@ void BpfReader::readDimMajor(PointRef& point)
                 m_streams.back()->pushStream(
                         new std::istream(m_charbufs.back().get()));
             }
-#endif // PDAL_HAVE_ZLIB
 
             m_streams.back()->seek(m_start + offset);
         }
@@ -464,46 +575,6 @@ void BpfReader::readDimMajor(PointRef& point)
 }
 
 
-point_count_t BpfReader::readDimMajor(PointViewPtr data, point_count_t count)
-{
-    PointId idx(0);
-    PointId startId = data->size();
-    point_count_t numRead = 0;
-    for (size_t d = 0; d < m_dims.size(); ++d)
-    {
-        idx = m_index;
-        PointId nextId = startId;
-        numRead = 0;
-        seekDimMajor(d, idx);
-        for (; numRead < count && idx < numPoints(); idx++, numRead++, nextId++)
-        {
-            float f;
-
-            m_stream >> f;
-            data->setField(m_dims[d].m_id, nextId, f + m_dims[d].m_offset);
-        }
-    }
-    m_index = idx;
-
-    // Transformation only applies to X, Y and Z
-    for (PointId idx = startId; idx < data->size(); idx++)
-    {
-        double x = data->getFieldAs<double>(Dimension::Id::X, idx);
-        double y = data->getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = data->getFieldAs<double>(Dimension::Id::Z, idx);
-        m_header.m_xform.apply(x, y, z);
-        data->setField(Dimension::Id::X, idx, x);
-        data->setField(Dimension::Id::Y, idx, y);
-        data->setField(Dimension::Id::Z, idx, z);
-
-        if (m_cb)
-            m_cb(*data, idx);
-    }
-
-    return numRead;
-}
-
-
 void BpfReader::readByteMajor(PointRef& point)
 {
     // We need a temp buffer for the point data
@@ -544,49 +615,37 @@ void BpfReader::readByteMajor(PointRef& point)
 }
 
 
-point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
+// Read points from dimension-major or byte-major data one dimension at a
+// time.  When there is a hint, the position and time dimensions are read
+// first to determine which points pass, and only those points are stored.
+point_count_t BpfReader::readColumns(PointViewPtr data, point_count_t count)
 {
-    PointId idx(0);
+    count = (std::min)(count, numPoints() - m_index);
     PointId startId = data->size();
-    point_count_t numRead = 0;
 
-    // We need a temp buffer for the point data
-    union uu
+    std::vector<char> keep(count, true);
+    if (m_hinted)
     {
-        float f;
-        uint32_t u32;
-    };
-    std::unique_ptr<union uu> uArr(
-        new uu[std::min(count, numPoints() - m_index)]);
+        std::vector<double> x, y, z, t;
+        readDimension(m_xDim, count, x);
+        readDimension(m_yDim, count, y);
+        readDimension(m_zDim, count, z);
+        if (m_timeDim >= 0)
+            readDimension(m_timeDim, count, t);
+        for (point_count_t i = 0; i < count; ++i)
+            keep[i] = passesHint(x[i], y[i], z[i], t.size() ? t[i] : 0);
+    }
 
+    std::vector<double> vals;
     for (size_t d = 0; d < m_dims.size(); ++d)
     {
-        for (size_t b = 0; b < sizeof(float); ++b)
-        {
-            idx = m_index;
-            numRead = 0;
-            PointId nextId = startId;
-            seekByteMajor(d, b, idx);
-
-            for (;numRead < count && idx < numPoints();
-                idx++, numRead++, nextId++)
-            {
-                union uu& u = *(uArr.get() + numRead);
-
-                if (b == 0)
-                    u.u32 = 0;
-                uint8_t u8;
-                m_stream >> u8;
-                u.u32 |= ((uint32_t)u8 << (b * CHAR_BIT));
-                if (b == 3)
-                {
-                    u.f += m_dims[d].m_offset;
-                    data->setField(m_dims[d].m_id, nextId, u.f);
-                }
-            }
-        }
+        readDimension(d, count, vals);
+        PointId nextId = startId;
+        for (point_count_t i = 0; i < count; ++i)
+            if (keep[i])
+                data->setField(m_dims[d].m_id, nextId++, vals[i]);
     }
-    m_index = idx;
+    m_index += count;
 
     // Transformation only applies to X, Y and Z
     for (PointId idx = startId; idx < data->size(); idx++)
@@ -603,7 +662,49 @@ point_count_t BpfReader::readByteMajor(PointViewPtr data, point_count_t count)
             m_cb(*data, idx);
     }
 
-    return numRead;
+    return data->size() - startId;
+}
+
+
+// Read the values of a dimension for 'count' points, starting with the
+// current point, from dimension-major or byte-major data.
+void BpfReader::readDimension(size_t dim, point_count_t count,
+    std::vector<double>& vals)
+{
+    vals.resize(count);
+    if (m_header.m_pointFormat == BpfFormat::DimMajor)
+    {
+        seekDimMajor(dim, m_index);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            float f;
+
+            m_stream >> f;
+            vals[i] = f + m_dims[dim].m_offset;
+        }
+        return;
+    }
+
+    std::vector<uint32_t> words(count, 0);
+    for (size_t b = 0; b < sizeof(float); ++b)
+    {
+        seekByteMajor(dim, b, m_index);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            uint8_t u8;
+
+            m_stream >> u8;
+            words[i] |= ((uint32_t)u8 << (b * CHAR_BIT));
+        }
+    }
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        float f;
+
+        memcpy(&f, &words[i], sizeof(f));
+        f += m_dims[dim].m_offset;
+        vals[i] = f;
+    }
 }
 
 
@@ -632,52 +733,132 @@ void BpfReader::seekByteMajor(size_t dimIdx, size_t byteIdx, PointId ptIdx)
 }
 
 
-#ifdef PDAL_HAVE_ZLIB
-size_t BpfReader::readBlock(std::vector<char>& outBuf, size_t index)
+// Compressed data is a sequence of blocks, each preceded by its raw and
+// compressed sizes.  The block headers are scanned and the compressed data
+// read, after which the blocks are inflated into place concurrently.
+void BpfReader::readCompressedBlocks()
 {
-    uint32_t finalBytes;
-    uint32_t compressBytes;
+    struct Block
+    {
+        size_t m_inPos;
+        uint32_t m_inSize;
+        size_t m_outPos;
+        uint32_t m_outSize;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<char> in;
+    size_t outPos = 0;
+    while (outPos < m_deflateBuf.size())
+    {
+        uint32_t finalBytes;
+        uint32_t compressBytes;
+
+        m_stream >> finalBytes >> compressBytes;
+        if (!m_stream)
+            break;
+        if (finalBytes == 0)
+        {
+            m_stream.skip(compressBytes);
+            continue;
+        }
+        if (finalBytes > m_deflateBuf.size() - outPos)
+            throwError("Compressed block at position " +
+                Utils::toString(m_stream.position()) + " in '" + m_filename +
+                "' contains more data than expected.");
+
+        size_t inPos = in.size();
+        in.resize(inPos + compressBytes);
+        m_stream.get(in.data() + inPos, compressBytes);
+        if (!m_stream)
+            break;
+        blocks.push_back({ inPos, compressBytes, outPos, finalBytes });
+        outPos += finalBytes;
+    }
 
-    m_stream >> finalBytes;
-    m_stream >> compressBytes;
+    ThreadPool pool(m_threads);
+    size_t numTasks = (std::min)(pool.numThreads(), blocks.size());
+    std::vector<char> failed(numTasks, false);
+    for (size_t task = 0; task < numTasks; ++task)
+    {
+        pool.add([this, task, numTasks, &blocks, &in, &failed]()
+        {
+            // The decompressor is reused for each block.
+            BpfDecompressor decompressor(m_header.compression());
+            for (size_t b = task; b < blocks.size(); b += numTasks)
+            {
+                const Block& block = blocks[b];
 
-    std::vector<char> in(compressBytes);
+                if (!decompressor.decompress(in.data() + block.m_inPos,
+                    block.m_inSize, m_deflateBuf.data() + block.m_outPos,
+                    block.m_outSize))
+                {
+                    failed[task] = true;
+                    break;
+                }
+            }
+        });
+    }
+    pool.await();
 
-    // Fill the input bytes from the stream.
-    m_stream.get(in);
-    int ret = inflate(in.data(), compressBytes,
-        outBuf.data() + index, finalBytes);
-    return (ret ? 0 : finalBytes);
+    if (std::find(failed.begin(), failed.end(), (char)true) != failed.end())
+        throwError("Unable to decompress compressed data in '" +
+            m_filename + "'.");
 }
 
 
-int BpfReader::inflate(char *buf, uint32_t insize,
-    char *outbuf, uint32_t outsize)
+// Undo the filters applied to each dimension's data by the writer.  The
+// data for each dimension is stored contiguously in both dimension-major
+// and byte-major formats.
+void BpfReader::unfilter()
 {
-   if (insize == 0)
-        return 0;
-
-    int ret;
-    z_stream strm;
-
-    /* allocate inflate state */
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    strm.avail_in = 0;
-    strm.next_in = Z_NULL;
-    if (inflateInit(&strm) != Z_OK)
-        return -2;
-
-    strm.avail_in = insize;
-    strm.next_in = (unsigned char *)buf;
-    strm.avail_out = outsize;
-    strm.next_out = (unsigned char *)outbuf;
-
-    ret = ::inflate(&strm, Z_NO_FLUSH);
-    (void)inflateEnd(&strm);
-    return ret == Z_STREAM_END ? 0 : -1;
+    const size_t count = numPoints();
+    const bool byteMajor = (m_header.m_pointFormat == BpfFormat::ByteMajor);
+    const bool planes = byteMajor || m_header.filtered(BpfFilter::Shuffle);
+    const bool delta = m_header.filtered(BpfFilter::Delta);
+
+    ThreadPool pool(m_threads);
+    for (size_t dim = 0; dim < m_dims.size(); ++dim)
+    {
+        pool.add([this, dim, count, byteMajor, planes, delta]()
+        {
+            unsigned char *buf = (unsigned char *)m_deflateBuf.data() +
+                dim * count * sizeof(float);
+            std::vector<uint32_t> words(count);
+
+            if (planes)
+            {
+                for (size_t b = 0; b < sizeof(float); ++b)
+                    for (size_t i = 0; i < count; ++i)
+                        words[i] |= (uint32_t)buf[b * count + i] <<
+                            (b * CHAR_BIT);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                    for (size_t b = 0; b < sizeof(float); ++b)
+                        words[i] |= (uint32_t)buf[i * sizeof(float) + b] <<
+                            (b * CHAR_BIT);
+            }
+
+            if (delta)
+                for (size_t i = 1; i < count; ++i)
+                    words[i] += words[i - 1];
+
+            // Byte-major data remains in byte planes.
+            for (size_t i = 0; i < count; ++i)
+                for (size_t b = 0; b < sizeof(float); ++b)
+                {
+                    unsigned char c = (unsigned char)(words[i] >>
+                        (b * CHAR_BIT));
+                    if (byteMajor)
+                        buf[b * count + i] = c;
+                    else
+                        buf[i * sizeof(float) + b] = c;
+                }
+        });
+    }
+    pool.await();
 }
-#endif // PDAL_HAVE_ZLIB
 
 } //namespace pdal
@@ -76,11 +76,21 @@ private:
     std::vector<char> m_deflateBuf;
     /// Streambuf for deflated data.
     Charbuf m_charbuf;
+    /// Number of threads used to inflate compressed data.
+    size_t m_threads;
+    /// Whether points are tested against the read hint.
+    bool m_hinted;
+    /// Indices of the position and time dimensions, for testing hints.
+    int m_xDim;
+    int m_yDim;
+    int m_zDim;
+    int m_timeDim;
 
     // For dimension-major point-at-a-time usage.
     std::vector<std::unique_ptr<ILeStream>> m_streams;
     std::vector<std::unique_ptr<Charbuf>> m_charbufs;
 
+    virtual void addArgs(ProgramArgs& args);
     virtual QuickInfo inspect();
     virtual void initialize();
     virtual void addDimensions(PointLayoutPtr Layout);
@@ -96,12 +106,17 @@ private:
     void readPointMajor(PointRef& point);
     point_count_t readPointMajor(PointViewPtr data, point_count_t count);
     void readDimMajor(PointRef& point);
-    point_count_t readDimMajor(PointViewPtr data, point_count_t count);
     void readByteMajor(PointRef& point);
-    point_count_t readByteMajor(PointViewPtr data, point_count_t count);
-    size_t readBlock(std::vector<char>& outBuf, size_t index);
+    point_count_t readColumns(PointViewPtr data, point_count_t count);
+    void readDimension(size_t dim, point_count_t count,
+        std::vector<double>& vals);
+    void readCompressedBlocks();
+    bool hintOverlaps();
+    bool passesHint(double x, double y, double z, double time);
+    bool passesHint(const std::vector<double>& vals);
+    bool passesHint(const PointRef& point);
+    void unfilter();
     bool eof();
-    int inflate(char *inbuf, uint32_t insize, char *outbuf, uint32_t outsize);
 
     void seekPointMajor(PointId ptIdx);
     void seekDimMajor(size_t dimIdx, PointId ptIdx);
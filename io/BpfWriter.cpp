@@ -41,6 +41,7 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "BpfCompressor.hpp"
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -61,6 +62,23 @@ CREATE_STATIC_STAGE(BpfWriter, s_info)
 
 std::string BpfWriter::getName() const { return s_info.name; }
 
+
+bool BpfWriter::usedDimensions(StringList& dims) const
+{
+    StringList names = m_options.getValues("output_dims");
+    if (names.empty())
+        return false;
+    for (const std::string& name : names)
+        for (std::string dim : Utils::split2(name, ','))
+        {
+            Utils::trim(dim);
+            if (dim.size())
+                dims.push_back(dim);
+        }
+    dims.insert(dims.end(), { "X", "Y", "Z" });
+    return true;
+}
+
 std::istream& operator>>(std::istream& in, BpfWriter::CoordId& id)
 {
     std::string s;
@@ -84,7 +102,14 @@ std::ostream& operator<<(std::ostream& out, const BpfWriter::CoordId& id)
 void BpfWriter::addArgs(ProgramArgs& args)
 {
     args.add("filename", "Output filename", m_filename).setPositional();
-    args.add("compression", "Output compression", m_compression);
+    args.add("compression", "Output compression: 'none', 'zlib' or 'zstd'",
+        m_compressionSpec, "none");
+    m_levelArg = &args.add("compression_level", "Codec-specific "
+        "compression level", m_level);
+    args.add("shuffle", "Store bytes of each dimension's values in separate "
+        "planes before compression", m_shuffle);
+    args.add("delta", "Store the difference between successive values of "
+        "each dimension before compression", m_delta);
     args.add("header_data", "Base64-encoded header data", m_extraDataSpec);
     args.add("format", "Output format", m_header.m_pointFormat,
         BpfFormat::DimMajor);
@@ -92,6 +117,8 @@ void BpfWriter::addArgs(ProgramArgs& args)
     args.add("bundledfile", "List of files to bundle in output",
         m_bundledFilesSpec);
     args.add("output_dims", "Output dimensions", m_outputDims);
+    args.add("threads", "Number of threads used to compress data (0 uses "
+        "all available hardware threads)", m_threads, (size_t)0);
     m_scaling.addArgs(args);
 }
 
@@ -101,13 +128,44 @@ void BpfWriter::initialize()
     m_header.m_coordId = m_coordId.m_val;
     m_header.m_coordType = Utils::toNative(m_header.m_coordId ?
         BpfCoordType::UTM : BpfCoordType::Cartesian);
-#ifndef PDAL_HAVE_ZLIB
-    if (m_compression)
-        throwError("Can't write compressed BPF. PDAL wasn't built with "
-            "Zlib support.");
-#endif
-    m_header.m_compression = Utils::toNative(
-            m_compression ? BpfCompression::Zlib : BpfCompression::None);
+
+    // "true" and "false" are accepted for compatibility with the boolean
+    // form of the option.
+    BpfCompression codec;
+    std::string spec = Utils::tolower(m_compressionSpec);
+    if (spec == "none" || spec == "false")
+        codec = BpfCompression::None;
+    else if (spec == "zlib" || spec == "true")
+        codec = BpfCompression::Zlib;
+    else if (spec == "zstd")
+        codec = BpfCompression::Zstd;
+    else
+        throwError("Invalid value '" + m_compressionSpec + "' for option "
+            "'compression'.  Must be 'none', 'zlib' or 'zstd'.");
+    if (!BpfCompressor::supported(codec))
+        throwError("Can't write '" + spec + "' compressed BPF. PDAL wasn't "
+            "built with " + spec + " support.");
+
+    if (!m_levelArg->set())
+        m_level = BpfCompressor::defaultLevel(codec);
+    else if (!BpfCompressor::validLevel(codec, m_level))
+        throwError("Invalid compression level " +
+            Utils::toString(m_level) + " for '" + spec + "' compression.");
+
+    m_header.m_compression = Utils::toNative(codec);
+    if (m_shuffle || m_delta)
+    {
+        if (codec == BpfCompression::None)
+            throwError("Options 'shuffle' and 'delta' require compression.");
+        if (m_header.m_pointFormat == BpfFormat::PointMajor)
+            throwError("Options 'shuffle' and 'delta' can't be used with "
+                "point-major format.");
+        // Byte-major data is already stored in byte planes.
+        if (m_shuffle && m_header.m_pointFormat == BpfFormat::DimMajor)
+            m_header.m_compression |= Utils::toNative(BpfFilter::Shuffle);
+        if (m_delta)
+            m_header.m_compression |= Utils::toNative(BpfFilter::Delta);
+    }
     m_extraData = Utils::base64_decode(m_extraDataSpec);
 
     for (auto file : m_bundledFilesSpec)
@@ -258,16 +316,29 @@ void BpfWriter::writeView(const PointViewPtr dataShared)
 }
 
 
+size_t BpfWriter::compressionThreads() const
+{
+    if (!m_header.m_compression)
+        return 1;
+    return m_threads ? m_threads : ThreadPool::hardwareThreads();
+}
+
+
 void BpfWriter::writePointMajor(const PointView* data)
 {
-    // Blocks of 10,000 points will ensure that we're under 16MB, even
-    // for 255 dimensions.
-    size_t blockpoints = std::min<point_count_t>(10000UL, data->size());
+    // Write 10,000 points at a time.  When compressing, buffer enough
+    // points to give each thread a block to compress.
+    size_t blockpoints = 10000;
+    if (m_header.m_compression)
+        blockpoints = std::max(blockpoints, compressionThreads() *
+            BpfCompressor::BlockSize / (sizeof(float) * m_dims.size()));
+    blockpoints = std::min<point_count_t>(blockpoints, data->size());
 
     // For compression we're going to write to a buffer so that it can be
     // compressed before it's written to the file stream.
     BpfCompressor compressor(m_stream,
-        blockpoints * sizeof(float) * m_dims.size());
+        blockpoints * sizeof(float) * m_dims.size(), m_header.compression(),
+        m_level, compressionThreads());
     PointId idx = 0;
     while (idx < data->size())
     {
@@ -295,16 +366,26 @@ void BpfWriter::writePointMajor(const PointView* data)
 void BpfWriter::writeDimMajor(const PointView* data)
 {
     // We're going to pretend for now that we only ever have one point buffer.
-    BpfCompressor compressor(m_stream, data->size() * sizeof(float));
+    BpfCompressor compressor(m_stream, data->size() * sizeof(float),
+        m_header.compression(), m_level, compressionThreads());
 
+    const bool shuffle = m_header.filtered(BpfFilter::Shuffle);
+    std::vector<uint32_t> words;
     for (auto & bpfDim : m_dims)
     {
         if (m_header.m_compression)
             compressor.startBlock();
-        for (PointId idx = 0; idx < data->size(); ++idx)
+        loadWords(data, bpfDim, words);
+        if (shuffle)
         {
-            double d = getAdjustedValue(data, bpfDim, idx);
-            m_stream << (float)d;
+            for (size_t b = 0; b < sizeof(float); b++)
+                for (uint32_t w : words)
+                    m_stream << (uint8_t)(w >> (b * CHAR_BIT));
+        }
+        else
+        {
+            for (uint32_t w : words)
+                m_stream << w;
         }
         if (m_header.m_compression)
         {
@@ -317,29 +398,20 @@ void BpfWriter::writeDimMajor(const PointView* data)
 
 void BpfWriter::writeByteMajor(const PointView* data)
 {
-    union
-    {
-        float f;
-        uint32_t u32;
-    } uu;
-
     // We're going to pretend for now that we only ever have one point buffer.
     BpfCompressor compressor(m_stream,
-        data->size() * sizeof(float) * m_dims.size());
+        data->size() * sizeof(float) * m_dims.size(), m_header.compression(),
+        m_level, compressionThreads());
 
     if (m_header.m_compression)
         compressor.startBlock();
+    std::vector<uint32_t> words;
     for (auto & bpfDim : m_dims)
     {
+        loadWords(data, bpfDim, words);
         for (size_t b = 0; b < sizeof(float); b++)
-        {
-            for (PointId idx = 0; idx < data->size(); ++idx)
-            {
-                uu.f = (float)getAdjustedValue(data, bpfDim, idx);
-                uint8_t u8 = (uint8_t)(uu.u32 >> (b * CHAR_BIT));
-                m_stream << u8;
-            }
-        }
+            for (uint32_t w : words)
+                m_stream << (uint8_t)(w >> (b * CHAR_BIT));
     }
     if (m_header.m_compression)
     {
@@ -349,6 +421,30 @@ void BpfWriter::writeByteMajor(const PointView* data)
 }
 
 
+// Load the bits of the adjusted float values of a dimension, applying
+// the delta filter if requested.  Differences are taken between the
+// integer representations, so the filter is lossless.
+void BpfWriter::loadWords(const PointView* data, BpfDimension& bpfDim,
+    std::vector<uint32_t>& words)
+{
+    union
+    {
+        float f;
+        uint32_t u32;
+    } uu;
+
+    words.resize(data->size());
+    for (PointId idx = 0; idx < data->size(); ++idx)
+    {
+        uu.f = (float)getAdjustedValue(data, bpfDim, idx);
+        words[idx] = uu.u32;
+    }
+    if (m_header.filtered(BpfFilter::Delta))
+        for (size_t i = words.size(); i-- > 1;)
+            words[i] -= words[i - 1];
+}
+
+
 double BpfWriter::getAdjustedValue(const PointView* data,
     BpfDimension& bpfDim, PointId idx)
 {
@@ -61,15 +61,21 @@ public:
     };
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     StringList m_outputDims; ///< List of dimensions to write
+    size_t m_threads; ///< Number of threads used for compression
     OLeStream m_stream;
     BpfHeader m_header;
     BpfDimensionList m_dims;
     std::vector<uint8_t> m_extraData;
     std::vector<BpfUlemFile> m_bundledFiles;
-    bool m_compression;
+    std::string m_compressionSpec;
+    int m_level;
+    Arg *m_levelArg;
+    bool m_shuffle;
+    bool m_delta;
     CoordId m_coordId;
     std::string m_extraDataSpec;
     StringList m_bundledFilesSpec;
@@ -86,9 +92,12 @@ private:
     double getAdjustedValue(const PointView* data, BpfDimension& bpfDim,
         PointId idx);
     void loadBpfDimensions(PointLayoutPtr layout);
+    size_t compressionThreads() const;
     void writePointMajor(const PointView* data);
     void writeDimMajor(const PointView* data);
     void writeByteMajor(const PointView* data);
+    void loadWords(const PointView* data, BpfDimension& bpfDim,
+        std::vector<uint32_t>& words);
     void writeCompressedBlock(char *buf, size_t size);
 };
 
@@ -0,0 +1,351 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "ColumnarCommon.hpp"
+
+#include <cstring>
+
+#include <pdal/pdal_features.hpp>
+#include <pdal/compression/Compression.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+#include <pdal/util/Utils.hpp>
+
+#ifdef PDAL_HAVE_ZLIB
+#include <pdal/compression/DeflateCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_ZSTD
+#include <pdal/compression/ZstdCompression.hpp>
+#endif
+#ifdef PDAL_HAVE_LZMA
+#include <pdal/compression/LzmaCompression.hpp>
+#endif
+
+namespace pdal
+{
+namespace columnar
+{
+
+namespace
+{
+
+// Zstd's own default level, which favors speed over ratio.
+const int ZstdDefaultLevel = 3;
+
+void writeString(OLeStream& out, const std::string& s)
+{
+    out << (uint32_t)s.size();
+    out.put(s);
+}
+
+
+std::string readString(ILeStream& in)
+{
+    uint32_t size;
+    in >> size;
+    if (!in || size > (1 << 24))
+        throw error("Invalid string in footer.");
+
+    std::string s;
+    in.get(s, size);
+    return s;
+}
+
+} // unnamed namespace
+
+
+std::istream& operator>>(std::istream& in, Codec& codec)
+{
+    std::string s;
+    in >> s;
+    s = Utils::tolower(s);
+    if (s == "none")
+        codec = Codec::None;
+    else if (s == "deflate")
+        codec = Codec::Deflate;
+    else if (s == "zstd")
+        codec = Codec::Zstd;
+    else if (s == "lzma")
+        codec = Codec::Lzma;
+    else
+        in.setstate(std::ios_base::failbit);
+    return in;
+}
+
+
+std::ostream& operator<<(std::ostream& out, const Codec& codec)
+{
+    switch (codec)
+    {
+    case Codec::None:
+        out << "none";
+        break;
+    case Codec::Deflate:
+        out << "deflate";
+        break;
+    case Codec::Zstd:
+        out << "zstd";
+        break;
+    case Codec::Lzma:
+        out << "lzma";
+        break;
+    }
+    return out;
+}
+
+
+point_count_t Footer::numPoints() const
+{
+    point_count_t count = 0;
+    for (const Chunk& chunk : m_chunks)
+        count += chunk.m_numPoints;
+    return count;
+}
+
+
+int Footer::findColumn(const std::string& name) const
+{
+    for (size_t i = 0; i < m_columns.size(); ++i)
+        if (m_columns[i].m_name == name)
+            return (int)i;
+    return -1;
+}
+
+
+void Footer::write(OLeStream& out) const
+{
+    out << Version << (uint8_t)m_codec;
+    writeString(out, m_srs);
+    out << (uint32_t)m_columns.size();
+    for (const Column& col : m_columns)
+    {
+        writeString(out, col.m_name);
+        out << (uint32_t)Utils::toNative(col.m_type);
+    }
+    out << (uint64_t)m_chunks.size();
+    for (const Chunk& chunk : m_chunks)
+    {
+        out << chunk.m_numPoints;
+        for (const ColumnChunk& col : chunk.m_columns)
+            out << col.m_offset << col.m_size << col.m_min << col.m_max;
+    }
+}
+
+
+void Footer::read(ILeStream& in)
+{
+    uint32_t version;
+    uint8_t codec;
+
+    in >> version >> codec;
+    if (version != Version)
+        throw error("Unsupported version " + Utils::toString(version) + ".");
+    if (codec > Utils::toNative(Codec::Lzma))
+        throw error("Unsupported compression type " +
+            Utils::toString((int)codec) + ".");
+    m_codec = (Codec)codec;
+    m_srs = readString(in);
+
+    uint32_t numColumns;
+    in >> numColumns;
+    if (!in || numColumns > (1 << 16))
+        throw error("Invalid number of columns.");
+    m_columns.resize(numColumns);
+    for (Column& col : m_columns)
+    {
+        uint32_t type;
+
+        col.m_name = readString(in);
+        in >> type;
+        col.m_type = (Dimension::Type)type;
+        if (Dimension::size(col.m_type) == 0)
+            throw error("Invalid type for column '" + col.m_name + "'.");
+    }
+
+    uint64_t numChunks;
+    in >> numChunks;
+    if (!in || numChunks > (1 << 30))
+        throw error("Invalid number of chunks.");
+    m_chunks.resize(numChunks);
+    for (Chunk& chunk : m_chunks)
+    {
+        in >> chunk.m_numPoints;
+        chunk.m_columns.resize(numColumns);
+        for (ColumnChunk& col : chunk.m_columns)
+            in >> col.m_offset >> col.m_size >> col.m_min >> col.m_max;
+    }
+    if (!in)
+        throw error("Unexpected end of footer.");
+}
+
+
+bool supported(Codec codec)
+{
+    switch (codec)
+    {
+    case Codec::None:
+        return true;
+#ifdef PDAL_HAVE_ZLIB
+    case Codec::Deflate:
+        return true;
+#endif
+#ifdef PDAL_HAVE_ZSTD
+    case Codec::Zstd:
+        return true;
+#endif
+#ifdef PDAL_HAVE_LZMA
+    case Codec::Lzma:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+
+void compress(Codec codec, const char *buf, size_t size,
+    std::vector<char>& out)
+{
+    out.clear();
+    auto cb = [&out](char *b, size_t bsize)
+    {
+        out.insert(out.end(), b, b + bsize);
+    };
+
+    try
+    {
+        switch (codec)
+        {
+        case Codec::None:
+            out.assign(buf, buf + size);
+            break;
+#ifdef PDAL_HAVE_ZLIB
+        case Codec::Deflate:
+        {
+            DeflateCompressor compressor(cb);
+            compressor.compress(buf, size);
+            compressor.done();
+            break;
+        }
+#endif
+#ifdef PDAL_HAVE_ZSTD
+        case Codec::Zstd:
+        {
+            ZstdCompressor compressor(cb, ZstdDefaultLevel);
+            compressor.compress(buf, size);
+            compressor.done();
+            break;
+        }
+#endif
+#ifdef PDAL_HAVE_LZMA
+        case Codec::Lzma:
+        {
+            LzmaCompressor compressor(cb);
+            compressor.compress(buf, size);
+            compressor.done();
+            break;
+        }
+#endif
+        default:
+            throw error("Unsupported compression type.");
+        }
+    }
+    catch (const compression_error& err)
+    {
+        throw error(err.what());
+    }
+}
+
+
+void decompress(Codec codec, const char *buf, size_t size, char *out,
+    size_t outSize)
+{
+    size_t pos = 0;
+    auto cb = [out, outSize, &pos](char *b, size_t bsize)
+    {
+        if (bsize > outSize - pos)
+            throw error("Column data larger than expected.");
+        memcpy(out + pos, b, bsize);
+        pos += bsize;
+    };
+
+    try
+    {
+        switch (codec)
+        {
+        case Codec::None:
+            cb(const_cast<char *>(buf), size);
+            break;
+#ifdef PDAL_HAVE_ZLIB
+        case Codec::Deflate:
+        {
+            DeflateDecompressor decompressor(cb);
+            decompressor.decompress(buf, size);
+            decompressor.done();
+            break;
+        }
+#endif
+#ifdef PDAL_HAVE_ZSTD
+        case Codec::Zstd:
+        {
+            ZstdDecompressor decompressor(cb);
+            decompressor.decompress(buf, size);
+            decompressor.done();
+            break;
+        }
+#endif
+#ifdef PDAL_HAVE_LZMA
+        case Codec::Lzma:
+        {
+            LzmaDecompressor decompressor(cb);
+            decompressor.decompress(buf, size);
+            decompressor.done();
+            break;
+        }
+#endif
+        default:
+            throw error("Unsupported compression type.");
+        }
+    }
+    catch (const compression_error& err)
+    {
+        throw error(err.what());
+    }
+    if (pos != outSize)
+        throw error("Column data smaller than expected.");
+}
+
+
+} // namespace columnar
+} // namespace pdal
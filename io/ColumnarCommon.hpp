@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pdal/Dimension.hpp>
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+class ILeStream;
+class OLeStream;
+
+/**
+  The columnar format stores each dimension of a chunk of points as an
+  independently compressed column.  The file is laid out as:
+
+    magic
+    chunk 0: column 0, column 1, ... column n
+    chunk 1: column 0, column 1, ... column n
+    ...
+    footer
+    footer offset (uint64)
+    magic
+
+  The footer holds the codec, the spatial reference, the column names and
+  types, and for each chunk its point count and the offset, compressed size
+  and minimum and maximum value of each of its columns.  Column data is
+  the little-endian, native-type values of a dimension.
+*/
+namespace columnar
+{
+
+const std::string Magic("PDALCOL1");
+const uint32_t Version = 1;
+
+struct error : public std::runtime_error
+{
+    error(const std::string& err) : std::runtime_error(err)
+    {}
+};
+
+enum class Codec
+{
+    None,
+    Deflate,
+    Zstd,
+    Lzma
+};
+
+std::istream& operator>>(std::istream& in, Codec& codec);
+std::ostream& operator<<(std::ostream& out, const Codec& codec);
+
+struct Column
+{
+    std::string m_name;
+    Dimension::Type m_type;
+};
+
+struct ColumnChunk
+{
+    uint64_t m_offset;
+    uint64_t m_size;
+    double m_min;
+    double m_max;
+};
+
+struct Chunk
+{
+    uint64_t m_numPoints;
+    std::vector<ColumnChunk> m_columns;
+};
+
+struct Footer
+{
+    Footer() : m_codec(Codec::None)
+    {}
+
+    Codec m_codec;
+    std::string m_srs;
+    std::vector<Column> m_columns;
+    std::vector<Chunk> m_chunks;
+
+    point_count_t numPoints() const;
+    /// Return the index of the named column or -1 if it doesn't exist.
+    int findColumn(const std::string& name) const;
+    void write(OLeStream& out) const;
+    void read(ILeStream& in);
+};
+
+/// Return true if the codec is available in this build.
+bool supported(Codec codec);
+
+/**
+  Compress a buffer.
+
+  \param codec  Compression codec.
+  \param buf  Data to compress.
+  \param size  Size of the data.
+  \param out  Compressed data.
+*/
+void compress(Codec codec, const char *buf, size_t size,
+    std::vector<char>& out);
+
+/**
+  Decompress a column chunk.  Throws columnar::error if the data doesn't
+  decompress to exactly the expected size.
+
+  \param codec  Compression codec.
+  \param buf  Compressed data.
+  \param size  Size of the compressed data.
+  \param out  Output buffer.
+  \param outSize  Expected size of the decompressed data.
+*/
+void decompress(Codec codec, const char *buf, size_t size, char *out,
+    size_t outSize);
+
+} // namespace columnar
+} // namespace pdal
@@ -0,0 +1,432 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "ColumnarReader.hpp"
+
+#include <cstring>
+#include <limits>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "readers.columnar",
+    "Columnar reader",
+    "http://pdal.io/stages/readers.columnar.html",
+    { "pcol" }
+};
+
+CREATE_STATIC_STAGE(ColumnarReader, s_info)
+
+std::string ColumnarReader::getName() const { return s_info.name; }
+
+ColumnarReader::ColumnarReader() : m_numOutput(0), m_xCol(-1), m_yCol(-1),
+    m_zCol(-1), m_nextChunk(0), m_batchIdx(0), m_pos(0)
+{}
+
+
+void ColumnarReader::addArgs(ProgramArgs& args)
+{
+    args.add("dimensions", "Dimensions to read.  All dimensions are read "
+        "if none are specified", m_dimNames);
+    args.add("bounds", "Bounds of points to read", m_bounds);
+    args.add("threads", "Number of threads used to decompress columns (0 "
+        "uses all available hardware threads)", m_threads, (size_t)0);
+}
+
+
+void ColumnarReader::readFooter()
+{
+    const size_t magicSize = columnar::Magic.size();
+
+    uint64_t fileSize = FileUtils::fileSize(m_filename);
+    if (fileSize < 2 * magicSize + sizeof(uint64_t))
+        throwError("Invalid file '" + m_filename + "'.");
+
+    ILeStream in(m_filename);
+    if (!in)
+        throwError("Unable to open '" + m_filename + "'.");
+
+    std::string head;
+    std::string tail;
+    uint64_t footerOffset;
+
+    in.get(head, magicSize);
+    in.seek(fileSize - magicSize - sizeof(uint64_t));
+    in >> footerOffset;
+    in.get(tail, magicSize);
+    if (head != columnar::Magic || tail != columnar::Magic ||
+        footerOffset >= fileSize)
+        throwError("Invalid file '" + m_filename + "'.");
+
+    in.seek(footerOffset);
+    try
+    {
+        m_footer.read(in);
+    }
+    catch (const columnar::error& err)
+    {
+        throwError("Invalid file '" + m_filename + "': " + err.what());
+    }
+}
+
+
+void ColumnarReader::initialize()
+{
+    m_footer = columnar::Footer();
+    readFooter();
+    if (!columnar::supported(m_footer.m_codec))
+    {
+        std::ostringstream oss;
+        oss << "Can't read '" << m_footer.m_codec << "' compressed "
+            "columns. PDAL wasn't built with " << m_footer.m_codec <<
+            " support.";
+        throwError(oss.str());
+    }
+    if (m_footer.m_srs.size())
+        setSpatialReference(SpatialReference(m_footer.m_srs));
+
+    m_columns.clear();
+    if (m_dimNames.empty())
+    {
+        // Only columns used downstream are decoded.
+        for (size_t col = 0; col < m_footer.m_columns.size(); ++col)
+            if (projected(m_footer.m_columns[col].m_name))
+                m_columns.push_back(col);
+    }
+    else
+    {
+        for (const std::string& name : m_dimNames)
+        {
+            int col = m_footer.findColumn(name);
+            if (col < 0)
+                throwError("Dimension '" + name + "' specified in "
+                    "'dimensions' option not found in '" + m_filename + "'.");
+            if (std::find(m_columns.begin(), m_columns.end(), (size_t)col) ==
+                    m_columns.end())
+                m_columns.push_back(col);
+        }
+    }
+    m_numOutput = m_columns.size();
+    m_ids.assign(m_columns.size(), Dimension::Id::Unknown);
+
+    // Points are limited by the 'bounds' option and by the limits of
+    // downstream filters.
+    m_limits = hint();
+    bool bounded = !m_bounds.to2d().empty();
+    if (bounded)
+    {
+        if (m_bounds.is3d())
+            m_limits.limit(m_bounds.to3d());
+        else
+            m_limits.limit(m_bounds.to2d());
+    }
+    const BOX3D& limits = m_limits.bounds();
+    const double lowest = std::numeric_limits<double>::lowest();
+    const double highest = (std::numeric_limits<double>::max)();
+    bool limitXY = limits.minx != lowest || limits.maxx != highest ||
+        limits.miny != lowest || limits.maxy != highest;
+    bool limitZ = limits.minz != lowest || limits.maxz != highest;
+
+    // Coordinates are decoded to test points against the limits even if
+    // they weren't requested.  Only the 'bounds' option requires them.
+    auto boundsColumn = [this, bounded](const std::string& name)
+    {
+        int col = m_footer.findColumn(name);
+        if (col < 0)
+        {
+            if (!bounded)
+                return -1;
+            throwError("Can't apply bounds.  Dimension '" + name +
+                "' not found in '" + m_filename + "'.");
+        }
+        auto it = std::find(m_columns.begin(), m_columns.end(), (size_t)col);
+        if (it != m_columns.end())
+            return (int)(it - m_columns.begin());
+        m_columns.push_back(col);
+        m_ids.push_back(Dimension::Id::Unknown);
+        return (int)(m_columns.size() - 1);
+    };
+
+    m_xCol = m_yCol = m_zCol = -1;
+    if (limitXY || limitZ)
+    {
+        m_xCol = boundsColumn("X");
+        m_yCol = boundsColumn("Y");
+        if (limitZ)
+            m_zCol = boundsColumn("Z");
+        if (m_xCol < 0 || m_yCol < 0)
+            m_xCol = m_yCol = m_zCol = -1;
+    }
+}
+
+
+QuickInfo ColumnarReader::inspect()
+{
+    QuickInfo qi;
+
+    initialize();
+    qi.m_valid = true;
+    qi.m_pointCount = m_footer.numPoints();
+    qi.m_srs = getSpatialReference();
+    for (const columnar::Column& col : m_footer.m_columns)
+        qi.m_dimNames.push_back(col.m_name);
+
+    // The bounds are computed from the chunk statistics.
+    int x = m_footer.findColumn("X");
+    int y = m_footer.findColumn("Y");
+    int z = m_footer.findColumn("Z");
+    if (x >= 0 && y >= 0 && z >= 0)
+    {
+        for (const columnar::Chunk& chunk : m_footer.m_chunks)
+        {
+            if (chunk.m_numPoints == 0)
+                continue;
+            qi.m_bounds.grow(chunk.m_columns[x].m_min,
+                chunk.m_columns[y].m_min, chunk.m_columns[z].m_min);
+            qi.m_bounds.grow(chunk.m_columns[x].m_max,
+                chunk.m_columns[y].m_max, chunk.m_columns[z].m_max);
+        }
+    }
+    return qi;
+}
+
+
+void ColumnarReader::addDimensions(PointLayoutPtr layout)
+{
+    // Columns added only for the bounds test aren't registered.
+    for (size_t i = 0; i < m_numOutput; ++i)
+    {
+        const columnar::Column& col = m_footer.m_columns[m_columns[i]];
+        m_ids[i] = layout->registerOrAssignDim(col.m_name, col.m_type);
+    }
+}
+
+
+void ColumnarReader::ready(PointTableRef)
+{
+    m_stream.reset(new ILeStream(m_filename));
+    m_pool.reset(new ThreadPool(m_threads));
+
+    m_chunks.clear();
+    for (size_t i = 0; i < m_footer.m_chunks.size(); ++i)
+        if (chunkOverlaps(m_footer.m_chunks[i]))
+            m_chunks.push_back(i);
+    log()->get(LogLevel::Debug) << getName() << ": reading " <<
+        m_chunks.size() << " of " << m_footer.m_chunks.size() <<
+        " chunks." << std::endl;
+
+    m_nextChunk = 0;
+    m_batch.clear();
+    m_batchIdx = 0;
+    m_pos = 0;
+}
+
+
+bool ColumnarReader::chunkOverlaps(const columnar::Chunk& chunk) const
+{
+    if (m_xCol < 0)
+        return true;
+
+    const columnar::ColumnChunk& x = chunk.m_columns[m_columns[m_xCol]];
+    const columnar::ColumnChunk& y = chunk.m_columns[m_columns[m_yCol]];
+    if (m_zCol < 0)
+    {
+        const BOX3D& limits = m_limits.bounds();
+        return m_limits.overlaps(BOX3D(x.m_min, y.m_min, limits.minz,
+            x.m_max, y.m_max, limits.maxz));
+    }
+
+    const columnar::ColumnChunk& z = chunk.m_columns[m_columns[m_zCol]];
+    return m_limits.overlaps(BOX3D(x.m_min, y.m_min, z.m_min,
+        x.m_max, y.m_max, z.m_max));
+}
+
+
+// Read the compressed columns of the next batch of chunks and decompress
+// them concurrently.
+bool ColumnarReader::loadBatch()
+{
+    const size_t numColumns = m_columns.size();
+    const size_t count = (std::min)(m_pool->numThreads(),
+        m_chunks.size() - m_nextChunk);
+
+    m_batch.resize(count);
+    m_batchIdx = 0;
+    m_pos = 0;
+    if (count == 0)
+        return false;
+
+    std::vector<std::vector<char>> in(count * numColumns);
+    for (size_t c = 0; c < count; ++c)
+    {
+        const columnar::Chunk& chunk =
+            m_footer.m_chunks[m_chunks[m_nextChunk + c]];
+        Decoded& decoded = m_batch[c];
+
+        decoded.m_numPoints = chunk.m_numPoints;
+        decoded.m_data.resize(numColumns);
+        for (size_t i = 0; i < numColumns; ++i)
+        {
+            const columnar::Column& col = m_footer.m_columns[m_columns[i]];
+            const columnar::ColumnChunk& colChunk =
+                chunk.m_columns[m_columns[i]];
+            std::vector<char>& buf = in[c * numColumns + i];
+
+            buf.resize(colChunk.m_size);
+            m_stream->seek(colChunk.m_offset);
+            m_stream->get(buf.data(), buf.size());
+            if (!*m_stream)
+                throwError("Unexpected end of file reading '" +
+                    m_filename + "'.");
+
+            std::vector<char>& out = decoded.m_data[i];
+            out.resize(chunk.m_numPoints * Dimension::size(col.m_type));
+            m_pool->add([this, &buf, &out]()
+            {
+                columnar::decompress(m_footer.m_codec, buf.data(),
+                    buf.size(), out.data(), out.size());
+            });
+        }
+    }
+    try
+    {
+        m_pool->await();
+    }
+    catch (const columnar::error& err)
+    {
+        throwError("Invalid data in '" + m_filename + "': " + err.what());
+    }
+    m_nextChunk += count;
+    return true;
+}
+
+
+// Position at the next point that passes the bounds test, loading chunks
+// as necessary.
+bool ColumnarReader::nextPoint()
+{
+    while (true)
+    {
+        if (m_batchIdx >= m_batch.size())
+        {
+            if (!loadBatch())
+                return false;
+            continue;
+        }
+        if (m_pos >= m_batch[m_batchIdx].m_numPoints)
+        {
+            m_batchIdx++;
+            m_pos = 0;
+            continue;
+        }
+        if (m_xCol < 0)
+            return true;
+
+        double x = value(m_xCol);
+        double y = value(m_yCol);
+        double z = m_zCol < 0 ? m_limits.bounds().minz : value(m_zCol);
+        if (m_limits.contains(x, y, z))
+            return true;
+        m_pos++;
+    }
+}
+
+
+double ColumnarReader::value(size_t col) const
+{
+    Dimension::Type type = m_footer.m_columns[m_columns[col]].m_type;
+    size_t size = Dimension::size(type);
+    Everything e;
+
+    memcpy(&e, m_batch[m_batchIdx].m_data[col].data() + m_pos * size, size);
+    return Utils::toDouble(e, type);
+}
+
+
+void ColumnarReader::setPoint(PointRef& point)
+{
+    const Decoded& decoded = m_batch[m_batchIdx];
+    for (size_t i = 0; i < m_columns.size(); ++i)
+    {
+        if (m_ids[i] == Dimension::Id::Unknown)
+            continue;
+        Dimension::Type type = m_footer.m_columns[m_columns[i]].m_type;
+        point.setField(m_ids[i], type,
+            decoded.m_data[i].data() + m_pos * Dimension::size(type));
+    }
+    m_pos++;
+}
+
+
+point_count_t ColumnarReader::read(PointViewPtr view, point_count_t count)
+{
+    PointId nextId = view->size();
+    point_count_t numRead = 0;
+    while (numRead < count && nextPoint())
+    {
+        PointRef point(view->point(nextId));
+        setPoint(point);
+        if (m_cb)
+            m_cb(*view, nextId);
+        nextId++;
+        numRead++;
+    }
+    return numRead;
+}
+
+
+bool ColumnarReader::processOne(PointRef& point)
+{
+    if (!nextPoint())
+        return false;
+    setPoint(point);
+    return true;
+}
+
+
+void ColumnarReader::done(PointTableRef)
+{
+    m_stream.reset();
+    m_pool.reset();
+    m_batch.clear();
+}
+
+} // namespace pdal
@@ -0,0 +1,105 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <pdal/Reader.hpp>
+#include <pdal/Streamable.hpp>
+#include <pdal/util/Bounds.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include "ColumnarCommon.hpp"
+
+namespace pdal
+{
+
+class PDAL_DLL ColumnarReader : public Reader, public Streamable
+{
+public:
+    ColumnarReader();
+
+    std::string getName() const;
+
+private:
+    // Decompressed columns of a chunk.
+    struct Decoded
+    {
+        point_count_t m_numPoints;
+        std::vector<std::vector<char>> m_data;
+    };
+
+    StringList m_dimNames;
+    Bounds m_bounds;
+    size_t m_threads;
+    columnar::Footer m_footer;
+    std::unique_ptr<ILeStream> m_stream;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    // Indices of the columns that are decoded, with the dimension to which
+    // each is written.  Columns following the first m_numOutput are only
+    // needed to test points against the limits and aren't written.
+    std::vector<size_t> m_columns;
+    std::vector<Dimension::Id> m_ids;
+    size_t m_numOutput;
+    int m_xCol;
+    int m_yCol;
+    int m_zCol;
+    ReadHint m_limits;
+
+    // Indices of chunks that overlap the limits.
+    std::vector<size_t> m_chunks;
+    size_t m_nextChunk;
+    std::vector<Decoded> m_batch;
+    size_t m_batchIdx;
+    PointId m_pos;
+
+    virtual void addArgs(ProgramArgs& args);
+    virtual void initialize();
+    virtual QuickInfo inspect();
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual void ready(PointTableRef table);
+    virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool processOne(PointRef& point);
+    virtual void done(PointTableRef table);
+
+    void readFooter();
+    bool chunkOverlaps(const columnar::Chunk& chunk) const;
+    bool loadBatch();
+    bool nextPoint();
+    double value(size_t col) const;
+    void setPoint(PointRef& point);
+};
+
+} // namespace pdal
@@ -0,0 +1,215 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "ColumnarWriter.hpp"
+
+#include <cstring>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "writers.columnar",
+    "Columnar writer",
+    "http://pdal.io/stages/writers.columnar.html",
+    { "pcol" }
+};
+
+CREATE_STATIC_STAGE(ColumnarWriter, s_info)
+
+std::string ColumnarWriter::getName() const { return s_info.name; }
+
+namespace
+{
+
+#if defined(PDAL_HAVE_ZSTD)
+const columnar::Codec DefaultCodec = columnar::Codec::Zstd;
+#elif defined(PDAL_HAVE_ZLIB)
+const columnar::Codec DefaultCodec = columnar::Codec::Deflate;
+#else
+const columnar::Codec DefaultCodec = columnar::Codec::None;
+#endif
+
+} // unnamed namespace
+
+
+void ColumnarWriter::addArgs(ProgramArgs& args)
+{
+    args.add("filename", "Output filename", m_filename).setPositional();
+    args.add("compression", "Column compression: 'none', 'deflate', "
+        "'zstd' or 'lzma'", m_codec, DefaultCodec);
+    args.add("chunk_size", "Number of points in each chunk", m_chunkSize,
+        (point_count_t)65536);
+    args.add("threads", "Number of threads used to compress columns (0 uses "
+        "all available hardware threads)", m_threads, (size_t)0);
+}
+
+
+void ColumnarWriter::initialize()
+{
+    if (!columnar::supported(m_codec))
+    {
+        std::ostringstream oss;
+        oss << "Can't write '" << m_codec << "' compressed columns. PDAL "
+            "wasn't built with " << m_codec << " support.";
+        throwError(oss.str());
+    }
+    if (m_chunkSize == 0)
+        throwError("Option 'chunk_size' must be greater than 0.");
+}
+
+
+void ColumnarWriter::ready(PointTableRef table)
+{
+    m_stream.reset(new OLeStream(m_filename));
+    if (!m_stream->isOpen())
+        throwError("Couldn't open '" + m_filename + "' for output.");
+    m_stream->put(columnar::Magic);
+
+    SpatialReference srs = getSpatialReference().empty() ?
+        table.anySpatialReference() : getSpatialReference();
+
+    m_footer = columnar::Footer();
+    m_footer.m_codec = m_codec;
+    m_footer.m_srs = srs.getWKT();
+
+    PointLayoutPtr layout(table.layout());
+    m_dims = layout->dims();
+    for (Dimension::Id id : m_dims)
+        m_footer.m_columns.push_back({ layout->dimName(id),
+            layout->dimType(id) });
+}
+
+
+void ColumnarWriter::write(const PointViewPtr view)
+{
+    using namespace columnar;
+
+    const size_t numColumns = m_dims.size();
+    const point_count_t numChunks =
+        (view->size() + m_chunkSize - 1) / m_chunkSize;
+
+    // Columns of a batch of chunks are compressed concurrently and then
+    // written in order.
+    ThreadPool pool(m_threads);
+    const size_t batchSize = pool.numThreads();
+    std::vector<Chunk> chunks(batchSize);
+    std::vector<std::vector<char>> bufs(batchSize * numColumns);
+
+    auto encode = [this, &view, &chunks, &bufs, numColumns](size_t c,
+        size_t col, PointId start)
+    {
+        const Column& column = m_footer.m_columns[col];
+        const Dimension::Id id = m_dims[col];
+        const size_t size = Dimension::size(column.m_type);
+        const point_count_t count = chunks[c].m_numPoints;
+        ColumnChunk& colChunk = chunks[c].m_columns[col];
+
+        std::vector<char> raw(count * size);
+        char *pos = raw.data();
+        colChunk.m_min = (std::numeric_limits<double>::max)();
+        colChunk.m_max = std::numeric_limits<double>::lowest();
+        for (PointId idx = start; idx < start + count; ++idx)
+        {
+            Everything e;
+
+            view->getRawField(id, idx, &e);
+            memcpy(pos, &e, size);
+            pos += size;
+
+            double d = Utils::toDouble(e, column.m_type);
+            colChunk.m_min = (std::min)(colChunk.m_min, d);
+            colChunk.m_max = (std::max)(colChunk.m_max, d);
+        }
+        compress(m_codec, raw.data(), raw.size(), bufs[c * numColumns + col]);
+    };
+
+    for (point_count_t first = 0; first < numChunks; first += batchSize)
+    {
+        size_t count = (size_t)(std::min)((point_count_t)batchSize,
+            numChunks - first);
+        for (size_t c = 0; c < count; ++c)
+        {
+            PointId start = (first + c) * m_chunkSize;
+            chunks[c].m_numPoints =
+                (std::min)(m_chunkSize, view->size() - start);
+            chunks[c].m_columns.resize(numColumns);
+            for (size_t col = 0; col < numColumns; ++col)
+                pool.add([&encode, c, col, start]()
+                    { encode(c, col, start); });
+        }
+        try
+        {
+            pool.await();
+        }
+        catch (const columnar::error& err)
+        {
+            throwError(err.what());
+        }
+
+        for (size_t c = 0; c < count; ++c)
+        {
+            for (size_t col = 0; col < numColumns; ++col)
+            {
+                const std::vector<char>& buf = bufs[c * numColumns + col];
+                ColumnChunk& colChunk = chunks[c].m_columns[col];
+
+                colChunk.m_offset = m_stream->position();
+                colChunk.m_size = buf.size();
+                m_stream->put(buf.data(), buf.size());
+            }
+            m_footer.m_chunks.push_back(chunks[c]);
+        }
+    }
+}
+
+
+void ColumnarWriter::done(PointTableRef)
+{
+    uint64_t footerOffset = m_stream->position();
+    m_footer.write(*m_stream);
+    *m_stream << footerOffset;
+    m_stream->put(columnar::Magic);
+    m_stream.reset();
+
+    getMetadata().addList("filename", m_filename);
+}
+
+} // namespace pdal
@@ -57,6 +57,16 @@ std::string GDALWriter::getName() const
 }
 
 
+bool GDALWriter::usedDimensions(StringList& dims) const
+{
+    dims = m_options.getValues("dimension");
+    if (dims.empty())
+        dims.push_back("Z");
+    dims.insert(dims.end(), { "X", "Y" });
+    return true;
+}
+
+
 void GDALWriter::addArgs(ProgramArgs& args)
 {
     args.add("filename", "Output filename", m_filename).setPositional();
@@ -48,6 +48,7 @@ class PDAL_DLL GDALWriter : public FlexWriter, public Streamable
 {
 public:
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
     GDALWriter() : m_outputTypes(0)
     {}
@@ -0,0 +1,324 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "LasHierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include <pdal/PointView.hpp>
+#include <pdal/ReadHint.hpp>
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/Inserter.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::string Magic("PDALLHY1");
+const uint32_t Version = 1;
+const size_t HeaderSize = 60;
+const size_t LevelSize = sizeof(uint64_t);
+const size_t ChunkSize = 2 * sizeof(uint64_t) + 6 * sizeof(double);
+
+// Spread the low 21 bits of a value so that there are two zero bits
+// between each.
+uint64_t spread(uint64_t v)
+{
+    v &= 0x1FFFFF;
+    v = (v | (v << 32)) & 0x1F00000000FFFF;
+    v = (v | (v << 16)) & 0x1F0000FF0000FF;
+    v = (v | (v << 8)) & 0x100F00F00F00F00F;
+    v = (v | (v << 4)) & 0x10C30C30C30C30C3;
+    v = (v | (v << 2)) & 0x1249249249249249;
+    return v;
+}
+
+} // unnamed namespace
+
+LasHierarchy::LasHierarchy() : m_numPoints(0), m_chunkSize(0)
+{}
+
+
+std::vector<PointId> LasHierarchy::build(const PointView& view,
+    uint32_t chunkSize)
+{
+    using namespace Dimension;
+
+    m_numPoints = view.size();
+    m_chunkSize = chunkSize;
+    m_levels.clear();
+    m_chunks.clear();
+
+    BOX3D bounds;
+    view.calculateBounds(bounds);
+    double size = (std::max)({ bounds.maxx - bounds.minx,
+        bounds.maxy - bounds.miny, bounds.maxz - bounds.minz });
+    if (!(size > 0))
+        size = 1;
+    m_cube = BOX3D(bounds.minx, bounds.miny, bounds.minz,
+        bounds.minx + size, bounds.miny + size, bounds.minz + size);
+
+    auto cell = [this, size](double v, double min, uint64_t cells)
+    {
+        double d = std::floor((v - min) / size * cells);
+        if (d < 0)
+            return (uint64_t)0;
+        if (d >= cells)
+            return cells - 1;
+        return (uint64_t)d;
+    };
+
+    // Place each point in the first level where its cell is empty.
+    std::vector<uint8_t> levels(view.size(), (uint8_t)MaxLevel);
+    std::vector<PointId> remaining(view.size());
+    for (PointId idx = 0; idx < view.size(); ++idx)
+        remaining[idx] = idx;
+    std::unordered_set<uint64_t> occupied;
+    for (int level = 0; level < MaxLevel && remaining.size(); ++level)
+    {
+        uint64_t cells = (uint64_t)BaseCells << level;
+        std::vector<PointId> next;
+        occupied.clear();
+        for (PointId idx : remaining)
+        {
+            uint64_t x = cell(view.getFieldAs<double>(Id::X, idx),
+                m_cube.minx, cells);
+            uint64_t y = cell(view.getFieldAs<double>(Id::Y, idx),
+                m_cube.miny, cells);
+            uint64_t z = cell(view.getFieldAs<double>(Id::Z, idx),
+                m_cube.minz, cells);
+            if (occupied.insert((x * cells + y) * cells + z).second)
+                levels[idx] = (uint8_t)level;
+            else
+                next.push_back(idx);
+        }
+        remaining.swap(next);
+    }
+
+    // Order by level, then by Morton code.
+    struct Entry
+    {
+        uint8_t m_level;
+        uint64_t m_code;
+        PointId m_id;
+    };
+
+    const uint64_t MortonCells = 1 << 21;
+    std::vector<Entry> entries(view.size());
+    for (PointId idx = 0; idx < view.size(); ++idx)
+    {
+        Entry& e = entries[idx];
+        e.m_level = levels[idx];
+        e.m_code =
+            spread(cell(view.getFieldAs<double>(Id::X, idx),
+                m_cube.minx, MortonCells)) |
+            (spread(cell(view.getFieldAs<double>(Id::Y, idx),
+                m_cube.miny, MortonCells)) << 1) |
+            (spread(cell(view.getFieldAs<double>(Id::Z, idx),
+                m_cube.minz, MortonCells)) << 2);
+        e.m_id = idx;
+    }
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& e1, const Entry& e2)
+        {
+            if (e1.m_level != e2.m_level)
+                return e1.m_level < e2.m_level;
+            return e1.m_code < e2.m_code;
+        });
+
+    std::vector<PointId> order(view.size());
+    for (PointId pos = 0; pos < entries.size(); ++pos)
+    {
+        const Entry& e = entries[pos];
+        order[pos] = e.m_id;
+        while (m_levels.size() <= e.m_level)
+            m_levels.push_back(pos);
+
+        if (pos % m_chunkSize == 0)
+            m_chunks.emplace_back();
+        m_chunks.back().m_bounds.grow(
+            view.getFieldAs<double>(Id::X, e.m_id),
+            view.getFieldAs<double>(Id::Y, e.m_id),
+            view.getFieldAs<double>(Id::Z, e.m_id));
+    }
+    return order;
+}
+
+
+void LasHierarchy::setLocation(size_t chunk, uint64_t offset, uint64_t size)
+{
+    m_chunks[chunk].m_offset = offset;
+    m_chunks[chunk].m_size = size;
+}
+
+
+int LasHierarchy::level(double resolution) const
+{
+    if (resolution <= 0)
+        return -1;
+
+    double spacing = (m_cube.maxx - m_cube.minx) / BaseCells;
+    int level = 0;
+    while (spacing > resolution && level + 1 < (int)m_levels.size())
+    {
+        spacing /= 2;
+        level++;
+    }
+    return level;
+}
+
+
+std::vector<LasHierarchy::Range> LasHierarchy::query(const ReadHint& limits,
+    int maxLevel) const
+{
+    std::vector<Range> ranges;
+
+    PointId end = m_numPoints;
+    if (maxLevel >= 0 && (size_t)maxLevel + 1 < m_levels.size())
+        end = m_levels[maxLevel + 1];
+
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+    {
+        PointId begin = (PointId)i * m_chunkSize;
+        if (begin >= end)
+            break;
+        if (!limits.overlaps(m_chunks[i].m_bounds))
+            continue;
+        PointId last = (std::min)(begin + m_chunkSize, end);
+        if (ranges.size() && ranges.back().second == begin)
+            ranges.back().second = last;
+        else
+            ranges.push_back({ begin, last });
+    }
+    return ranges;
+}
+
+
+const LasHierarchy::Chunk& LasHierarchy::chunk(PointId idx) const
+{
+    return m_chunks[idx / m_chunkSize];
+}
+
+
+bool LasHierarchy::located() const
+{
+    for (const Chunk& c : m_chunks)
+        if (c.m_size == 0)
+            return false;
+    return true;
+}
+
+
+std::vector<uint8_t> LasHierarchy::data() const
+{
+    std::vector<uint8_t> buf(HeaderSize + m_levels.size() * LevelSize +
+        sizeof(uint32_t) + m_chunks.size() * ChunkSize);
+    LeInserter out(buf.data(), buf.size());
+
+    out.put(Magic);
+    out << Version << (uint64_t)m_numPoints << m_chunkSize;
+    out << m_cube.minx << m_cube.miny << m_cube.minz <<
+        (m_cube.maxx - m_cube.minx);
+    out << (uint32_t)m_levels.size();
+    for (PointId start : m_levels)
+        out << (uint64_t)start;
+    out << (uint32_t)m_chunks.size();
+    for (const Chunk& c : m_chunks)
+    {
+        const BOX3D& b = c.m_bounds;
+        out << c.m_offset << c.m_size;
+        out << b.minx << b.miny << b.minz << b.maxx << b.maxy << b.maxz;
+    }
+    return buf;
+}
+
+
+void LasHierarchy::read(const char *buf, size_t size)
+{
+    if (size < HeaderSize + sizeof(uint32_t))
+        throw error("Hierarchy is too short.");
+
+    LeExtractor in(buf, size);
+    std::string magic;
+    in.get(magic, Magic.size());
+    if (magic != Magic)
+        throw error("Invalid hierarchy.");
+
+    uint32_t version;
+    uint64_t numPoints;
+    double minx, miny, minz, cubeSize;
+    in >> version;
+    if (version != Version)
+        throw error("Unsupported hierarchy version " +
+            std::to_string(version) + ".");
+    in >> numPoints >> m_chunkSize >> minx >> miny >> minz >> cubeSize;
+    if (m_chunkSize == 0)
+        throw error("Invalid hierarchy chunk size.");
+    m_numPoints = numPoints;
+    m_cube = BOX3D(minx, miny, minz,
+        minx + cubeSize, miny + cubeSize, minz + cubeSize);
+
+    uint32_t numLevels;
+    in >> numLevels;
+    if (size < HeaderSize + numLevels * LevelSize + sizeof(uint32_t))
+        throw error("Hierarchy is too short.");
+    m_levels.resize(numLevels);
+    for (PointId& start : m_levels)
+    {
+        uint64_t v;
+        in >> v;
+        start = v;
+    }
+
+    uint32_t numChunks;
+    in >> numChunks;
+    if (size != HeaderSize + numLevels * LevelSize + sizeof(uint32_t) +
+            numChunks * ChunkSize)
+        throw error("Invalid hierarchy size.");
+    if (numChunks != (m_numPoints + m_chunkSize - 1) / m_chunkSize)
+        throw error("Hierarchy chunk count doesn't match point count.");
+    m_chunks.resize(numChunks);
+    for (Chunk& c : m_chunks)
+    {
+        BOX3D& b = c.m_bounds;
+        in >> c.m_offset >> c.m_size;
+        in >> b.minx >> b.miny >> b.minz >> b.maxx >> b.maxy >> b.maxz;
+    }
+}
+
+} // namespace pdal
@@ -0,0 +1,180 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+class PointView;
+class ReadHint;
+
+/**
+  Chunk hierarchy of a cloud-optimized LAS/LAZ file, stored in a PDAL VLR
+  (or extended VLR, if too large for a VLR).
+
+  Points in a cloud-optimized file are ordered by level of detail.  Each
+  level covers the bounding cube of the points with a grid that has
+  BaseCells cells along each axis at level 0 and twice as many at each
+  following level.  A point is placed in the first level where its grid
+  cell doesn't yet hold a point, so reading levels 0 through N gives an
+  even sampling of the points with a spacing of about the cell size
+  at level N.  Within a level, points are in Morton order.
+
+  The points are written in chunks of a fixed number of points (LAZ
+  chunks, when compressed), so each chunk covers a compact area.  The
+  hierarchy records the first point of each level and the bounds and
+  location of each chunk.  The data is laid out as:
+
+    magic
+    version (uint32)
+    point count (uint64)
+    chunk size (uint32)
+    cube (minx, miny, minz, edge length as doubles)
+    level count (uint32), then the index of the first point of each level
+      (uint64)
+    chunk count (uint32), then for each chunk the offset of the chunk from
+      the start of point data and its size in bytes (uint64) and its
+      bounds (minx, miny, minz, maxx, maxy, maxz as doubles)
+
+  Values are little-endian.  A chunk size of 0 bytes means that the
+  location of the chunk isn't known.
+*/
+class PDAL_DLL LasHierarchy
+{
+public:
+    typedef std::pair<PointId, PointId> Range;
+
+    struct error : public std::runtime_error
+    {
+        error(const std::string& err) : std::runtime_error(err)
+        {}
+    };
+
+    struct Chunk
+    {
+        Chunk() : m_offset(0), m_size(0)
+        {}
+
+        uint64_t m_offset;
+        uint64_t m_size;
+        BOX3D m_bounds;
+    };
+
+    LasHierarchy();
+
+    /**
+      Build the hierarchy of the points in a view.
+
+      \param view  View holding the points.
+      \param chunkSize  Number of points in a chunk.
+      \return  IDs of the points of the view in the order they must be
+        written.
+    */
+    std::vector<PointId> build(const PointView& view, uint32_t chunkSize);
+
+    /**
+      Set the location of a chunk in the file.
+
+      \param chunk  Index of the chunk.
+      \param offset  Offset of the chunk from the start of point data.
+      \param size  Size of the chunk in bytes.
+    */
+    void setLocation(size_t chunk, uint64_t offset, uint64_t size);
+
+    /**
+      Find the level whose point spacing is no larger than a resolution.
+
+      \param resolution  Desired point spacing.  If 0, all levels are used.
+      \return  Index of the last level to read, or -1 for all levels.
+    */
+    int level(double resolution) const;
+
+    /**
+      Find the ranges of points in chunks that may hold points within the
+      limits, up to a level of detail.
+
+      \param limits  Limits of the points to read.
+      \param maxLevel  Last level to read, or -1 for all levels.
+      \return  Sorted, non-overlapping ranges [begin, end) of point indices.
+        Ranges always start at the beginning of a chunk.
+    */
+    std::vector<Range> query(const ReadHint& limits, int maxLevel) const;
+
+    /**
+      Get the chunk holding a point.
+
+      \param idx  Index of a point.
+      \return  Chunk holding the point.
+    */
+    const Chunk& chunk(PointId idx) const;
+
+    /// Whether the location of every chunk is known.
+    bool located() const;
+
+    point_count_t numPoints() const
+        { return m_numPoints; }
+    uint32_t chunkSize() const
+        { return m_chunkSize; }
+    size_t numLevels() const
+        { return m_levels.size(); }
+    size_t numChunks() const
+        { return m_chunks.size(); }
+
+    std::vector<uint8_t> data() const;
+    void read(const char *buf, size_t size);
+
+    /// Number of cells along each axis of the cube at level 0.
+    static const uint32_t BaseCells = 128;
+
+    /// Points not placed by this level are all placed in it.
+    static const int MaxLevel = 12;
+
+private:
+    point_count_t m_numPoints;
+    uint32_t m_chunkSize;
+    BOX3D m_cube;
+    std::vector<PointId> m_levels;
+    std::vector<Chunk> m_chunks;
+};
+
+} // namespace pdal
@@ -0,0 +1,257 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#include "LasIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+#include <pdal/util/Utils.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::string Magic("PDALLIX1");
+const uint32_t Version = 2;
+const uint32_t MaxCells = 1 << 22;
+
+} // unnamed namespace
+
+LasIndex::LasIndex() : m_numPoints(0), m_fileSize(0), m_cols(0), m_rows(0),
+    m_cellWidth(0), m_cellHeight(0)
+{}
+
+
+LasIndex::LasIndex(const BOX2D& bounds, point_count_t numPoints,
+        double cellSize) : m_numPoints(numPoints), m_fileSize(0),
+    m_bounds(bounds)
+{
+    double width = (std::max)(bounds.maxx - bounds.minx, 0.0);
+    double height = (std::max)(bounds.maxy - bounds.miny, 0.0);
+
+    if (cellSize <= 0)
+    {
+        double cells = (std::max)((double)numPoints / PointsPerCell, 1.0);
+        cellSize = std::sqrt(width * height / cells);
+    }
+
+    uint32_t cols = 1;
+    uint32_t rows = 1;
+    if (cellSize > 0)
+    {
+        cols = (uint32_t)(std::min)(std::ceil(width / cellSize),
+            (double)MaxCells);
+        rows = (uint32_t)(std::min)(std::ceil(height / cellSize),
+            (double)MaxCells);
+        cols = (std::max)(cols, 1U);
+        rows = (std::max)(rows, 1U);
+        while ((uint64_t)cols * rows > MaxCells)
+        {
+            cols = (std::max)(cols / 2, 1U);
+            rows = (std::max)(rows / 2, 1U);
+        }
+    }
+    setGrid(cols, rows);
+}
+
+
+void LasIndex::setGrid(uint32_t cols, uint32_t rows)
+{
+    m_cols = cols;
+    m_rows = rows;
+    m_cellWidth = (m_bounds.maxx - m_bounds.minx) / cols;
+    m_cellHeight = (m_bounds.maxy - m_bounds.miny) / rows;
+    m_cells.clear();
+    m_cells.resize((size_t)cols * rows);
+}
+
+
+// Points outside the bounds (the header bounds may be inexact) are placed
+// in the nearest cell.
+size_t LasIndex::cell(double x, double y) const
+{
+    auto clamp = [](double v, double min, double size, uint32_t count)
+    {
+        if (size <= 0)
+            return 0U;
+        double d = std::floor((v - min) / size);
+        if (d < 0)
+            return 0U;
+        if (d >= count)
+            return count - 1;
+        return (uint32_t)d;
+    };
+
+    uint32_t col = clamp(x, m_bounds.minx, m_cellWidth, m_cols);
+    uint32_t row = clamp(y, m_bounds.miny, m_cellHeight, m_rows);
+    return (size_t)row * m_cols + col;
+}
+
+
+void LasIndex::setSource(uint64_t fileSize, const BOX3D& bounds)
+{
+    m_fileSize = fileSize;
+    m_sourceBounds = bounds;
+}
+
+
+bool LasIndex::matches(uint64_t fileSize, point_count_t numPoints,
+    const BOX3D& bounds) const
+{
+    const BOX3D& b = m_sourceBounds;
+    return fileSize == m_fileSize && numPoints == m_numPoints &&
+        bounds.minx == b.minx && bounds.miny == b.miny &&
+        bounds.minz == b.minz && bounds.maxx == b.maxx &&
+        bounds.maxy == b.maxy && bounds.maxz == b.maxz;
+}
+
+
+void LasIndex::add(PointId idx, double x, double y)
+{
+    std::vector<Range>& ranges = m_cells[cell(x, y)];
+    if (ranges.size() && idx <= ranges.back().second + MaxGap)
+        ranges.back().second = idx + 1;
+    else
+        ranges.emplace_back(idx, idx + 1);
+}
+
+
+std::vector<LasIndex::Range> LasIndex::query(const BOX2D& bounds) const
+{
+    std::vector<Range> ranges;
+    if (m_cells.empty() || bounds.empty())
+        return ranges;
+
+    size_t lo = cell(bounds.minx, bounds.miny);
+    size_t hi = cell(bounds.maxx, bounds.maxy);
+    uint32_t minCol = lo % m_cols;
+    uint32_t minRow = (uint32_t)(lo / m_cols);
+    uint32_t maxCol = hi % m_cols;
+    uint32_t maxRow = (uint32_t)(hi / m_cols);
+    for (uint32_t row = minRow; row <= maxRow; ++row)
+        for (uint32_t col = minCol; col <= maxCol; ++col)
+        {
+            const std::vector<Range>& c = m_cells[(size_t)row * m_cols + col];
+            ranges.insert(ranges.end(), c.begin(), c.end());
+        }
+
+    // Sort and merge overlapping or adjacent ranges.
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<Range> merged;
+    for (const Range& r : ranges)
+    {
+        if (merged.size() && r.first <= merged.back().second)
+            merged.back().second = (std::max)(merged.back().second, r.second);
+        else
+            merged.push_back(r);
+    }
+    return merged;
+}
+
+
+void LasIndex::write(OLeStream& out) const
+{
+    out.put(Magic);
+    const BOX3D& b = m_sourceBounds;
+    out << Version << (uint64_t)m_numPoints << m_fileSize << b.minx <<
+        b.miny << b.minz << b.maxx << b.maxy << b.maxz;
+    out << m_bounds.minx << m_bounds.miny << m_bounds.maxx << m_bounds.maxy <<
+        m_cols << m_rows;
+    for (const std::vector<Range>& ranges : m_cells)
+    {
+        out << (uint32_t)ranges.size();
+        for (const Range& r : ranges)
+            out << (uint64_t)r.first << (uint64_t)r.second;
+    }
+}
+
+
+void LasIndex::read(ILeStream& in)
+{
+    std::string magic;
+    in.get(magic, Magic.size());
+    if (!in || magic != Magic)
+        throw error("Invalid index file signature.");
+
+    uint32_t version;
+    uint64_t numPoints;
+    uint32_t cols;
+    uint32_t rows;
+    in >> version;
+    if (version != Version)
+        throw error("Unsupported index version " +
+            Utils::toString(version) + ".");
+    BOX3D& b = m_sourceBounds;
+    in >> numPoints >> m_fileSize >> b.minx >> b.miny >> b.minz >> b.maxx >>
+        b.maxy >> b.maxz;
+    in >> m_bounds.minx >> m_bounds.miny >> m_bounds.maxx >>
+        m_bounds.maxy >> cols >> rows;
+    if (!in || cols == 0 || rows == 0 || (uint64_t)cols * rows > MaxCells)
+        throw error("Invalid index grid.");
+    m_numPoints = numPoints;
+    setGrid(cols, rows);
+
+    for (std::vector<Range>& ranges : m_cells)
+    {
+        uint32_t count;
+        in >> count;
+        if (!in || count > numPoints)
+            throw error("Invalid index cell.");
+        ranges.resize(count);
+        for (Range& r : ranges)
+        {
+            uint64_t begin;
+            uint64_t end;
+            in >> begin >> end;
+            if (begin >= end || end > numPoints)
+                throw error("Invalid index range.");
+            r = Range(begin, end);
+        }
+    }
+    if (!in)
+        throw error("Index file is truncated.");
+}
+
+
+std::string LasIndex::filename(const std::string& lasFilename)
+{
+    return lasFilename + ".pdx";
+}
+
+} // namespace pdal
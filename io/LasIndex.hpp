@@ -0,0 +1,164 @@
+/******************************************************************************
+ * Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following
+ * conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+ *       names of its contributors may be used to endorse or promote
+ *       products derived from this software without specific prior
+ *       written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+class ILeStream;
+class OLeStream;
+
+/**
+  Spatial index of the points in a LAS/LAZ file, stored in a sidecar file
+  next to it.  The XY extent of the file is divided into a grid of cells.
+  Each cell holds the ranges of point indices, in file order, of the
+  points that fall in the cell.  Nearby ranges are merged, so a range may
+  include some points outside its cell.  The sidecar is laid out as:
+
+    magic
+    version (uint32)
+    point count (uint64)
+    size of the indexed file in bytes (uint64)
+    header bounds of the indexed file (minx, miny, minz, maxx, maxy, maxz
+      as doubles)
+    bounds (minx, miny, maxx, maxy as doubles)
+    columns, rows (uint32)
+    for each cell: range count (uint32), then begin, end (uint64) of each
+
+  Values are little-endian.  The size and header bounds of the indexed file
+  are used to detect an index that no longer matches its file.
+*/
+class PDAL_DLL LasIndex
+{
+public:
+    typedef std::pair<PointId, PointId> Range;
+
+    struct error : public std::runtime_error
+    {
+        error(const std::string& err) : std::runtime_error(err)
+        {}
+    };
+
+    LasIndex();
+
+    /**
+      Start an index of points.
+
+      \param bounds  XY bounds of the points.
+      \param numPoints  Number of points to be indexed.
+      \param cellSize  Edge length of a grid cell.  If 0, a size is chosen
+        to hold about PointsPerCell points in each cell.
+    */
+    LasIndex(const BOX2D& bounds, point_count_t numPoints,
+        double cellSize = 0);
+
+    /**
+      Add a point to the index.  Points must be added in file order.
+
+      \param idx  Index of the point in the file.
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+    */
+    void add(PointId idx, double x, double y);
+
+    /**
+      Find the ranges of points that may fall within bounds.
+
+      \param bounds  Query bounds.
+      \return  Sorted, non-overlapping ranges [begin, end) of point indices.
+    */
+    std::vector<Range> query(const BOX2D& bounds) const;
+
+    /**
+      Record the LAS/LAZ file from which the index is built.
+
+      \param fileSize  Size of the file in bytes.
+      \param bounds  Bounds from the header of the file.
+    */
+    void setSource(uint64_t fileSize, const BOX3D& bounds);
+
+    /**
+      Determine whether a LAS/LAZ file appears to be the one from which the
+      index was built.
+
+      \param fileSize  Size of the file in bytes.
+      \param numPoints  Number of points in the file.
+      \param bounds  Bounds from the header of the file.
+      \return  Whether the file matches the index.
+    */
+    bool matches(uint64_t fileSize, point_count_t numPoints,
+        const BOX3D& bounds) const;
+
+    point_count_t numPoints() const
+        { return m_numPoints; }
+    size_t numCells() const
+        { return m_cells.size(); }
+
+    void write(OLeStream& out) const;
+    void read(ILeStream& in);
+
+    /// Name of the index sidecar of a LAS/LAZ file.
+    static std::string filename(const std::string& lasFilename);
+
+    /// Target number of points in a cell when a cell size isn't given.
+    static const point_count_t PointsPerCell = 50000;
+
+    /// Ranges separated by no more than this many points are merged.
+    static const PointId MaxGap = 256;
+
+private:
+    point_count_t m_numPoints;
+    uint64_t m_fileSize;
+    BOX3D m_sourceBounds;
+    BOX2D m_bounds;
+    uint32_t m_cols;
+    uint32_t m_rows;
+    double m_cellWidth;
+    double m_cellHeight;
+    std::vector<std::vector<Range>> m_cells;
+
+    void setGrid(uint32_t cols, uint32_t rows);
+    size_t cell(double x, double y) const;
+};
+
+} // namespace pdal
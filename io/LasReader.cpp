@@ -44,11 +44,13 @@
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
 #include <pdal/util/Extractor.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <pdal/util/IStream.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "GeotiffSupport.hpp"
 #include "LasHeader.hpp"
+#include "LasIndex.hpp"
 #include "LasVLR.hpp"
 
 namespace pdal
@@ -65,7 +67,8 @@ struct invalid_stream : public std::runtime_error
 
 } // unnamed namespace
 
-LasReader::LasReader() : m_decompressor(nullptr), m_index(0)
+LasReader::LasReader() : m_decompressor(nullptr), m_index(0), m_hinted(false),
+    m_indexed(false), m_rangeIdx(0)
 {}
 
 
@@ -86,6 +89,13 @@ void LasReader::addArgs(ProgramArgs& args)
     args.add("use_eb_vlr", "Use extra bytes VLR for 1.0 - 1.3 files",
         m_useEbVlr);
     args.add("ignore_vlr", "VLR userid/recordid to ignore", m_ignoreVLROption);
+    args.add("bounds", "Bounds of points to read", m_bounds);
+    args.add("use_index", "Use the chunk hierarchy of a cloud-optimized file "
+        "or a spatial index sidecar file, if present, to read only points "
+        "that may be within bounds", m_useIndex, true);
+    args.add("resolution", "Read only the levels of detail of a "
+        "cloud-optimized file needed for about this point spacing",
+        m_resolution);
 }
 
 
@@ -277,6 +287,173 @@ void LasReader::ready(PointTableRef table)
     }
     else
         stream->seekg(m_header.pointOffset());
+
+    // Points are limited by the 'bounds' option and by the limits of
+    // downstream filters.
+    m_limits = hint();
+    if (!m_bounds.to2d().empty())
+    {
+        if (m_bounds.is3d())
+            m_limits.limit(m_bounds.to3d());
+        else
+            m_limits.limit(m_bounds.to2d());
+    }
+    m_hinted = m_limits.bounded();
+    m_indexed = false;
+
+    // Skip the file if none of its points can pass.
+    BOX3D bounds = m_header.getBounds();
+    if (m_hinted && !bounds.empty() && !m_limits.overlaps(bounds))
+    {
+        log()->get(LogLevel::Debug) << "Skipping '" << m_filename <<
+            "'.  No points within limits.\n";
+        m_index = getNumPoints();
+    }
+    else if (m_useIndex && (m_hinted || m_resolution > 0))
+    {
+        if (!loadHierarchy() && m_hinted)
+            loadIndex();
+    }
+}
+
+
+// Find the ranges of points in the chunks of a cloud-optimized file that
+// may be within the limits and resolution.  Compressed files can only be
+// read by chunk with LAZperf if the location of the chunks is in the
+// hierarchy.
+bool LasReader::loadHierarchy()
+{
+    m_ranges.clear();
+    m_rangeIdx = 0;
+
+    const LasVLR *vlr = m_header.findVlr(PDAL_USER_ID,
+        PDAL_HIERARCHY_RECORD_ID);
+    if (!vlr)
+        return false;
+
+    try
+    {
+        m_hierarchy.read(vlr->data(), vlr->dataLen());
+    }
+    catch (const LasHierarchy::error& err)
+    {
+        log()->get(LogLevel::Warning) << "Ignoring invalid chunk hierarchy "
+            "in '" << m_filename << "': " << err.what() << "\n";
+        return false;
+    }
+    if (m_hierarchy.numPoints() != getNumPoints())
+    {
+        log()->get(LogLevel::Warning) << "Ignoring chunk hierarchy in '" <<
+            m_filename << "'.  Point count doesn't match.\n";
+        return false;
+    }
+    if (m_header.compressed() && m_compression == "LAZPERF" &&
+        !m_hierarchy.located())
+    {
+        log()->get(LogLevel::Debug) << "Ignoring chunk hierarchy in '" <<
+            m_filename << "'.  Chunk locations are needed to read "
+            "chunks with LAZperf.\n";
+        return false;
+    }
+
+    int level = m_hierarchy.level(m_resolution);
+    m_ranges = m_hierarchy.query(m_limits, level);
+    m_indexed = true;
+
+    point_count_t count = 0;
+    for (const LasHierarchy::Range& r : m_ranges)
+        count += r.second - r.first;
+    log()->get(LogLevel::Debug) << "Chunk hierarchy of '" << m_filename <<
+        "' selected " << count << " of " << getNumPoints() << " points in " <<
+        m_ranges.size() << " ranges.\n";
+    return true;
+}
+
+
+// Find the ranges of points that may be within the limits from the index
+// sidecar, if there is one.  Compressed files can only be read by ranges
+// if LASzip is used to decompress them.
+void LasReader::loadIndex()
+{
+    m_ranges.clear();
+    m_rangeIdx = 0;
+
+    std::string filename = LasIndex::filename(m_filename);
+    if (!FileUtils::fileExists(filename))
+        return;
+    if (m_header.compressed() && m_compression != "LASZIP")
+    {
+        log()->get(LogLevel::Debug) << "Ignoring index '" << filename <<
+            "'.  Only LASzip can read compressed points by index.\n";
+        return;
+    }
+
+    LasIndex index;
+    try
+    {
+        ILeStream in(filename);
+        index.read(in);
+    }
+    catch (const LasIndex::error& err)
+    {
+        log()->get(LogLevel::Warning) << "Ignoring invalid index '" <<
+            filename << "': " << err.what() << "\n";
+        return;
+    }
+    if (!index.matches(FileUtils::fileSize(m_filename), getNumPoints(),
+        m_header.getBounds()))
+    {
+        log()->get(LogLevel::Warning) << "Ignoring index '" << filename <<
+            "'.  It doesn't match '" << m_filename << "', which may have "
+            "changed since it was indexed.\n";
+        return;
+    }
+
+    m_ranges = index.query(m_limits.bounds().to2d());
+    m_indexed = true;
+
+    point_count_t count = 0;
+    for (const LasIndex::Range& r : m_ranges)
+        count += r.second - r.first;
+    log()->get(LogLevel::Debug) << "Index '" << filename << "' selected " <<
+        count << " of " << getNumPoints() << " points in " <<
+        m_ranges.size() << " ranges.\n";
+}
+
+
+// Move to the start of the next range of points from the index if the
+// current point isn't in a range.
+void LasReader::nextRange()
+{
+    while (m_rangeIdx < m_ranges.size() &&
+            m_index >= m_ranges[m_rangeIdx].second)
+        m_rangeIdx++;
+    if (m_rangeIdx == m_ranges.size())
+    {
+        m_index = getNumPoints();
+        return;
+    }
+
+    PointId begin = m_ranges[m_rangeIdx].first;
+    if (m_index >= begin)
+        return;
+    m_index = begin;
+    if (m_header.compressed())
+    {
+#ifdef PDAL_HAVE_LASZIP
+        if (m_compression == "LASZIP")
+            handleLaszip(laszip_seek_point(m_laszip, (laszip_I64)m_index));
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+        // Ranges from the hierarchy start at the beginning of a chunk.
+        if (m_compression == "LAZPERF")
+            m_decompressor->seekChunk(m_header.pointOffset() +
+                (std::streamoff)m_hierarchy.chunk(m_index).m_offset);
+#endif
+    }
+    else
+        m_streamIf->m_istream->seekg(m_header.pointOffset() +
+            (std::streamoff)(m_index * m_header.pointLen()));
 }
 
 
@@ -534,33 +711,41 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 {
     using namespace Dimension;
 
-    layout->registerDim(Id::X, Type::Double);
-    layout->registerDim(Id::Y, Type::Double);
-    layout->registerDim(Id::Z, Type::Double);
-    layout->registerDim(Id::Intensity, Type::Unsigned16);
-    layout->registerDim(Id::ReturnNumber, Type::Unsigned8);
-    layout->registerDim(Id::NumberOfReturns, Type::Unsigned8);
-    layout->registerDim(Id::ScanDirectionFlag, Type::Unsigned8);
-    layout->registerDim(Id::EdgeOfFlightLine, Type::Unsigned8);
-    layout->registerDim(Id::Classification, Type::Unsigned8);
-    layout->registerDim(Id::ScanAngleRank, Type::Float);
-    layout->registerDim(Id::UserData, Type::Unsigned8);
-    layout->registerDim(Id::PointSourceId, Type::Unsigned16);
+    // Dimensions not used downstream aren't registered.  Setting an
+    // unregistered dimension is a no-op, so they're skipped when loading.
+    auto registerDim = [this, &layout](Id id, Type type)
+    {
+        if (projected(Dimension::name(id)))
+            layout->registerDim(id, type);
+    };
+
+    registerDim(Id::X, Type::Double);
+    registerDim(Id::Y, Type::Double);
+    registerDim(Id::Z, Type::Double);
+    registerDim(Id::Intensity, Type::Unsigned16);
+    registerDim(Id::ReturnNumber, Type::Unsigned8);
+    registerDim(Id::NumberOfReturns, Type::Unsigned8);
+    registerDim(Id::ScanDirectionFlag, Type::Unsigned8);
+    registerDim(Id::EdgeOfFlightLine, Type::Unsigned8);
+    registerDim(Id::Classification, Type::Unsigned8);
+    registerDim(Id::ScanAngleRank, Type::Float);
+    registerDim(Id::UserData, Type::Unsigned8);
+    registerDim(Id::PointSourceId, Type::Unsigned16);
 
     if (m_header.hasTime())
-        layout->registerDim(Id::GpsTime, Type::Double);
+        registerDim(Id::GpsTime, Type::Double);
     if (m_header.hasColor())
     {
-        layout->registerDim(Id::Red, Type::Unsigned16);
-        layout->registerDim(Id::Green, Type::Unsigned16);
-        layout->registerDim(Id::Blue, Type::Unsigned16);
+        registerDim(Id::Red, Type::Unsigned16);
+        registerDim(Id::Green, Type::Unsigned16);
+        registerDim(Id::Blue, Type::Unsigned16);
     }
     if (m_header.hasInfrared())
-        layout->registerDim(Id::Infrared);
+        registerDim(Id::Infrared, defaultType(Id::Infrared));
     if (m_header.versionAtLeast(1, 4))
     {
-        layout->registerDim(Id::ScanChannel);
-        layout->registerDim(Id::ClassFlags);
+        registerDim(Id::ScanChannel, defaultType(Id::ScanChannel));
+        registerDim(Id::ClassFlags, defaultType(Id::ClassFlags));
     }
 
     for (auto& dim : m_extraDims)
@@ -568,6 +753,8 @@ void LasReader::addDimensions(PointLayoutPtr layout)
         Dimension::Type type = dim.m_dimType.m_type;
         if (type == Dimension::Type::None)
             continue;
+        if (!projected(dim.m_name))
+            continue;
         if (dim.m_dimType.m_xform.nonstandard())
             type = Dimension::Type::Double;
         dim.m_dimType.m_id = layout->registerOrAssignDim(dim.m_name, type);
@@ -577,9 +764,24 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 
 bool LasReader::processOne(PointRef& point)
 {
-    if (m_index >= getNumPoints())
-        return false;
+    while (true)
+    {
+        if (m_indexed)
+            nextRange();
+        if (m_index >= getNumPoints())
+            break;
+        bool loaded = loadNext(point);
+        m_index++;
+        if (loaded)
+            return true;
+    }
+    return false;
+}
+
 
+// Read the next point from the file and load it if it passes the hint.
+bool LasReader::loadNext(PointRef& point)
+{
     size_t pointLen = m_header.pointLen();
 
     if (m_header.compressed())
@@ -588,6 +790,8 @@ bool LasReader::processOne(PointRef& point)
         if (m_compression == "LASZIP")
         {
             handleLaszip(laszip_read_point(m_laszip));
+            if (m_hinted && !passesHint(*m_laszipPoint))
+                return false;
             loadPoint(point, *m_laszipPoint);
         }
 #endif
@@ -596,6 +800,8 @@ bool LasReader::processOne(PointRef& point)
         if (m_compression == "LAZPERF")
         {
             m_decompressor->decompress(m_decompressorBuf.data());
+            if (m_hinted && !passesHint(m_decompressorBuf.data()))
+                return false;
             loadPoint(point, m_decompressorBuf.data(), pointLen);
         }
 #endif
@@ -609,19 +815,76 @@ bool LasReader::processOne(PointRef& point)
         std::vector<char> buf(m_header.pointLen());
 
         m_streamIf->m_istream->read(buf.data(), pointLen);
+        if (m_hinted && !passesHint(buf.data()))
+            return false;
         loadPoint(point, buf.data(), pointLen);
     }
-    m_index++;
     return true;
 }
 
 
+// Test a point against the hint using only its position and time.
+bool LasReader::passesHint(const char *buf) const
+{
+    const LasHeader& h = m_header;
+
+    LeExtractor istream(buf, h.pointLen());
+    int32_t xi, yi, zi;
+    istream >> xi >> yi >> zi;
+    if (!m_limits.contains(xi * h.scaleX() + h.offsetX(),
+            yi * h.scaleY() + h.offsetY(), zi * h.scaleZ() + h.offsetZ()))
+        return false;
+    if (h.hasTime() && m_limits.timeBounded())
+    {
+        double time;
+        istream.seek(h.has14Format() ? 22 : 20);
+        istream >> time;
+        return m_limits.containsTime(time);
+    }
+    return true;
+}
+
+
+#ifdef PDAL_HAVE_LASZIP
+bool LasReader::passesHint(const laszip_point& p) const
+{
+    const LasHeader& h = m_header;
+
+    if (!m_limits.contains(p.X * h.scaleX() + h.offsetX(),
+            p.Y * h.scaleY() + h.offsetY(), p.Z * h.scaleZ() + h.offsetZ()))
+        return false;
+    if (h.hasTime() && m_limits.timeBounded())
+        return m_limits.containsTime(p.gps_time);
+    return true;
+}
+#endif // PDAL_HAVE_LASZIP
+
+
 point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 {
     size_t pointLen = m_header.pointLen();
     count = std::min(count, getNumPoints() - m_index);
 
+    // Only ranges of points selected by the index are read.
+    if (m_indexed)
+    {
+        point_count_t numRead = 0;
+        while (numRead < count)
+        {
+            PointId id = view->size();
+            PointRef point = view->point(id);
+            if (!processOne(point))
+                break;
+            if (m_cb)
+                m_cb(*view, id);
+            numRead++;
+        }
+        return numRead;
+    }
+
+    // Points scanned, not all of which may pass the hint.
     PointId i = 0;
+    PointId startId = view->size();
     if (m_header.compressed())
     {
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
@@ -629,10 +892,9 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
         {
             for (i = 0; i < count; i++)
             {
-                PointRef point = view->point(i);
                 PointId id = view->size();
-                processOne(point);
-                if (m_cb)
+                PointRef point = view->point(id);
+                if (loadNext(point) && m_cb)
                     m_cb(*view, id);
             }
         }
@@ -658,11 +920,14 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
                 char *pos = buf.data();
                 while (blockPoints--)
                 {
-                    PointId id = view->size();
-                    PointRef point = view->point(id);
-                    loadPoint(point, pos, pointLen);
-                    if (m_cb)
-                        m_cb(*view, id);
+                    if (!m_hinted || passesHint(pos))
+                    {
+                        PointId id = view->size();
+                        PointRef point = view->point(id);
+                        loadPoint(point, pos, pointLen);
+                        if (m_cb)
+                            m_cb(*view, id);
+                    }
                     pos += pointLen;
                     i++;
                 }
@@ -674,7 +939,7 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
         {}
     }
     m_index += i;
-    return (point_count_t)i;
+    return view->size() - startId;
 }
 
 
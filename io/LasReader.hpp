@@ -50,6 +50,7 @@ struct laszip_point;
 
 #include "LasError.hpp"
 #include "LasHeader.hpp"
+#include "LasHierarchy.hpp"
 #include "LasUtils.hpp"
 
 namespace pdal
@@ -72,7 +73,7 @@ protected:
 
     public:
         LasStreamIf(const std::string& filename)
-            { m_istream = Utils::openFile(filename); }
+            { m_istream = Utils::openRangeFile(filename); }
 
         ~LasStreamIf()
         {
@@ -128,6 +129,15 @@ private:
     std::string m_compression;
     StringList m_ignoreVLROption;
     bool m_useEbVlr;
+    Bounds m_bounds;
+    bool m_useIndex;
+    double m_resolution;
+    ReadHint m_limits;
+    bool m_hinted;
+    bool m_indexed;
+    std::vector<std::pair<PointId, PointId>> m_ranges;
+    size_t m_rangeIdx;
+    LasHierarchy m_hierarchy;
 
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table)
@@ -147,6 +157,12 @@ private:
     void readExtraBytesVlr();
     void extractHeaderMetadata(MetadataNode& forward, MetadataNode& m);
     void extractVlrMetadata(MetadataNode& forward, MetadataNode& m);
+    bool loadHierarchy();
+    void loadIndex();
+    void nextRange();
+    bool loadNext(PointRef& point);
+    bool passesHint(const char *buf) const;
+    bool passesHint(const laszip_point& p) const;
     void loadPoint(PointRef& point, laszip_point& p);
     void loadPointV10(PointRef& point, laszip_point& p);
     void loadPointV14(PointRef& point, laszip_point& p);
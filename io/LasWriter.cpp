@@ -58,6 +58,7 @@
 #include <pdal/util/ProgramArgs.hpp>
 
 #include "GeotiffSupport.hpp"
+#include "LasHierarchy.hpp"
 
 namespace pdal
 {
@@ -77,7 +78,8 @@ CREATE_STATIC_STAGE(LasWriter, s_info)
 std::string LasWriter::getName() const { return s_info.name; }
 
 LasWriter::LasWriter() : m_compressor(nullptr), m_ostream(NULL),
-    m_compression(LasCompression::None), m_srsCnt(0)
+    m_compression(LasCompression::None), m_srsCnt(0), m_hierarchyPos(0),
+    m_pendingStream(nullptr)
 {}
 
 
@@ -89,6 +91,69 @@ LasWriter::~LasWriter()
 }
 
 
+// The dimensions written are those of the point format and any extra
+// dimensions.  When the format is forwarded from the input or all
+// dimensions are written as extra bytes, they can't be known in advance.
+bool LasWriter::usedDimensions(StringList& dims) const
+{
+    auto split = [this](const std::string& name)
+    {
+        StringList out;
+        for (const std::string& val : m_options.getValues(name))
+            for (std::string s : Utils::split2(val, ','))
+            {
+                Utils::trim(s);
+                if (s.size())
+                    out.push_back(s);
+            }
+        return out;
+    };
+
+    for (const std::string& f : split("forward"))
+        if (f == "all" || f == "header" || f == "format" ||
+                f == "dataformat_id")
+            return false;
+
+    std::vector<ExtraDim> extraDims;
+    try
+    {
+        extraDims = LasUtils::parse(split("extra_dims"), true);
+    }
+    catch (const LasUtils::error&)
+    {
+        // Reported when the options are processed.
+        return false;
+    }
+    for (const ExtraDim& dim : extraDims)
+    {
+        if (dim.m_name == "all")
+            return false;
+        dims.push_back(dim.m_name);
+    }
+
+    StringList format = m_options.getValues("dataformat_id");
+    if (format.empty())
+        format = m_options.getValues("format");
+    int id = 3;
+    if (format.size() && !Utils::fromString(format.front(), id))
+        return false;
+
+    LasHeader header;
+    header.setPointFormat((uint8_t)id);
+    dims.insert(dims.end(), { "X", "Y", "Z", "Intensity", "ReturnNumber",
+        "NumberOfReturns", "ScanDirectionFlag", "EdgeOfFlightLine",
+        "Classification", "ClassFlags", "ScanAngleRank", "UserData",
+        "PointSourceId", "ScanChannel" });
+    if (header.hasTime())
+        dims.push_back("GpsTime");
+    if (header.hasColor())
+        dims.insert(dims.end(), { "Red", "Green", "Blue" });
+    if (header.hasInfrared())
+        dims.push_back("Infrared");
+    return true;
+}
+
+
 void LasWriter::addArgs(ProgramArgs& args)
 {
     std::time_t now;
@@ -135,6 +200,11 @@ void LasWriter::addArgs(ProgramArgs& args)
     args.add("offset_y", "Y offset", m_offsetY);
     args.add("offset_z", "Z offset", m_offsetZ);
     args.add("vlrs", "List of VLRs to set", m_userVLRs);
+    args.add("cloud_optimized", "Order points by level of detail and "
+        "location and write a chunk hierarchy so that parts of the file "
+        "can be read by bounds and resolution", m_cloudOptimized);
+    args.add("chunk_size", "Number of points in each chunk of "
+        "cloud-optimized output", m_chunkSize, 50000U);
 }
 
 void LasWriter::initialize()
@@ -161,6 +231,14 @@ void LasWriter::initialize()
     {
         throwError(err.what());
     }
+    if (m_cloudOptimized)
+    {
+        if (m_chunkSize == 0)
+            throwError("Option 'chunk_size' must be greater than 0.");
+        if (m_discardHighReturnNumbers)
+            throwError("Can't discard high return numbers when writing "
+                "cloud-optimized output.");
+    }
     fillForwardList();
 }
 
@@ -177,6 +255,9 @@ void LasWriter::spatialReferenceChanged(const SpatialReference&)
 void LasWriter::prepared(PointTableRef table)
 {
     FlexWriter::validateFilename(table);
+    if (m_cloudOptimized && !table.supportsView())
+        throwError("Can't write cloud-optimized output using a streaming "
+            "point table.");
 
     PointLayoutPtr layout = table.layout();
 
@@ -316,7 +397,52 @@ void LasWriter::readyFile(const std::string& filename,
         throwError("Couldn't open file '" + filename + "' for output.");
     m_curFilename = filename;
     Utils::writeProgress(m_progressFd, "READYFILE", filename);
-    prepOutput(out, srs);
+
+    // The hierarchy of cloud-optimized output is built from the points
+    // before the header is written.
+    if (m_cloudOptimized)
+    {
+        m_hierarchy.reset();
+        m_pendingStream = out;
+        m_pendingSrs = srs;
+    }
+    else
+        prepOutput(out, srs);
+}
+
+
+// Add the hierarchy VLR and write the header of cloud-optimized output.
+// The hierarchy is rewritten with the location of the chunks when
+// the points have been written.
+void LasWriter::prepCloudOutput()
+{
+    deleteVlr(PDAL_USER_ID, PDAL_HIERARCHY_RECORD_ID);
+
+    std::ostream *out = m_pendingStream;
+    m_pendingStream = nullptr;
+    prepOutput(out, m_pendingSrs);
+}
+
+
+// Add the hierarchy VLR once the version of the output is known.  Before
+// LAS 1.4, the hierarchy must fit in a VLR, which limits the number of
+// chunks to about 1000.
+void LasWriter::addHierarchyVlr(std::ostream *out)
+{
+    std::vector<uint8_t> data = m_hierarchy->data();
+    if (data.size() > LasVLR::MAX_DATA_SIZE &&
+        !m_lasHeader.versionAtLeast(1, 4))
+    {
+        // Nothing has been written, so don't leave an empty file behind.
+        delete out;
+        FileUtils::deleteFile(m_curFilename);
+        throwError("The chunk hierarchy of '" + m_curFilename + "' has " +
+            std::to_string(m_hierarchy->numChunks()) + " chunks, which is "
+            "too many for a VLR.  Set 'minor_version' to 4 so that it's "
+            "written as an extended VLR, or increase 'chunk_size'.");
+    }
+    addVlr(PDAL_USER_ID, PDAL_HIERARCHY_RECORD_ID, "PDAL chunk hierarchy",
+        data);
 }
 
 
@@ -334,6 +460,10 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     // Spatial reference can potentially change for multiple output files.
     addSpatialRefVlrs();
 
+    // Cloud-optimized output carries its chunk hierarchy.
+    if (m_hierarchy)
+        addHierarchyVlr(outStream);
+
     m_summaryData.reset(new LasSummaryData());
     m_ostream = outStream;
     if (m_lasHeader.compressed())
@@ -349,10 +479,13 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
 
     m_lasHeader.setVlrOffset((uint32_t)m_ostream->tellp());
 
+    m_hierarchyPos = 0;
     for (auto vi = m_vlrs.begin(); vi != m_vlrs.end(); ++vi)
     {
         LasVLR& vlr = *vi;
         vlr.write(out, m_lasHeader.versionEquals(1, 0) ? 0xAABB : 0);
+        if (vlr.matches(PDAL_USER_ID, PDAL_HIERARCHY_RECORD_ID))
+            m_hierarchyPos = (uint64_t)m_ostream->tellp() - vlr.dataLen();
     }
 
     // Write the point data start signature for version 1.0.
@@ -693,6 +826,8 @@ void LasWriter::readyLasZipCompression()
     handleLaszip(laszip_create(&m_laszip));
     handleLaszip(laszip_set_point_type_and_size(m_laszip,
         m_lasHeader.pointFormat(), m_lasHeader.pointLen()));
+    if (m_cloudOptimized)
+        handleLaszip(laszip_set_chunk_size(m_laszip, m_chunkSize));
 
     laszip_U8* data;
     laszip_U32 size;
@@ -719,6 +854,8 @@ void LasWriter::readyLazPerfCompression()
     if (m_lasHeader.hasColor())
         schema.push(laszip::factory::record_item::RGB12);
     laszip::io::laz_vlr zipvlr = laszip::io::laz_vlr::from_schema(schema);
+    if (m_cloudOptimized)
+        zipvlr.chunk_size = m_chunkSize;
     std::vector<uint8_t> data(zipvlr.size());
     zipvlr.extract((char *)data.data());
     addVlr(LASZIP_USER_ID, LASZIP_RECORD_ID, "http://laszip.org", data);
@@ -773,6 +910,14 @@ void LasWriter::writeView(const PointViewPtr view)
         std::to_string(view->size()));
     m_scaling.setAutoXForm(view);
 
+    if (m_cloudOptimized)
+    {
+        writeCloudView(view);
+        Utils::writeProgress(m_progressFd, "DONEVIEW",
+            std::to_string(view->size()));
+        return;
+    }
+
     point_count_t pointLen = m_lasHeader.pointLen();
 
     // Since we use the LASzip API, we can't benefit from building
@@ -813,6 +958,27 @@ void LasWriter::writeView(const PointViewPtr view)
 }
 
 
+// Write points in the order of the hierarchy, which is built before
+// writing the header.
+void LasWriter::writeCloudView(const PointViewPtr view)
+{
+    if (!m_pendingStream)
+        throwError("Can't write more than one point view to "
+            "cloud-optimized output file '" + m_curFilename + "'.");
+
+    m_hierarchy.reset(new LasHierarchy());
+    std::vector<PointId> order = m_hierarchy->build(*view, m_chunkSize);
+    prepCloudOutput();
+
+    PointRef point(*view, 0);
+    for (PointId idx : order)
+    {
+        point.setPointId(idx);
+        processOne(point);
+    }
+}
+
+
 bool LasWriter::writeLasZipBuf(PointRef& point)
 {
 #ifdef PDAL_HAVE_LASZIP
@@ -1094,6 +1260,9 @@ point_count_t LasWriter::fillWriteBuf(const PointView& view,
 
 void LasWriter::doneFile()
 {
+    // Cloud-optimized output without points.
+    if (m_pendingStream)
+        prepCloudOutput();
     finishOutput();
     Utils::writeProgress(m_progressFd, "DONEFILE", m_curFilename);
     getMetadata().addList("filename", m_curFilename);
@@ -1109,6 +1278,9 @@ void LasWriter::finishOutput()
     else if (m_compression == LasCompression::LazPerf)
         finishLazPerfOutput();
 
+    if (m_hierarchy)
+        finishHierarchy();
+
     log()->get(LogLevel::Debug) << "Wrote " <<
         m_summaryData->getTotalNumPoints() <<
         " points to the LAS file" << std::endl;
@@ -1116,6 +1288,8 @@ void LasWriter::finishOutput()
     OLeStream out(m_ostream);
 
     // addVlr prevents any eVlrs from being added before version 1.4.
+    if (m_eVlrs.size())
+        m_lasHeader.setEVlrOffset((uint64_t)m_ostream->tellp());
     for (auto vi = m_eVlrs.begin(); vi != m_eVlrs.end(); ++vi)
     {
         ExtLasVLR evlr = *vi;
@@ -1150,6 +1324,55 @@ void LasWriter::finishOutput()
 }
 
 
+// Set the location of the chunks in the hierarchy and rewrite it.
+void LasWriter::finishHierarchy()
+{
+    LasHierarchy& h = *m_hierarchy;
+
+    if (m_compression == LasCompression::None)
+    {
+        uint64_t pointLen = m_lasHeader.pointLen();
+        for (size_t i = 0; i < h.numChunks(); ++i)
+        {
+            point_count_t first = (point_count_t)i * h.chunkSize();
+            point_count_t count = (std::min)((point_count_t)h.chunkSize(),
+                h.numPoints() - first);
+            h.setLocation(i, first * pointLen, count * pointLen);
+        }
+    }
+    else if (m_compression == LasCompression::LazPerf)
+    {
+#ifdef PDAL_HAVE_LAZPERF
+        // Chunks follow the offset of the chunk table.
+        uint64_t offset = sizeof(uint64_t);
+        const std::vector<uint32_t>& sizes = m_compressor->chunkSizes();
+        for (size_t i = 0; i < sizes.size() && i < h.numChunks(); ++i)
+        {
+            h.setLocation(i, offset, sizes[i]);
+            offset += sizes[i];
+        }
+#endif
+    }
+    // LASzip doesn't provide the location of chunks.  Readers find them
+    // in the LAZ chunk table.
+
+    std::vector<uint8_t> data = h.data();
+    if (m_hierarchyPos)
+    {
+        std::streampos end = m_ostream->tellp();
+        m_ostream->seekp(m_hierarchyPos);
+        m_ostream->write((const char *)data.data(), data.size());
+        m_ostream->seekp(end);
+    }
+    else
+    {
+        deleteVlr(PDAL_USER_ID, PDAL_HIERARCHY_RECORD_ID);
+        addVlr(PDAL_USER_ID, PDAL_HIERARCHY_RECORD_ID,
+            "PDAL chunk hierarchy", data);
+    }
+}
+
+
 void LasWriter::finishLasZipOutput()
 {
 #ifdef PDAL_HAVE_LASZIP
@@ -60,6 +60,7 @@ class LasTester;
 class NitfWriter;
 class GeotiffSupport;
 class LazPerfVlrCompressor;
+class LasHierarchy;
 
 struct VlrOptionInfo
 {
@@ -76,6 +77,7 @@ class PDAL_DLL LasWriter : public FlexWriter, public Streamable
     friend class NitfWriter;
 public:
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
     LasWriter();
     ~LasWriter();
@@ -107,6 +109,12 @@ private:
     std::vector<char> m_pointBuf;
     SpatialReference m_aSrs;
     int m_srsCnt;
+    bool m_cloudOptimized;
+    uint32_t m_chunkSize;
+    std::unique_ptr<LasHierarchy> m_hierarchy;
+    uint64_t m_hierarchyPos;
+    std::ostream *m_pendingStream;
+    SpatialReference m_pendingSrs;
 
     NumHeaderVal<uint8_t, 1, 1> m_majorVersion;
     NumHeaderVal<uint8_t, 1, 4> m_minorVersion;
@@ -139,6 +147,7 @@ private:
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
     virtual void writeView(const PointViewPtr view);
+    void writeCloudView(const PointViewPtr view);
     virtual bool processOne(PointRef& point);
     void spatialReferenceChanged(const SpatialReference& srs);
     virtual void doneFile();
@@ -174,6 +183,9 @@ private:
     bool addWktVlr();
     void finishLasZipOutput();
     void finishLazPerfOutput();
+    void prepCloudOutput();
+    void addHierarchyVlr(std::ostream *out);
+    void finishHierarchy();
 
     LasWriter& operator=(const LasWriter&); // not implemented
     LasWriter(const LasWriter&); // not implemented
@@ -315,7 +315,9 @@ void PlyReader::addDimensions(PointLayoutPtr layout)
             for (auto& prop : elt.m_properties)
             {
                 auto vprop = static_cast<SimpleProperty *>(prop.get());
-                layout->registerOrAssignDim(vprop->m_name, vprop->m_type);
+                // Unused properties are still read but not stored.
+                if (!projected(vprop->m_name))
+                    continue;
                 vprop->setDim(
                     layout->registerOrAssignDim(vprop->m_name, vprop->m_type));
             }
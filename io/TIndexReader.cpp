@@ -35,6 +35,10 @@
 #include "TIndexReader.hpp"
 #include <pdal/GDALUtils.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <cmath>
 
 namespace pdal
 {
@@ -124,6 +128,8 @@ void TIndexReader::addArgs(ProgramArgs& args)
         "with lyr_name", m_attributeFilter);
     args.add("dialect", "OGR SQL dialect to use when querying tile "
         "index layer", m_dialect, "OGRSQL");
+    args.add("threads", "Number of files to read concurrently (0 uses all "
+        "available hardware threads)", m_threads, (size_t)0);
 }
 
 
@@ -175,6 +181,7 @@ void TIndexReader::initialize()
     setSpatialReference(SpatialReference(m_out_ref->wkt()));
 
     std::unique_ptr<gdal::Geometry> wkt_g;
+    BOX2D hintBox;
 
     // If the user set either explicit 'polygon' or 'boundary' options
     // we will filter by that geometry. The user can set a 'filter_srs'
@@ -194,6 +201,22 @@ void TIndexReader::initialize()
         m_wkt = wkt_g->wkt();
         OGR_L_SetSpatialFilter(m_layer, geometry);
     }
+    // Points outside the hint are discarded downstream, so only tiles
+    // that overlap it are read and their points are cropped to it.  The
+    // box is padded to allow for rounding when it's converted to text.
+    else if (hint().boundedXY() && !hint().empty())
+    {
+        hintBox = hint().bounds().to2d();
+        double pad = 1e-9 * (std::max)({ std::fabs(hintBox.minx),
+            std::fabs(hintBox.maxx), std::fabs(hintBox.miny),
+            std::fabs(hintBox.maxy), 1.0 });
+        hintBox.grow(hintBox.minx - pad, hintBox.miny - pad);
+        hintBox.grow(hintBox.maxx + pad, hintBox.maxy + pad);
+        wkt_g.reset(new gdal::Geometry(hintBox.toWKT(), *m_out_ref));
+        OGR_L_SetSpatialFilter(m_layer, wkt_g->get());
+        log()->get(LogLevel::Debug) << "Limiting tiles to bounds of "
+            "downstream filters: " << hintBox << std::endl;
+    }
 
     if (m_attributeFilter.size())
     {
@@ -207,11 +230,14 @@ void TIndexReader::initialize()
     Options cropOptions;
     if (m_wkt.size())
         cropOptions.add("polygon", m_wkt);
+    else if (!hintBox.empty())
+        cropOptions.add("bounds", Bounds(hintBox));
 
+    m_tiles.clear();
     for (auto f : getFiles())
     {
         log()->get(LogLevel::Debug) << "Adding file " << f.m_filename <<
-            " to merge filter" << std::endl;
+            std::endl;
 
         std::string driver = m_factory.inferReaderDriver(f.m_filename);
         Stage *reader = m_factory.createStage(driver);
@@ -240,7 +266,7 @@ void TIndexReader::initialize()
 
         // WKT is set even if we're using a bounding box for filtering, so
         // can be used as a test here.
-        if (!m_wkt.empty())
+        if (!m_wkt.empty() || !hintBox.empty())
         {
             Stage *crop = m_factory.createStage("filters.crop");
             crop->setOptions(cropOptions);
@@ -250,7 +276,10 @@ void TIndexReader::initialize()
             premerge = crop;
         }
 
-        m_merge.setInput(*premerge);
+        Tile tile;
+        tile.m_filename = f.m_filename;
+        tile.m_stage = premerge;
+        m_tiles.push_back(std::move(tile));
     }
 
     if (m_sql.size())
@@ -267,21 +296,109 @@ void TIndexReader::initialize()
     m_dataset = 0;
 }
 
+// Prepare the pipeline of each file with its own table, then add the
+// dimensions of all the files to the layout.
 void TIndexReader::prepared(PointTableRef table)
 {
-    m_merge.prepare(table);
+    ThreadPool pool(m_threads);
+    for (Tile& tile : m_tiles)
+        pool.add([&tile]()
+        {
+            tile.m_table.reset(new PointTable());
+            tile.m_stage->prepare(*tile.m_table);
+        });
+    pool.await();
+
+    PointLayoutPtr layout = table.layout();
+    for (Tile& tile : m_tiles)
+    {
+        PointLayoutPtr tileLayout = tile.m_table->layout();
+        for (const DimType& dt : tileLayout->dimTypes())
+            layout->registerOrAssignDim(tileLayout->dimName(dt.m_id),
+                dt.m_type);
+    }
 }
 
+
 void TIndexReader::ready(PointTableRef table)
 {
-    m_pvSet = m_merge.execute(table);
+    ThreadPool pool(m_threads);
+    log()->get(LogLevel::Debug) << "Reading " << m_tiles.size() <<
+        " files using " << pool.numThreads() << " threads" << std::endl;
+    for (Tile& tile : m_tiles)
+    {
+        if (!tile.m_table)
+            throwError("Can't read file '" + tile.m_filename + "' more "
+                "than once without preparing again.");
+        pool.add([this, &table, &tile]()
+            { readTile(table, tile); });
+    }
+    pool.await();
 }
 
 
-PointViewSet TIndexReader::run(PointViewPtr)
+// Read a file into its table and copy the points to the reader's table.
+// Tables aren't thread-safe, so copying is serialized.
+void TIndexReader::readTile(PointTableRef table, Tile& tile)
 {
-    return m_pvSet;
+    PointViewSet views = tile.m_stage->execute(*tile.m_table);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    struct DimMap
+    {
+        Dimension::Id m_src;
+        Dimension::Id m_dst;
+        Dimension::Type m_type;
+    };
+
+    PointLayoutPtr layout = table.layout();
+    PointLayoutPtr tileLayout = tile.m_table->layout();
+    std::vector<DimMap> dims;
+    for (const DimType& dt : tileLayout->dimTypes())
+    {
+        Dimension::Id dst = layout->findDim(tileLayout->dimName(dt.m_id));
+        dims.push_back({ dt.m_id, dst, layout->dimType(dst) });
+    }
+
+    tile.m_view.reset(new PointView(table));
+    for (PointViewPtr v : views)
+    {
+        for (PointId idx = 0; idx < v->size(); ++idx)
+        {
+            PointId dstIdx = tile.m_view->size();
+            for (const DimMap& d : dims)
+            {
+                Everything e;
+                v->getField((char *)&e, d.m_src, d.m_type, idx);
+                tile.m_view->setField(d.m_dst, d.m_type, dstIdx, &e);
+            }
+        }
+    }
+    log()->get(LogLevel::Debug) << "Read " << tile.m_view->size() <<
+        " points from " << tile.m_filename << std::endl;
+
+    // Release the points of the file.
+    tile.m_table.reset();
+}
+
+
+// Points are returned in file order, regardless of the order in which the
+// files were read.
+PointViewSet TIndexReader::run(PointViewPtr view)
+{
+    for (Tile& tile : m_tiles)
+    {
+        for (PointId idx = 0; idx < tile.m_view->size(); ++idx)
+            view->appendPoint(*tile.m_view, idx);
+        tile.m_view.reset();
+    }
+
+    PointViewSet viewSet;
+    viewSet.insert(view);
+    return viewSet;
 }
 
+
 } // namespace pdal
 
@@ -34,11 +34,12 @@
 
 #pragma once
 
+#include <mutex>
+
 #include <pdal/PointView.hpp>
 #include <pdal/Reader.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/GDALUtils.hpp>
-#include <filters/MergeFilter.hpp>
 
 namespace pdal
 {
@@ -61,6 +62,20 @@ class PDAL_DLL TIndexReader : public Reader
         int m_mtime;
     };
 
+    // The pipeline that reads a file.  Each file is read into its own
+    // table, so that files can be read concurrently, and its points
+    // are then copied to a view of the reader's table.
+    struct Tile
+    {
+        Tile() : m_stage(nullptr)
+        {}
+
+        std::string m_filename;
+        Stage *m_stage;
+        std::unique_ptr<PointTable> m_table;
+        PointViewPtr m_view;
+    };
+
 public:
     TIndexReader() : m_dataset(NULL) , m_layer(NULL)
         {}
@@ -86,17 +101,19 @@ private:
     std::string m_dialect;
     BOX2D m_bounds;
     std::string m_sql;
+    size_t m_threads;
 
     std::unique_ptr<gdal::SpatialRef> m_out_ref;
     void *m_dataset;
     void *m_layer;
 
     StageFactory m_factory;
-    MergeFilter m_merge;
-    PointViewSet m_pvSet;
+    std::vector<Tile> m_tiles;
+    std::mutex m_mutex;
 
     std::vector<FileInfo> getFiles();
     FieldIndexes getFields();
+    void readTile(PointTableRef table, Tile& tile);
 };
 
 
@@ -32,8 +32,11 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <cstring>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "TextReader.hpp"
 #include "../filters/StatsFilter.hpp"
@@ -41,6 +44,106 @@
 namespace pdal
 {
 
+namespace
+{
+
+// Size of the read buffer for each thread.
+const size_t BufferSize = 1 << 22;
+
+// Parse a decimal number that occupies all of [start, end).  Only the common
+// case is handled: at most 19 significant digits whose value fits in a
+// double's mantissa and a decimal exponent small enough that the power of
+// ten is exact.  The result is then a single correctly rounded
+// multiplication or division.  Anything else returns false so that the
+// caller can fall back to a full conversion.
+bool parseDouble(const char *start, const char *end, double& d)
+{
+    static const double powers[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *p = start;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool digits = false;
+
+    auto addDigit = [&mantissa, &significant](char c)
+    {
+        if (mantissa == 0 && c == '0')
+            return true;
+        if (significant == 19)
+            return false;
+        mantissa = mantissa * 10 + (c - '0');
+        significant++;
+        return true;
+    };
+
+    for (; p < end && *p >= '0' && *p <= '9'; ++p)
+    {
+        if (!addDigit(*p))
+            return false;
+        digits = true;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            if (!addDigit(*p))
+                return false;
+            exponent--;
+            digits = true;
+        }
+    }
+    if (!digits)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negExp = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negExp = (*p++ == '-');
+        if (p == end)
+            return false;
+        int e = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            if (e > 1000)
+                return false;
+            e = e * 10 + (*p - '0');
+        }
+        exponent += negExp ? -e : e;
+    }
+    if (p != end)
+        return false;
+
+    if (mantissa == 0)
+    {
+        d = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (mantissa > ((uint64_t)1 << 53) || exponent < -22 || exponent > 22)
+        return false;
+
+    d = (double)mantissa;
+    if (exponent < 0)
+        d /= powers[-exponent];
+    else
+        d *= powers[exponent];
+    if (negative)
+        d = -d;
+    return true;
+}
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "readers.text",
@@ -163,6 +266,9 @@ void TextReader::addArgs(ProgramArgs& args)
     args.add("header", "Use this string as the header line.", m_header);
     args.add("skip", "Skip this number of lines before attempting to "
         "read the header.", m_skip);
+    args.add("threads", "Number of threads used to parse the file when not "
+        "streaming (0 uses all available hardware threads)", m_threads,
+        (size_t)1);
 }
 
 
@@ -189,78 +295,286 @@ void TextReader::ready(PointTableRef table)
         throwError("Unable to open text file '" + m_filename + "'.");
 
     m_istream->seekg(m_dataStart);
+    m_buf.resize(BufferSize);
+    m_bufPos = 0;
+    m_bufEnd = 0;
+    m_eof = false;
+    m_values.resize(m_dims.size());
 }
 
 
-point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
+void TextReader::readBlock()
 {
-    PointId idx = view->size();
-    point_count_t cnt = 0;
-    PointRef point(*view, idx);
-    while (cnt < numPts)
+    // Move unprocessed data to the front of the buffer.
+    size_t remaining = m_bufEnd - m_bufPos;
+    if (m_bufPos)
+        std::memmove(m_buf.data(), m_buf.data() + m_bufPos, remaining);
+    m_bufPos = 0;
+    m_bufEnd = remaining;
+
+    // If the buffer is full it holds a partial line, so make room for the
+    // rest of it.
+    if (m_bufEnd == m_buf.size())
+        m_buf.resize(m_buf.size() * 2);
+
+    m_istream->read(m_buf.data() + m_bufEnd, m_buf.size() - m_bufEnd);
+    m_bufEnd += (size_t)m_istream->gcount();
+    if (!m_istream->good())
+        m_eof = true;
+}
+
+
+bool TextReader::nextLine(const char *& start, const char *& end)
+{
+    while (true)
     {
-        point.setPointId(idx);
-        if (!processOne(point))
-            break;
-        cnt++;
-        idx++;
+        const char *pos = m_buf.data() + m_bufPos;
+        const char *bufEnd = m_buf.data() + m_bufEnd;
+        const char *nl = (const char *)std::memchr(pos, '\n', bufEnd - pos);
+        if (nl)
+        {
+            start = pos;
+            end = nl;
+            m_bufPos += (nl - pos) + 1;
+            return true;
+        }
+        if (m_eof)
+        {
+            // The last line needn't end with a newline.
+            if (pos == bufEnd)
+                return false;
+            start = pos;
+            end = bufEnd;
+            m_bufPos = m_bufEnd;
+            return true;
+        }
+        readBlock();
     }
-    return cnt;
 }
 
 
-bool TextReader::processOne(PointRef& point)
+bool TextReader::nextLines(const char *& start, const char *& end)
 {
-    if (!fillFields())
+    while (true)
+    {
+        if (!m_eof)
+            readBlock();
+
+        const char *pos = m_buf.data() + m_bufPos;
+        const char *bufEnd = m_buf.data() + m_bufEnd;
+        if (m_eof)
+        {
+            if (pos == bufEnd)
+                return false;
+            start = pos;
+            end = bufEnd;
+            m_bufPos = m_bufEnd;
+            return true;
+        }
+
+        const char *last = bufEnd;
+        while (last > pos && last[-1] != '\n')
+            last--;
+        if (last > pos)
+        {
+            start = pos;
+            end = last;
+            m_bufPos += last - pos;
+            return true;
+        }
+    }
+}
+
+
+bool TextReader::parseLine(const char *start, const char *end, size_t line,
+    FieldList& fields, double *vals, std::vector<ParseError>& errors) const
+{
+    if (end > start && end[-1] == '\r')
+        end--;
+    if (start == end)
         return false;
 
-    double d;
-    for (size_t i = 0; i < m_fields.size(); ++i)
+    fields.clear();
+    if (m_separator != ' ')
+    {
+        const char *pos = start;
+        while (true)
+        {
+            const char *sep =
+                (const char *)std::memchr(pos, m_separator, end - pos);
+            if (!sep)
+            {
+                fields.push_back(Field(pos, end));
+                break;
+            }
+            fields.push_back(Field(pos, sep));
+            pos = sep + 1;
+        }
+    }
+    else
     {
-        if (!Utils::fromString(m_fields[i], d))
+        const char *pos = start;
+        while (pos < end)
         {
-            log()->get(LogLevel::Error) << "Can't convert "
-                "field '" << m_fields[i] << "' to numeric value on line " <<
-                m_line << " in '" << m_filename << "'.  Setting to 0." <<
-                std::endl;
-            d = 0;
+            while (pos < end && *pos == ' ')
+                pos++;
+            const char *fieldEnd = pos;
+            while (fieldEnd < end && *fieldEnd != ' ')
+                fieldEnd++;
+            if (fieldEnd > pos)
+                fields.push_back(Field(pos, fieldEnd));
+            pos = fieldEnd;
+        }
+    }
+
+    if (fields.size() != m_dims.size())
+    {
+        errors.push_back({ line, true, fields.size(), "" });
+        return false;
+    }
+
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        const char *fieldStart = fields[i].first;
+        const char *fieldEnd = fields[i].second;
+        while (fieldStart < fieldEnd && *fieldStart == ' ')
+            fieldStart++;
+        while (fieldEnd > fieldStart && fieldEnd[-1] == ' ')
+            fieldEnd--;
+        if (parseDouble(fieldStart, fieldEnd, vals[i]))
+            continue;
+
+        // Spaces are ignored in the input unless used as a separator.
+        std::string field(fieldStart, fieldEnd);
+        Utils::remove(field, ' ');
+        if (!Utils::fromString(field, vals[i]))
+        {
+            errors.push_back({ line, false, 0, field });
+            vals[i] = 0;
         }
-        point.setField(m_dims[i], d);
     }
     return true;
 }
 
 
-bool TextReader::fillFields()
+void TextReader::parseLines(const char *start, const char *end,
+    Chunk& chunk) const
 {
-    while (true)
+    FieldList fields;
+    size_t numDims = m_dims.size();
+
+    chunk.m_values.clear();
+    chunk.m_errors.clear();
+    chunk.m_lines = 0;
+    while (start < end)
     {
-        if (!m_istream->good())
-            return false;
+        const char *nl = (const char *)std::memchr(start, '\n', end - start);
+        const char *lineEnd = nl ? nl : end;
+
+        chunk.m_lines++;
+        size_t pos = chunk.m_values.size();
+        chunk.m_values.resize(pos + numDims);
+        if (!parseLine(start, lineEnd, chunk.m_lines, fields,
+                chunk.m_values.data() + pos, chunk.m_errors))
+            chunk.m_values.resize(pos);
+        start = nl ? nl + 1 : end;
+    }
+}
 
-        std::string buf;
 
-        std::getline(*m_istream, buf);
-        m_line++;
-        if (buf.empty())
-            continue;
-        if (m_separator != ' ')
+void TextReader::logError(const ParseError& error)
+{
+    if (error.m_badCount)
+        log()->get(LogLevel::Error) << "Line " << error.m_line <<
+            " in '" << m_filename << "' contains " << error.m_numFields <<
+            " fields when " << m_dims.size() << " were expected.  "
+            "Ignoring." << std::endl;
+    else
+        log()->get(LogLevel::Error) << "Can't convert "
+            "field '" << error.m_field << "' to numeric value on line " <<
+            error.m_line << " in '" << m_filename << "'.  Setting to 0." <<
+            std::endl;
+}
+
+
+// Blocks of lines are read from the file and split at line boundaries into
+// ranges that are parsed on separate threads.  The parsed values are then
+// added to the view in file order.
+point_count_t TextReader::read(PointViewPtr view, point_count_t numPts)
+{
+    PointId idx = view->size();
+    point_count_t cnt = 0;
+    size_t numDims = m_dims.size();
+
+    ThreadPool pool(m_threads);
+    std::vector<Chunk> chunks(pool.numThreads());
+    if (m_buf.size() < chunks.size() * BufferSize)
+        m_buf.resize(chunks.size() * BufferSize);
+
+    const char *start;
+    const char *end;
+    while (cnt < numPts && nextLines(start, end))
+    {
+        const char *pos = start;
+        for (size_t i = 0; i < chunks.size(); ++i)
         {
-            Utils::remove(buf, ' ');
-            m_fields = Utils::split(buf, m_separator);
+            const char *rangeEnd = (i == chunks.size() - 1) ? end :
+                start + (end - start) * (i + 1) / chunks.size();
+            if (rangeEnd < pos)
+                rangeEnd = pos;
+            while (rangeEnd > pos && rangeEnd < end && rangeEnd[-1] != '\n')
+                rangeEnd++;
+            Chunk& chunk = chunks[i];
+            pool.add([this, pos, rangeEnd, &chunk]()
+                { parseLines(pos, rangeEnd, chunk); });
+            pos = rangeEnd;
         }
-        else
-            m_fields = Utils::split2(buf, m_separator);
-        if (m_fields.size() != m_dims.size())
+        pool.await();
+
+        for (Chunk& chunk : chunks)
         {
-            log()->get(LogLevel::Error) << "Line " << m_line <<
-                " in '" << m_filename << "' contains " << m_fields.size() <<
-                " fields when " << m_dims.size() << " were expected.  "
-                "Ignoring." << std::endl;
-            continue;
+            for (ParseError& error : chunk.m_errors)
+            {
+                error.m_line += m_line;
+                logError(error);
+            }
+            m_line += chunk.m_lines;
+
+            const double *vals = chunk.m_values.data();
+            const double *valsEnd = vals + chunk.m_values.size();
+            for (; vals < valsEnd && cnt < numPts; vals += numDims)
+            {
+                for (size_t i = 0; i < numDims; ++i)
+                    view->setField(m_dims[i], idx, vals[i]);
+                cnt++;
+                idx++;
+            }
         }
+    }
+    return cnt;
+}
+
+
+bool TextReader::processOne(PointRef& point)
+{
+    const char *start;
+    const char *end;
+    while (nextLine(start, end))
+    {
+        m_line++;
+        m_errors.clear();
+        bool valid = parseLine(start, end, m_line, m_fields, m_values.data(),
+            m_errors);
+        for (const ParseError& error : m_errors)
+            logError(error);
+        if (!valid)
+            continue;
+
+        for (size_t i = 0; i < m_dims.size(); ++i)
+            point.setField(m_dims[i], m_values[i]);
         return true;
     }
+    return false;
 }
 
 
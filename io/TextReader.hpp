@@ -35,6 +35,8 @@
 #pragma once
 
 #include <istream>
+#include <utility>
+#include <vector>
 
 #include <pdal/Reader.hpp>
 #include <pdal/Streamable.hpp>
@@ -51,6 +53,28 @@ public:
     {}
 
 private:
+    // Start and end of a field within the read buffer.
+    typedef std::pair<const char *, const char *> Field;
+    typedef std::vector<Field> FieldList;
+
+    // Problem found when parsing a line.  Errors are collected rather than
+    // logged immediately so that lines can be parsed on several threads.
+    struct ParseError
+    {
+        size_t m_line;
+        bool m_badCount;
+        size_t m_numFields;
+        std::string m_field;
+    };
+
+    // Values parsed from a range of lines.
+    struct Chunk
+    {
+        std::vector<double> m_values;
+        std::vector<ParseError> m_errors;
+        size_t m_lines;
+    };
+
     /**
       Retrieve summary information for the file. NOTE - entire file must
       be read to retrieve summary for text files.
@@ -111,7 +135,54 @@ private:
     */
     virtual bool processOne(PointRef& point);
 
-    bool fillFields();
+    /**
+      Read more of the file into the buffer, keeping any unprocessed data.
+    */
+    void readBlock();
+
+    /**
+      Get the next line from the buffer.
+
+      \param start  Set to the start of the line.
+      \param end  Set to the end of the line, excluding the newline.
+      \return  False if there are no more lines.
+    */
+    bool nextLine(const char *& start, const char *& end);
+
+    /**
+      Get all the complete lines currently available in the buffer.
+
+      \param start  Set to the start of the first line.
+      \param end  Set to the end of the last line.
+      \return  False if there are no more lines.
+    */
+    bool nextLines(const char *& start, const char *& end);
+
+    /**
+      Parse a line into numeric values, one per dimension.
+
+      \param start  Start of the line.
+      \param end  End of the line.
+      \param line  Line number, used to report errors.
+      \param fields  Scratch space for field locations.
+      \param vals  Location to store parsed values.
+      \param errors  List to which any errors are added.
+      \return  True if the line contained point data.
+    */
+    bool parseLine(const char *start, const char *end, size_t line,
+        FieldList& fields, double *vals,
+        std::vector<ParseError>& errors) const;
+
+    /**
+      Parse a range of complete lines.
+
+      \param start  Start of the first line.
+      \param end  End of the last line.
+      \param chunk  Chunk in which to store values and errors.
+    */
+    void parseLines(const char *start, const char *end, Chunk& chunk) const;
+
+    void logError(const ParseError& error);
 
     /**
       Parse a header line into a list of dimension names.
@@ -134,11 +205,18 @@ private:
     std::istream *m_istream;
     StringList m_dimNames;
     Dimension::IdList m_dims;
-    StringList m_fields;
+    FieldList m_fields;
+    std::vector<double> m_values;
+    std::vector<ParseError> m_errors;
     size_t m_line;
     std::string m_header;
     size_t m_skip;
+    size_t m_threads;
     std::streampos m_dataStart;
+    std::vector<char> m_buf;
+    size_t m_bufPos;
+    size_t m_bufEnd;
+    bool m_eof;
 };
 
 } // namespace pdal
@@ -39,12 +39,75 @@
 #include <pdal/PointView.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
 namespace pdal
 {
 
+namespace
+{
+
+// Formatted output is written when the buffer reaches this size.
+const size_t FlushSize = 1 << 20;
+
+// Number of points formatted by each task when writing a view.
+const PointId ChunkSize = 20000;
+
+// Append a value to a buffer in fixed-point notation.  The output matches
+// that of printf("%.*f").  Values are converted by scaling and rounding to
+// an integer, unless the result could be affected by rounding error in the
+// scaling, in which case snprintf() is used.
+void appendFixed(std::string& buf, double v, size_t precision)
+{
+    static const double powers[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15
+    };
+
+    if (precision < 16 && std::isfinite(v))
+    {
+        double scaled = std::fabs(v) * powers[precision];
+        double whole = std::floor(scaled);
+        double frac = scaled - whole;
+        // Bound on the error of the scaled value.
+        double margin = scaled * 2.3e-16;
+        if (scaled < 9007199254740992.0 && std::fabs(frac - .5) > margin)
+        {
+            uint64_t n = (uint64_t)whole + (frac > .5 ? 1 : 0);
+
+            // Digits are generated from the right.
+            char digits[32];
+            char *end = digits + sizeof(digits);
+            char *p = end;
+            size_t count = 0;
+            do
+            {
+                *--p = '0' + (n % 10);
+                n /= 10;
+                if (++count == precision)
+                    *--p = '.';
+            } while (n || count <= precision);
+            if (std::signbit(v))
+                *--p = '-';
+            buf.append(p, end);
+            return;
+        }
+    }
+
+    int len = std::snprintf(nullptr, 0, "%.*f", (int)precision, v);
+    size_t pos = buf.size();
+    buf.resize(pos + len + 1);
+    std::snprintf(&buf[pos], len + 1, "%.*f", (int)precision, v);
+    buf.resize(pos + len);
+}
+
+} // unnamed namespace
+
 static StaticPluginInfo const s_info
 {
     "writers.text",
@@ -57,6 +120,25 @@ CREATE_STATIC_STAGE(TextWriter, s_info)
 
 std::string TextWriter::getName() const { return s_info.name; }
 
+
+// Only the ordered dimensions are read if others aren't written.
+bool TextWriter::usedDimensions(StringList& dims) const
+{
+    StringList keep = m_options.getValues("keep_unspecified");
+    if (keep.empty() || Utils::tolower(keep.front()) != "false")
+        return false;
+    for (const std::string& order : m_options.getValues("order"))
+        for (std::string dim : Utils::split2(order, ','))
+        {
+            Utils::trim(dim);
+            dim = dim.substr(0, dim.find(':'));
+            if (dim.size())
+                dims.push_back(dim);
+        }
+    dims.insert(dims.end(), { "X", "Y", "Z" });
+    return true;
+}
+
 struct FileStreamDeleter
 {
 
@@ -86,6 +168,9 @@ void TextWriter::addArgs(ProgramArgs& args)
     args.add("quote_header", "Whether a header should be quoted",
         m_quoteHeader, true);
     args.add("precision", "Output precision", m_precision, 3);
+    args.add("threads", "Number of threads used to format points when not "
+        "streaming (0 uses all available hardware threads)", m_threads,
+        (size_t)1);
 }
 
 
@@ -145,6 +230,8 @@ bool TextWriter::findDim(Dimension::Id id, DimSpec& ds)
 void TextWriter::ready(PointTableRef table)
 {
     *m_stream << std::fixed;
+    m_buf.clear();
+    m_numWritten = 0;
 
     // Find the dimensions listed and put them on the id list.
     StringList dimNames = Utils::split2(m_dimOrder, ',');
@@ -165,6 +252,17 @@ void TextWriter::ready(PointTableRef table)
         }
     }
 
+    m_dimNames.clear();
+    for (const DimSpec& ds : m_dims)
+        m_dimNames.push_back(table.layout()->dimName(ds.id));
+    Dimension::Id xyz[] =
+        { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        DimSpec ds;
+        m_xyzPrecision[i] = findDim(xyz[i], ds) ? ds.precision : m_precision;
+    }
+
     if (!m_writeHeader)
         log()->get(LogLevel::Debug) << "Not writing header" << std::endl;
     else
@@ -185,6 +283,7 @@ void TextWriter::writeHeader(PointTableRef table)
 
 void TextWriter::writeFooter()
 {
+    flush();
     if (m_outputType == "GEOJSON")
     {
         *m_stream << "]}";
@@ -219,69 +318,118 @@ void TextWriter::writeCSVHeader(PointTableRef table)
     *m_stream << m_newline;
 }
 
-void TextWriter::writeCSVBuffer(const PointViewPtr view)
+void TextWriter::formatCSV(PointRef& point, std::string& buf) const
 {
-    for (PointId idx = 0; idx < view->size(); ++idx)
+    for (size_t i = 0; i < m_dims.size(); ++i)
     {
-        for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
-        {
-            if (di != m_dims.begin())
-                *m_stream << m_delimiter;
-            m_stream->precision(di->precision);
-            *m_stream << view->getFieldAs<double>(di->id, idx);
-        }
-        *m_stream << m_newline;
+        if (i)
+            buf += m_delimiter;
+        appendFixed(buf, point.getFieldAs<double>(m_dims[i].id),
+            m_dims[i].precision);
     }
+    buf += m_newline;
 }
 
-void TextWriter::writeGeoJSONBuffer(const PointViewPtr view)
+
+void TextWriter::formatGeoJSON(PointRef& point, bool first,
+    std::string& buf) const
 {
     using namespace Dimension;
 
-    auto write = [this](Dimension::Id id, PointId idx, const PointViewPtr view)
-    {
-        DimSpec ds;
-        size_t prec = findDim(id, ds) ? ds.precision : m_precision;
-        m_stream->precision(prec);
-        *m_stream << view->getFieldAs<double>(id, idx);
-    };
-
-    for (PointId idx = 0; idx < view->size(); ++idx)
-    {
-        if (idx)
-            *m_stream << ",";
+    if (!first)
+        buf += ",";
 
-        *m_stream << "{ \"type\":\"Feature\",\"geometry\": "
-            "{ \"type\": \"Point\", \"coordinates\": [";
+    buf += "{ \"type\":\"Feature\",\"geometry\": "
+        "{ \"type\": \"Point\", \"coordinates\": [";
 
-        write(Id::X, idx, view); *m_stream << ",";
-        write(Id::Y, idx, view); *m_stream << ",";
-        write(Id::Z, idx, view); *m_stream << "]},";
+    appendFixed(buf, point.getFieldAs<double>(Id::X), m_xyzPrecision[0]);
+    buf += ",";
+    appendFixed(buf, point.getFieldAs<double>(Id::Y), m_xyzPrecision[1]);
+    buf += ",";
+    appendFixed(buf, point.getFieldAs<double>(Id::Z), m_xyzPrecision[2]);
+    buf += "]},";
 
-        *m_stream << "\"properties\": {";
+    buf += "\"properties\": {";
 
-        for (auto di = m_dims.begin(); di != m_dims.end(); ++di)
-        {
-            if (di != m_dims.begin())
-                *m_stream << ",";
-
-            *m_stream << "\"" << view->dimName(di->id) << "\":";
-            *m_stream << "\"";
-            m_stream->precision(di->precision);
-            *m_stream << view->getFieldAs<double>(di->id, idx);
-            *m_stream <<"\"";
-        }
-        *m_stream << "}"; // end properties
-        *m_stream << "}"; // end feature
+    for (size_t i = 0; i < m_dims.size(); ++i)
+    {
+        if (i)
+            buf += ",";
+
+        buf += "\"";
+        buf += m_dimNames[i];
+        buf += "\":\"";
+        appendFixed(buf, point.getFieldAs<double>(m_dims[i].id),
+            m_dims[i].precision);
+        buf += "\"";
     }
+    buf += "}"; // end properties
+    buf += "}"; // end feature
 }
 
-void TextWriter::write(const PointViewPtr view)
+
+void TextWriter::formatPoint(PointRef& point, bool first,
+    std::string& buf) const
 {
     if (m_outputType == "CSV")
-        writeCSVBuffer(view);
+        formatCSV(point, buf);
     else if (m_outputType == "GEOJSON")
-        writeGeoJSONBuffer(view);
+        formatGeoJSON(point, first, buf);
+}
+
+
+void TextWriter::flush()
+{
+    m_stream->write(m_buf.data(), m_buf.size());
+    m_buf.clear();
+}
+
+
+bool TextWriter::processOne(PointRef& point)
+{
+    formatPoint(point, m_numWritten == 0, m_buf);
+    m_numWritten++;
+    if (m_buf.size() >= FlushSize)
+        flush();
+    return true;
+}
+
+
+// Chunks of points are formatted into separate buffers on separate threads
+// and then written in order.
+void TextWriter::write(const PointViewPtr view)
+{
+    ThreadPool pool(m_threads);
+    std::vector<std::string> bufs(pool.numThreads());
+
+    point_count_t base = m_numWritten;
+    PointId start = 0;
+    while (start < view->size())
+    {
+        for (size_t i = 0; i < bufs.size() && start < view->size(); ++i)
+        {
+            PointId end = (std::min)(start + ChunkSize, view->size());
+            std::string& buf = bufs[i];
+            pool.add([this, &view, &buf, start, end, base]()
+            {
+                PointRef point(*view, start);
+                for (PointId idx = start; idx < end; ++idx)
+                {
+                    point.setPointId(idx);
+                    formatPoint(point, base + idx == 0, buf);
+                }
+            });
+            m_numWritten += end - start;
+            start = end;
+        }
+        pool.await();
+
+        for (std::string& buf : bufs)
+        {
+            m_stream->write(buf.data(), buf.size());
+            buf.clear();
+        }
+    }
 }
 
 
@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <pdal/Streamable.hpp>
 #include <pdal/Writer.hpp>
 
 namespace pdal
@@ -41,7 +42,7 @@ namespace pdal
 
 typedef std::shared_ptr<std::ostream> FileStreamPtr;
 
-class PDAL_DLL TextWriter : public Writer
+class PDAL_DLL TextWriter : public Writer, public Streamable
 {
     struct DimSpec
     {
@@ -54,12 +55,14 @@ public:
     {}
 
     std::string getName() const;
+    virtual bool usedDimensions(StringList& dims) const;
 
 private:
     virtual void addArgs(ProgramArgs& args);
     virtual void initialize(PointTableRef table);
     virtual void ready(PointTableRef table);
     virtual void write(const PointViewPtr view);
+    virtual bool processOne(PointRef& point);
     virtual void done(PointTableRef table);
 
     void writeHeader(PointTableRef table);
@@ -67,8 +70,10 @@ private:
     void writeGeoJSONHeader();
     void writeCSVHeader(PointTableRef table);
 
-    void writeGeoJSONBuffer(const PointViewPtr view);
-    void writeCSVBuffer(const PointViewPtr view);
+    void formatPoint(PointRef& point, bool first, std::string& buf) const;
+    void formatGeoJSON(PointRef& point, bool first, std::string& buf) const;
+    void formatCSV(PointRef& point, std::string& buf) const;
+    void flush();
     DimSpec extractDim(std::string dim, PointTableRef table);
     bool findDim(Dimension::Id id, DimSpec& ds);
 
@@ -83,9 +88,15 @@ private:
     bool m_quoteHeader;
     bool m_packRgb;
     int m_precision;
+    size_t m_threads;
 
     FileStreamPtr m_stream;
     std::vector<DimSpec> m_dims;
+    StringList m_dimNames;
+    size_t m_xyzPrecision[3];
+    // Formatted output waiting to be written.
+    std::string m_buf;
+    point_count_t m_numWritten;
 
     TextWriter& operator=(const TextWriter&); // not implemented
     TextWriter(const TextWriter&); // not implemented
@@ -36,6 +36,7 @@
 
 #include <pdal/Stage.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -51,7 +52,8 @@ CREATE_STATIC_KERNEL(DeltaKernel, s_info)
 
 std::string DeltaKernel::getName() const { return s_info.name; }
 
-DeltaKernel::DeltaKernel() : m_detail(false), m_allDims(false)
+DeltaKernel::DeltaKernel() : m_detail(false), m_allDims(false),
+    m_threads(0)
 {}
 
 
@@ -65,6 +67,8 @@ void DeltaKernel::addSwitches(ProgramArgs& args)
     args.add("detail", "Output deltas per-point", m_detail);
     args.add("alldims", "Compute diffs for all dimensions (not just X,Y,Z)",
         m_allDims);
+    args.add("threads", "Number of threads used to find nearest neighbors "
+        "(0 uses all available hardware threads)", m_threads, (size_t)0);
 }
 
 
@@ -140,27 +144,81 @@ int DeltaKernel::execute()
 }
 
 
+namespace
+{
+
+const point_count_t ChunkSize = 65536;
+
+} // unnamed namespace
+
+
+// Find the nearest candidate point of each source point.  Points are
+// searched in fixed-size chunks on the thread pool.
+std::vector<PointId> DeltaKernel::findNeighbors(PointViewPtr& srcView,
+    KD3Index& index)
+{
+    using namespace Dimension;
+
+    std::vector<PointId> candIds(srcView->size());
+    ThreadPool pool(m_threads);
+    for (PointId begin = 0; begin < srcView->size(); begin += ChunkSize)
+    {
+        PointId end = (std::min)(begin + ChunkSize, srcView->size());
+        pool.add([&srcView, &index, &candIds, begin, end]()
+        {
+            for (PointId id = begin; id < end; ++id)
+            {
+                double dist;
+                nanoflann::KNNResultSet<double, PointId, point_count_t>
+                    results(1);
+                results.init(&candIds[id], &dist);
+                index.search(results, srcView->getFieldAs<double>(Id::X, id),
+                    srcView->getFieldAs<double>(Id::Y, id),
+                    srcView->getFieldAs<double>(Id::Z, id));
+            }
+        });
+    }
+    pool.await();
+    return candIds;
+}
+
+
 MetadataNode DeltaKernel::dump(PointViewPtr& srcView, PointViewPtr& candView,
     KD3Index& index, DimIndexMap& dims)
 {
     MetadataNode root;
 
-    for (PointId id = 0; id < srcView->size(); ++id)
+    // Each chunk of points is accumulated separately and the chunks are
+    // merged in order, so the result doesn't depend on the thread count.
+    std::vector<DimIndexMap> parts((srcView->size() + ChunkSize - 1) /
+        ChunkSize, dims);
+    std::vector<PointId> candIds = findNeighbors(srcView, index);
+    ThreadPool pool(m_threads);
+    for (size_t chunk = 0; chunk < parts.size(); ++chunk)
     {
-        PointRef point = srcView->point(id);
-        PointId candId = index.neighbor(point);
-
-        // It may be faster to put in a special case to avoid having to
-        // fetch X, Y and Z, more than once but this is simpler and
-        // I'm thinking in most cases it will make no practical difference.
-        for (auto di = dims.begin(); di != dims.end(); ++di)
+        pool.add([this, &srcView, &candView, &candIds, &parts, chunk]()
         {
-            DimIndex& d = di->second;
-            double sv = srcView->getFieldAs<double>(d.m_srcId, id);
-            double cv = candView->getFieldAs<double>(d.m_candId, candId);
-            accumulate(d, sv - cv);
-        }
+            DimIndexMap& part = parts[chunk];
+            PointId begin = chunk * ChunkSize;
+            PointId end = (std::min)(begin + ChunkSize, srcView->size());
+            for (PointId id = begin; id < end; ++id)
+            {
+                PointId candId = candIds[id];
+                for (auto di = part.begin(); di != part.end(); ++di)
+                {
+                    DimIndex& d = di->second;
+                    double sv = srcView->getFieldAs<double>(d.m_srcId, id);
+                    double cv =
+                        candView->getFieldAs<double>(d.m_candId, candId);
+                    accumulate(d, sv - cv);
+                }
+            }
+        });
     }
+    pool.await();
+    for (DimIndexMap& part : parts)
+        for (auto& dpair : part)
+            merge(dims[dpair.first], dpair.second);
 
     root.add("source", m_sourceFile);
     root.add("candidate", m_candidateFile);
@@ -186,15 +244,26 @@ void DeltaKernel::accumulate(DimIndex& d, double v)
 }
 
 
+void DeltaKernel::merge(DimIndex& d, const DimIndex& part)
+{
+    if (part.m_cnt == 0)
+        return;
+    d.m_cnt += part.m_cnt;
+    d.m_min = std::min(part.m_min, d.m_min);
+    d.m_max = std::max(part.m_max, d.m_max);
+    d.m_avg += (part.m_avg - d.m_avg) * part.m_cnt / d.m_cnt;
+}
+
+
 MetadataNode DeltaKernel::dumpDetail(PointViewPtr& srcView,
     PointViewPtr& candView, KD3Index& index, DimIndexMap& dims)
 {
     MetadataNode root;
 
+    std::vector<PointId> candIds = findNeighbors(srcView, index);
     for (PointId id = 0; id < srcView->size(); ++id)
     {
-        PointRef point = srcView->point(id);
-        PointId candId = index.neighbor(point);
+        PointId candId = candIds[id];
 
         MetadataNode delta = root.add("delta");
         delta.add("i", id);
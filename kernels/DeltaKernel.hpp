@@ -77,6 +77,9 @@ private:
     MetadataNode dumpDetail(PointViewPtr& srcView, PointViewPtr& candView,
         KD3Index& index, DimIndexMap& dims);
     void accumulate(DimIndex& d, double v);
+    void merge(DimIndex& d, const DimIndex& part);
+    std::vector<PointId> findNeighbors(PointViewPtr& srcView,
+        KD3Index& index);
 
     std::string m_sourceFile;
     std::string m_candidateFile;
@@ -87,6 +90,7 @@ private:
 
     bool m_detail;
     bool m_allDims;
+    size_t m_threads;
 };
 
 } // namespace pdal
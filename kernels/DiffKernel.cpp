@@ -34,10 +34,19 @@
 
 #include "DiffKernel.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 
 namespace pdal
@@ -54,6 +63,94 @@ CREATE_STATIC_KERNEL(DiffKernel, s_info)
 
 std::string DiffKernel::getName() const { return s_info.name; }
 
+namespace
+{
+
+// Points are compared in chunks of a fixed size so that the chunks, and so
+// the output, don't depend on the number of threads.
+const point_count_t ChunkSize = 65536;
+const size_t MaxErrors = 20;
+const size_t MaxPendingChunks = 16;
+
+// FNV-1a hash of a chunk of packed point data.
+uint64_t hash(const std::vector<char>& buf)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : buf)
+    {
+        h ^= (unsigned char)c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Thread pool that limits the number of queued tasks so that chunks read
+// faster than they can be processed don't accumulate in memory.
+class ChunkPool
+{
+public:
+    ChunkPool(size_t threads) : m_queued(0), m_pool(threads)
+        { m_limit = 4 * m_pool.numThreads(); }
+
+    void add(std::function<void()> task)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this](){ return m_queued < m_limit; });
+            m_queued++;
+        }
+        m_pool.add([this, task]()
+        {
+            task();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queued--;
+            m_cond.notify_all();
+        });
+    }
+
+    void await()
+        { m_pool.await(); }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_queued;
+    size_t m_limit;
+    ThreadPool m_pool;
+};
+
+// Determine whether two packed values are equal.  Floating-point values are
+// equal if they differ by no more than the tolerance.
+bool equal(Dimension::Type type, const char *v1, const char *v2,
+    double tolerance)
+{
+    size_t size = Dimension::size(type);
+    if (memcmp(v1, v2, size) == 0)
+        return true;
+    if (type == Dimension::Type::Double)
+    {
+        double d1, d2;
+        memcpy(&d1, v1, size);
+        memcpy(&d2, v2, size);
+        return std::fabs(d1 - d2) <= tolerance;
+    }
+    if (type == Dimension::Type::Float)
+    {
+        float f1, f2;
+        memcpy(&f1, v1, size);
+        memcpy(&f2, v2, size);
+        return std::fabs(f1 - f2) <= tolerance;
+    }
+    return false;
+}
+
+} // unnamed namespace
+
+
+DiffKernel::DiffKernel() : m_threads(0), m_tolerance(0)
+{}
+
+
 void DiffKernel::addSwitches(ProgramArgs& args)
 {
     Arg& source = args.add("source", "Source filename", m_sourceFile);
@@ -61,101 +158,350 @@ void DiffKernel::addSwitches(ProgramArgs& args)
     Arg& candidate = args.add("candidate", "Candidate filename",
         m_candidateFile);
     candidate.setPositional();
+    args.add("tolerance", "Largest difference between values of "
+        "floating-point dimensions considered equal", m_tolerance);
+    args.add("threads", "Number of threads used to compare points "
+        "(0 uses all available hardware threads)", m_threads, (size_t)0);
+}
+
+
+// Read the points of a file, streaming them if the reader supports it, and
+// pass each chunk of points, packed in dimension name order, to a callback.
+// The files are read concurrently, so each logs to its own stream.
+void DiffKernel::scan(File& file, ChunkFunc cb)
+{
+    LogPtr log(new Log(m_log->leader(), &file.m_log));
+    log->setLevel(m_log->getLevel());
+
+    PipelineManager manager;
+    manager.setLog(log);
+    manager.commonOptions() = m_manager.commonOptions();
+    manager.stageOptions() = m_manager.stageOptions();
+
+    Stage& reader = manager.makeReader(file.m_filename, m_driverOverride);
+
+    size_t chunk = 0;
+    size_t pointSize = 0;
+    file.m_count = 0;
+    ChunkPtr buf(new Chunk);
+    auto add = [&](PointRef& point)
+    {
+        size_t pos = buf->size();
+        buf->resize(pos + pointSize);
+        point.getPackedData(file.m_dims, buf->data() + pos);
+        file.m_count++;
+        if (buf->size() == ChunkSize * pointSize)
+        {
+            cb(chunk++, buf);
+            buf.reset(new Chunk);
+            buf->reserve(ChunkSize * pointSize);
+        }
+    };
+
+    auto setDims = [&](const PointLayout& layout)
+    {
+        file.m_dims = layout.dimTypes();
+        std::sort(file.m_dims.begin(), file.m_dims.end(),
+            [&layout](const DimType& d1, const DimType& d2)
+            { return layout.dimName(d1.m_id) < layout.dimName(d2.m_id); });
+        file.m_names.clear();
+        for (auto& d : file.m_dims)
+        {
+            file.m_names.push_back(layout.dimName(d.m_id));
+            pointSize += Dimension::size(d.m_type);
+        }
+        buf->reserve(ChunkSize * pointSize);
+    };
+
+    if (manager.pipelineStreamable())
+    {
+        StreamCallbackFilter f;
+        f.setCallback([&add](PointRef& point)
+        {
+            add(point);
+            return true;
+        });
+        f.setInput(reader);
+
+        FixedPointTable table(10000);
+        f.prepare(table);
+        setDims(*table.layout());
+        f.execute(table);
+    }
+    else
+    {
+        PointTable table;
+        reader.prepare(table);
+        setDims(*table.layout());
+        for (auto& view : reader.execute(table))
+        {
+            PointRef point(*view, 0);
+            for (PointId idx = 0; idx < view->size(); ++idx)
+            {
+                point.setPointId(idx);
+                add(point);
+            }
+        }
+    }
+    if (buf->size())
+        cb(chunk, buf);
+    file.m_metadata = reader.getMetadata();
+}
+
+
+// Wait for both files to be read and write what was logged while reading
+// them to the kernel's log, in file order, whether or not a read failed.
+void DiffKernel::awaitScans(ThreadPool& pool, File& source, File& candidate)
+{
+    auto writeLogs = [this, &source, &candidate]()
+    {
+        for (File *file : { &source, &candidate })
+        {
+            *m_log->getLogStream() << file->m_log.str() << std::flush;
+            file->m_log.str("");
+        }
+    };
+
+    try
+    {
+        pool.await();
+    }
+    catch (...)
+    {
+        writeLogs();
+        throw;
+    }
+    writeLogs();
 }
 
 
-void DiffKernel::checkPoints(const PointView& source_data,
-    const PointView& candidate_data, MetadataNode errors)
+// Hash the chunks of both files as they're read and return the chunks
+// whose hashes differ.
+std::vector<size_t> DiffKernel::hashChunks(File& source, File& candidate)
 {
-    uint32_t MAX_BADBYTES(20);
-    uint32_t badbytes(0);
+    std::mutex mutex;
+    ChunkPool hashPool(m_threads);
+
+    auto hasher = [&mutex, &hashPool](File& file)
+    {
+        return [&file, &mutex, &hashPool](size_t chunk, ChunkPtr buf)
+        {
+            hashPool.add([&file, &mutex, chunk, buf]()
+            {
+                uint64_t h = hash(*buf);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (file.m_hashes.size() <= chunk)
+                    file.m_hashes.resize(chunk + 1);
+                file.m_hashes[chunk] = h;
+            });
+        };
+    };
+
+    ThreadPool filePool(m_threads == 1 ? 1 : 2);
+    filePool.add([this, &source, &hasher]()
+        { scan(source, hasher(source)); });
+    filePool.add([this, &candidate, &hasher]()
+        { scan(candidate, hasher(candidate)); });
+    awaitScans(filePool, source, candidate);
+    hashPool.await();
+
+    std::vector<size_t> chunks;
+    size_t common =
+        (std::min)(source.m_hashes.size(), candidate.m_hashes.size());
+    for (size_t chunk = 0; chunk < common; ++chunk)
+        if (source.m_hashes[chunk] != candidate.m_hashes[chunk])
+            chunks.push_back(chunk);
+    return chunks;
+}
+
+
+// Read both files again and compare the points of the chunks whose hashes
+// differ.  A chunk is compared as soon as it has been read from both files
+// and is then discarded.  When the files are read concurrently, the reader
+// that is ahead waits if too many chunks are waiting for the other file.
+void DiffKernel::checkChunks(File& source, File& candidate,
+    const std::vector<size_t>& chunks, MetadataNode errors)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::map<size_t, std::pair<ChunkPtr, ChunkPtr>> pending;
+    std::map<size_t, StringList> found;
+    ThreadPool filePool(m_threads == 1 ? 1 : 2);
+    ChunkPool checkPool(m_threads);
+
+    // A reader that is alone can't wait for the other one.
+    bool sourceDone = false;
+    bool candidateDone = false;
+    size_t maxPending = filePool.numThreads() == 1 ?
+        (std::numeric_limits<size_t>::max)() : MaxPendingChunks;
+
+    auto check = [this, &source, &mutex, &found](size_t chunk,
+        ChunkPtr srcBuf, ChunkPtr candBuf)
+    {
+        StringList e = checkChunk(chunk, source, *srcBuf, *candBuf);
+        if (e.empty())
+            return;
 
-    // Both schemas have already been determined to be equal, so are the
-    // same size and in the same order.
-    Dimension::IdList const& sourceDims = source_data.dims();
-    Dimension::IdList const& candidateDims = candidate_data.dims();
+        std::lock_guard<std::mutex> lock(mutex);
+        found[chunk] = std::move(e);
+    };
 
-    char sbuf[8];
-    char cbuf[8];
-    for (PointId idx = 0; idx < source_data.size(); ++idx)
+    auto collector = [&](bool isSource) -> ChunkFunc
     {
-        for (size_t d = 0; d < sourceDims.size(); ++d)
+        return [&, isSource](size_t chunk, ChunkPtr buf)
         {
-            Dimension::Id sd = sourceDims[d];
-            Dimension::Id cd = candidateDims[d];
-
-            source_data.getRawField(sd, idx, (void *)sbuf);
-            candidate_data.getRawField(cd, idx, (void *)cbuf);
-            Dimension::Type t = Dimension::defaultType(cd);
-            size_t size = Dimension::size(t);
-            if (memcmp(sbuf, cbuf, size))
+            if (!std::binary_search(chunks.begin(), chunks.end(), chunk))
+                return;
+
+            ChunkPtr srcBuf;
+            ChunkPtr candBuf;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                auto it = pending.find(chunk);
+                if (it == pending.end())
+                {
+                    bool& otherDone = isSource ? candidateDone : sourceDone;
+                    cond.wait(lock, [&]()
+                        { return pending.size() < maxPending || otherDone; });
+                    it = pending.insert({ chunk, {} }).first;
+                }
+                auto& bufs = it->second;
+                (isSource ? bufs.first : bufs.second) = buf;
+                if (!bufs.first || !bufs.second)
+                    return;
+                srcBuf = bufs.first;
+                candBuf = bufs.second;
+                pending.erase(it);
+            }
+            cond.notify_all();
+            checkPool.add(std::bind(check, chunk, srcBuf, candBuf));
+        };
+    };
+
+    auto read = [&](File& file, bool isSource)
+    {
+        auto finish = [&]()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                (isSource ? sourceDone : candidateDone) = true;
+            }
+            cond.notify_all();
+        };
+
+        try
+        {
+            scan(file, collector(isSource));
+        }
+        catch (...)
+        {
+            finish();
+            throw;
+        }
+        finish();
+    };
+
+    filePool.add([&read, &source]()
+        { read(source, true); });
+    filePool.add([&read, &candidate]()
+        { read(candidate, false); });
+    awaitScans(filePool, source, candidate);
+    checkPool.await();
+
+    size_t count = 0;
+    for (auto& f : found)
+        for (auto& e : f.second)
+            if (count++ < MaxErrors)
+                errors.add("data.error", e);
+}
+
+
+// Compare the points of a chunk read from the source and candidate files.
+StringList DiffKernel::checkChunk(size_t chunk, const File& file,
+    const Chunk& source, const Chunk& candidate) const
+{
+    size_t pointSize = 0;
+    for (auto& d : file.m_dims)
+        pointSize += Dimension::size(d.m_type);
+    size_t count = (std::min)(source.size(), candidate.size()) / pointSize;
+
+    StringList errors;
+    const char *s = source.data();
+    const char *c = candidate.data();
+    for (size_t i = 0; i < count && errors.size() < MaxErrors; ++i)
+    {
+        for (size_t d = 0; d < file.m_dims.size(); ++d)
+        {
+            Dimension::Type t = file.m_dims[d].m_type;
+            if (!equal(t, s, c, m_tolerance))
             {
                 std::ostringstream oss;
 
-                oss << "Point " << idx << " differs for dimension \"" <<
-                    Dimension::name(sd) << "\" for source and candidate";
-                errors.add("data.error", oss.str());
-                badbytes++;
+                oss << "Point " << (chunk * ChunkSize + i) <<
+                    " differs for dimension \"" << file.m_names[d] <<
+                    "\" for source and candidate";
+                errors.push_back(oss.str());
             }
+            s += Dimension::size(t);
+            c += Dimension::size(t);
         }
-        if (badbytes > MAX_BADBYTES )
-            break;
     }
+    return errors;
 }
 
 
 int DiffKernel::execute()
 {
-    PointTable sourceTable;
-
-    Stage& source = makeReader(m_sourceFile, m_driverOverride);
-    source.prepare(sourceTable);
-    PointViewSet sourceSet = source.execute(sourceTable);
-
+    File source(m_sourceFile);
+    File candidate(m_candidateFile);
     MetadataNode errors;
 
-    PointTable candidateTable;
+    std::vector<size_t> chunks = hashChunks(source, candidate);
 
-    Stage& candidate = makeReader(m_candidateFile, m_driverOverride);
-    candidate.prepare(candidateTable);
-    PointViewSet candidateSet = candidate.execute(candidateTable);
-
-    assert(sourceSet.size() == 1);
-    assert(candidateSet.size() == 1);
-    PointViewPtr sourceView = *sourceSet.begin();
-    PointViewPtr candidateView = *candidateSet.begin();
-    if (candidateView->size() != sourceView->size())
+    if (candidate.m_count != source.m_count)
     {
         std::ostringstream oss;
 
         oss << "Source and candidate files do not have the same point count";
         errors.add("count.error", oss.str());
-        errors.add("count.candidate", candidateView->size());
-        errors.add("count.source", sourceView->size());
+        errors.add("count.candidate", candidate.m_count);
+        errors.add("count.source", source.m_count);
     }
 
-    MetadataNode source_metadata = sourceTable.metadata();
-    MetadataNode candidate_metadata = candidateTable.metadata();
-    if (source_metadata != candidate_metadata)
+    if (source.m_metadata != candidate.m_metadata)
     {
         std::ostringstream oss;
 
-        oss << "Source and candidate files do not have the same metadata count";
+        oss << "Source and candidate files do not have the same metadata";
         errors.add("metadata.error", oss.str());
-        errors.add(source_metadata);
-        errors.add(candidate_metadata);
+        errors.add(source.m_metadata);
+        errors.add(candidate.m_metadata);
     }
 
-    if (candidateTable.layout()->dims().size() !=
-        sourceTable.layout()->dims().size())
+    bool sameSchema = (source.m_names == candidate.m_names);
+    for (size_t i = 0; sameSchema && i < source.m_dims.size(); ++i)
+        if (source.m_dims[i].m_type != candidate.m_dims[i].m_type)
+            sameSchema = false;
+    if (!sameSchema)
     {
         std::ostringstream oss;
 
-        oss << "Source and candidate files do not have the same "
-            "number of dimensions";
+        oss << "Source and candidate files do not have the same schema";
+        errors.add("schema.error", oss.str());
+    }
+    else if (chunks.size())
+    {
+        m_log->get(LogLevel::Debug) << chunks.size() << " of " <<
+            source.m_hashes.size() << " chunks of points differ." <<
+            std::endl;
+        checkChunks(source, candidate, chunks, errors);
     }
 
-    return 0;
+    if (!errors.hasChildren())
+        return 0;
+    Utils::toJSON(errors, std::cout);
+    return 1;
 }
 
 } // namespace pdal
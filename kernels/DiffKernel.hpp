@@ -38,24 +38,57 @@
 #include <pdal/Stage.hpp>
 #include <pdal/util/FileUtils.hpp>
 
+#include <functional>
+#include <memory>
+#include <sstream>
+
 namespace pdal
 {
 
-class PointView;
+class ThreadPool;
 
 class PDAL_DLL DiffKernel : public Kernel
 {
+    // Description of the points read from one of the files.
+    struct File
+    {
+        File(const std::string& filename) : m_filename(filename), m_count(0)
+        {}
+
+        std::string m_filename;
+        point_count_t m_count;
+        DimTypeList m_dims;
+        StringList m_names;
+        MetadataNode m_metadata;
+        std::vector<uint64_t> m_hashes;
+        std::ostringstream m_log;
+    };
+
+    typedef std::vector<char> Chunk;
+    typedef std::shared_ptr<Chunk> ChunkPtr;
+    typedef std::function<void(size_t, ChunkPtr)> ChunkFunc;
+
 public:
     std::string getName() const;
     int execute(); // overrride
 
+    DiffKernel();
+
 private:
     virtual void addSwitches(ProgramArgs& args);
 
-    void checkPoints(const PointView& source_data,
-        const PointView& candidate_data, MetadataNode errors);
+    void scan(File& file, ChunkFunc cb);
+    void awaitScans(ThreadPool& pool, File& source, File& candidate);
+    std::vector<size_t> hashChunks(File& source, File& candidate);
+    void checkChunks(File& source, File& candidate,
+        const std::vector<size_t>& chunks, MetadataNode errors);
+    StringList checkChunk(size_t chunk, const File& file,
+        const Chunk& source, const Chunk& candidate) const;
+
     std::string m_sourceFile;
     std::string m_candidateFile;
+    size_t m_threads;
+    double m_tolerance;
 };
 
 } // namespace pdal
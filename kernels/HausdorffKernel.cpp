@@ -64,6 +64,20 @@ void HausdorffKernel::addSwitches(ProgramArgs& args)
     Arg& candidate = args.add("candidate", "Candidate filename",
                               m_candidateFile);
     candidate.setPositional();
+    args.add("percentile", "Percentile of nearest-neighbor distances to "
+        "report (partial Hausdorff distance)", m_percentile, 100.0);
+    args.add("directed", "Only compute the distance from source to "
+        "candidate", m_directed);
+    args.add("threads", "Number of threads used to find nearest neighbors "
+        "(0 uses all available hardware threads)", m_threads, (size_t)0);
+}
+
+
+void HausdorffKernel::validateSwitches(ProgramArgs& args)
+{
+    if (m_percentile <= 0 || m_percentile > 100)
+        throw pdal_error("Option 'percentile' must be greater than 0 and "
+            "no more than 100.");
 }
 
 
@@ -86,11 +100,23 @@ int HausdorffKernel::execute()
     PointTable candTable;
     PointViewPtr candView = loadSet(m_candidateFile, candTable);
 
-    double hausdorff = Utils::computeHausdorff(srcView, candView);
+    double srcToCand = Utils::computeDirectedHausdorff(srcView, candView,
+        m_percentile, m_threads);
+    double hausdorff = srcToCand;
 
     MetadataNode root;
     root.add("filenames", m_sourceFile);
     root.add("filenames", m_candidateFile);
+    root.add("source_to_candidate", srcToCand);
+    if (!m_directed)
+    {
+        double candToSrc = Utils::computeDirectedHausdorff(candView, srcView,
+            m_percentile, m_threads);
+        root.add("candidate_to_source", candToSrc);
+        hausdorff = (std::max)(srcToCand, candToSrc);
+    }
+    if (m_percentile < 100)
+        root.add("percentile", m_percentile);
     root.add("hausdorff", hausdorff);
     root.add("pdal_version", Config::fullVersionString());
     Utils::toJSON(root, std::cout);
@@ -51,10 +51,14 @@ public:
 
 private:
     virtual void addSwitches(ProgramArgs& args);
+    virtual void validateSwitches(ProgramArgs& args);
     PointViewPtr loadSet(const std::string& filename, PointTable& table);
 
     std::string m_sourceFile;
     std::string m_candidateFile;
+    double m_percentile;
+    bool m_directed;
+    size_t m_threads;
 };
 
 } // namespace pdal
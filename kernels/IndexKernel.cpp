@@ -0,0 +1,126 @@
+/******************************************************************************
+* Copyright (c) 2014, Bradley J Chambers (brad.chambers@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "IndexKernel.hpp"
+
+#include <memory>
+
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/LasIndex.hpp>
+#include <io/LasReader.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/OStream.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.index",
+    "Index Kernel",
+    "http://pdal.io/apps/lasindex.html"
+};
+
+CREATE_STATIC_KERNEL(IndexKernel, s_info)
+
+std::string IndexKernel::getName() const
+{
+    return s_info.name;
+}
+
+
+IndexKernel::IndexKernel() : m_cellSize(0)
+{}
+
+
+void IndexKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("files,f", "LAS/LAZ files to index", m_files).setPositional();
+    args.add("cell_size", "Edge length of index cells.  By default, a size "
+        "is chosen to place about 50000 points in each cell.", m_cellSize);
+}
+
+
+int IndexKernel::execute()
+{
+    for (const std::string& filename : m_files)
+        indexFile(filename);
+    return 0;
+}
+
+
+// Stream the points of a file to find the index cell of each.
+void IndexKernel::indexFile(const std::string& filename)
+{
+    Options readerOptions;
+    readerOptions.add("filename", filename);
+    LasReader reader;
+    reader.setOptions(readerOptions);
+
+    std::unique_ptr<LasIndex> index;
+    PointId idx = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&index, &idx](PointRef& point)
+    {
+        index->add(idx++, point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y));
+        return true;
+    });
+    f.setInput(reader);
+
+    FixedPointTable table(10000);
+    f.prepare(table);
+    index.reset(new LasIndex(reader.header().getBounds().to2d(),
+        reader.getNumPoints(), m_cellSize));
+    index->setSource(FileUtils::fileSize(filename),
+        reader.header().getBounds());
+    f.execute(table);
+
+    if (idx != reader.getNumPoints())
+        throw pdal_error("Read " + Utils::toString(idx) + " points from '" +
+            filename + "' but header specifies " +
+            Utils::toString(reader.getNumPoints()) + ".  Can't index file.");
+
+    std::string indexFilename = LasIndex::filename(filename);
+    OLeStream out(indexFilename);
+    if (!out)
+        throw pdal_error("Unable to open index file '" + indexFilename +
+            "' for output.");
+    index->write(out);
+    out.flush();
+    if (!out)
+        throw pdal_error("Error writing index file '" + indexFilename + "'.");
+}
+
+} // namespace pdal
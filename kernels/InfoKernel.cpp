@@ -35,12 +35,17 @@
 #include "InfoKernel.hpp"
 
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sstream>
 
 #include <pdal/KDIndex.hpp>
 #include <pdal/PipelineWriter.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/pdal_config.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #ifdef PDAL_HAVE_LIBXML2
 #include <pdal/XMLSchema.hpp>
 #endif
@@ -65,9 +70,11 @@ InfoKernel::InfoKernel()
     , m_showAll(false)
     , m_showMetadata(false)
     , m_boundary(false)
+    , m_approximate(false)
     , m_showSummary(false)
     , m_needPoints(false)
-    , m_statsStage(NULL)
+    , m_threads(0)
+    , m_job(m_manager)
 {}
 
 
@@ -75,7 +82,7 @@ void InfoKernel::validateSwitches(ProgramArgs& args)
 {
     int functions = 0;
 
-    if (!m_usestdin && m_inputFile.empty())
+    if (!m_usestdin && m_inputFiles.empty())
         throw pdal_error("No input file specified.");
 
     // All isn't really all.
@@ -125,7 +132,8 @@ void InfoKernel::validateSwitches(ProgramArgs& args)
 
 void InfoKernel::addSwitches(ProgramArgs& args)
 {
-    args.add("input,i", "Input file name", m_inputFile).setOptionalPositional();
+    args.add("input,i", "Input file name(s) or glob pattern(s)",
+        m_inputFiles).setOptionalPositional();
     args.add("all", "Dump statistics, schema and metadata", m_showAll);
     args.add("point,p", "Point to dump\n--point=\"1-5,10,100-200\" (0 indexed)",
         m_pointIndexes);
@@ -142,6 +150,14 @@ void InfoKernel::addSwitches(ProgramArgs& args)
         m_dimensions);
     args.add("enumerate", "Dimensions whose values should be enumerated",
         m_enumerate);
+    args.add("global", "Dimensions on which to compute global statistics "
+        "(median, mad, quantiles)", m_global);
+    args.add("quantiles", "Quantiles to compute for global statistics "
+        "dimensions\n--quantiles=\"0.05,0.95\"", m_quantiles);
+    args.add("cardinality", "Dimensions whose number of distinct values "
+        "should be estimated", m_cardinality);
+    args.add("approximate", "Compute global statistics with a bounded-memory "
+        "sketch, streaming points when possible", m_approximate);
     args.add("schema", "Dump the schema", m_showSchema);
     args.add("pipeline-serialization", "Output filename for pipeline "
         "serialization", m_pipelineFile);
@@ -150,6 +166,9 @@ void InfoKernel::addSwitches(ProgramArgs& args)
     args.add("pointcloudschema", "Dump PointCloudSchema XML output",
         m_PointCloudSchemaOutput).setHidden();
     args.add("stdin,s", "Read a pipeline file from standard input", m_usestdin);
+    args.add("threads", "Number of files to process concurrently when "
+        "given multiple files (0 uses all available hardware threads)",
+        m_threads, (size_t)0);
 }
 
 // Support for parsing point numbers.  Points can be specified singly or as
@@ -202,7 +221,7 @@ vector<PointId> getListOfPoints(std::string p)
 
 } //namespace
 
-MetadataNode InfoKernel::dumpPoints(PointViewPtr inView) const
+MetadataNode InfoKernel::dumpPoints(PointViewPtr inView, Log& log) const
 {
     MetadataNode root;
     PointViewPtr outView = inView->makeNew();
@@ -217,7 +236,7 @@ MetadataNode InfoKernel::dumpPoints(PointViewPtr inView) const
             outView->appendPoint(*inView.get(), id);
         else if (!oorMsg)
         {
-            m_log->get(LogLevel::Warning) << "Attempt to display points with "
+            log.get(LogLevel::Warning) << "Attempt to display points with "
                 "IDs not available in input dataset." << std::endl;
             oorMsg = true;
         }
@@ -273,40 +292,48 @@ MetadataNode InfoKernel::dumpSummary(const QuickInfo& qi)
 }
 
 
-void InfoKernel::makePipeline(const std::string& filename, bool noPoints)
+void InfoKernel::makePipeline(Job& job, const std::string& filename,
+    bool noPoints)
 {
     if (!pdal::Utils::fileExists(filename))
         throw pdal_error("File not found: " + filename);
 
     if (filename == "STDIN")
     {
-        m_manager.readPipeline(std::cin);
-        m_reader = m_manager.getStage();
+        job.m_manager.readPipeline(std::cin);
+        job.m_reader = job.m_manager.getStage();
     }
     else if (FileUtils::extension(filename) == ".xml" ||
         FileUtils::extension(filename) == ".json")
     {
-        m_manager.readPipeline(filename);
-        m_reader = m_manager.getStage();
+        job.m_manager.readPipeline(filename);
+        job.m_reader = job.m_manager.getStage();
     }
     else
     {
         Options ops;
         if (noPoints)
             ops.add("count", 0);
-        Stage& reader = m_manager.makeReader(filename, m_driverOverride, ops);
-        m_reader = &reader;
+        Stage& reader = job.m_manager.makeReader(filename, m_driverOverride,
+            ops);
+        job.m_reader = &reader;
     }
-    if (!m_reader)
+    if (!job.m_reader)
         throw pdal_error("Pipeline contains no valid stages.");
 }
 
 
 void InfoKernel::setup(const std::string& filename)
 {
-    makePipeline(filename, !m_needPoints);
+    setup(m_job, filename);
+}
+
 
-    Stage *stage = m_reader;
+void InfoKernel::setup(Job& job, const std::string& filename)
+{
+    makePipeline(job, filename, !m_needPoints);
+
+    Stage *stage = job.m_reader;
     if (m_showStats)
     {
         Options filterOptions;
@@ -314,18 +341,27 @@ void InfoKernel::setup(const std::string& filename)
             filterOptions.add({"dimensions", m_dimensions});
         if (m_enumerate.size())
             filterOptions.add({"enumerate", m_enumerate});
-        m_statsStage = &m_manager.makeFilter("filters.stats", *stage,
+        if (m_global.size())
+            filterOptions.add({"global", m_global});
+        if (m_quantiles.size())
+            filterOptions.add({"quantiles", m_quantiles});
+        if (m_cardinality.size())
+            filterOptions.add({"cardinality", m_cardinality});
+        if (m_approximate)
+            filterOptions.add("approximate", true);
+        job.m_statsStage = &job.m_manager.makeFilter("filters.stats", *stage,
             filterOptions);
-        stage = m_statsStage;
+        stage = job.m_statsStage;
     }
     if (m_boundary)
     {
         try
         {
-            m_hexbinStage = &m_manager.makeFilter("filters.hexbin", *stage);
+            job.m_hexbinStage = &job.m_manager.makeFilter("filters.hexbin",
+                *stage);
         } catch (pdal::pdal_error&)
         {
-            m_hexbinStage = nullptr;
+            job.m_hexbinStage = nullptr;
 
         }
     }
@@ -333,13 +369,19 @@ void InfoKernel::setup(const std::string& filename)
 
 
 MetadataNode InfoKernel::run(const std::string& filename)
+{
+    return run(m_job, filename);
+}
+
+
+MetadataNode InfoKernel::run(Job& job, const std::string& filename)
 {
     MetadataNode root;
 
     root.add("filename", filename);
     if (m_showSummary)
     {
-        QuickInfo qi = m_reader->preview();
+        QuickInfo qi = job.m_reader->preview();
         if (!qi.valid())
             throw pdal_error("No summary data available for '" +
                 filename + "'.");
@@ -348,26 +390,40 @@ MetadataNode InfoKernel::run(const std::string& filename)
     }
     else
     {
-        if (m_needPoints || m_showMetadata)
-            m_manager.execute();
+        // Approximate statistics need no point storage, so the points can
+        // be streamed if nothing else requires the point views.
+        bool stream = m_approximate && !m_boundary && !m_showSchema &&
+            m_pointIndexes.empty() && m_queryPoint.empty() &&
+            m_PointCloudSchemaOutput.empty() &&
+            job.m_manager.pipelineStreamable();
+        if (stream)
+        {
+            FixedPointTable table(10000);
+            job.m_manager.executeStream(table);
+        }
+        else if (m_needPoints || m_showMetadata)
+            job.m_manager.execute();
         else
-            m_manager.prepare();
-        dump(root);
+            job.m_manager.prepare();
+        dump(job, root);
     }
     root.add("pdal_version", Config::fullVersionString());
     return root;
 }
 
 
-void InfoKernel::dump(MetadataNode& root)
+void InfoKernel::dump(Job& job, MetadataNode& root)
 {
     if (m_showSchema)
-        root.add(m_manager.pointTable().layout()->toMetadata().clone("schema"));
+    {
+        PointLayoutPtr layout = job.m_manager.pointTable().layout();
+        root.add(layout->toMetadata().clone("schema"));
+    }
 
     if (m_PointCloudSchemaOutput.size() > 0)
     {
 #ifdef PDAL_HAVE_LIBXML2
-        XMLSchema schema(m_manager.pointTable().layout());
+        XMLSchema schema(job.m_manager.pointTable().layout());
 
         std::ostream *out = Utils::createFile(m_PointCloudSchemaOutput);
         std::string xml(schema.xml());
@@ -380,23 +436,24 @@ void InfoKernel::dump(MetadataNode& root)
 
     }
     if (m_showStats)
-        root.add(m_statsStage->getMetadata().clone("stats"));
+        root.add(job.m_statsStage->getMetadata().clone("stats"));
 
     if (m_pipelineFile.size() > 0)
-        PipelineWriter::writePipeline(m_manager.getStage(), m_pipelineFile);
+        PipelineWriter::writePipeline(job.m_manager.getStage(), m_pipelineFile);
 
     if (m_pointIndexes.size())
     {
-        PointViewSet viewSet = m_manager.views();
+        PointViewSet viewSet = job.m_manager.views();
         assert(viewSet.size() == 1);
-        MetadataNode points = dumpPoints(*viewSet.begin());
+        MetadataNode points = dumpPoints(*viewSet.begin(),
+            job.m_log ? *job.m_log : *m_log);
         if (points.valid())
             root.add(points.clone("points"));
     }
 
     if (m_queryPoint.size())
     {
-        PointViewSet viewSet = m_manager.views();
+        PointViewSet viewSet = job.m_manager.views();
         assert(viewSet.size() == 1);
         root.add(dumpQuery(*viewSet.begin()));
     }
@@ -407,18 +464,18 @@ void InfoKernel::dump(MetadataNode& root)
         // weren't reading a pipeline file directly. In that
         // case, use the metadata from the reader (old behavior).
         // Otherwise, return the full metadata of the entire pipeline
-        if (m_reader)
-            root.add(m_reader->getMetadata().clone("metadata"));
+        if (job.m_reader)
+            root.add(job.m_reader->getMetadata().clone("metadata"));
         else
-            root.add(m_manager.getMetadata().clone("metadata"));
+            root.add(job.m_manager.getMetadata().clone("metadata"));
     }
 
     if (m_boundary)
     {
-        PointViewSet viewSet = m_manager.views();
+        PointViewSet viewSet = job.m_manager.views();
         assert(viewSet.size() == 1);
-        if (m_hexbinStage)
-            root.add(m_hexbinStage->getMetadata().clone("boundary"));
+        if (job.m_hexbinStage)
+            root.add(job.m_hexbinStage->getMetadata().clone("boundary"));
         else
         {
             pdal::BOX2D bounds;
@@ -509,7 +566,40 @@ MetadataNode InfoKernel::dumpQuery(PointViewPtr inView) const
 
 int InfoKernel::execute()
 {
-    std::string filename = m_usestdin ? std::string("STDIN") : m_inputFile;
+    StringList filenames;
+    if (m_usestdin)
+        filenames.push_back("STDIN");
+    for (const std::string& f : m_inputFiles)
+    {
+        if (f.find_first_of("*?[") == std::string::npos)
+        {
+            filenames.push_back(f);
+            continue;
+        }
+        StringList matches = FileUtils::glob(f);
+        if (matches.empty())
+            throw pdal_error("No files match '" + f + "'.");
+        std::sort(matches.begin(), matches.end());
+        filenames.insert(filenames.end(), matches.begin(), matches.end());
+    }
+
+    // Checked once globs have been expanded, since a single pattern may
+    // match several files.
+    if (filenames.size() > 1)
+    {
+        if (m_usestdin)
+            throw pdal_error("--stdin option incompatible with multiple "
+                "input files.");
+        if (m_pipelineFile.size())
+            throw pdal_error("--pipeline-serialization option incompatible "
+                "with multiple input files.");
+        if (m_PointCloudSchemaOutput.size())
+            throw pdal_error("--pointcloudschema option incompatible "
+                "with multiple input files.");
+        return runBatch(filenames);
+    }
+
+    std::string filename = filenames.front();
     setup(filename);
     MetadataNode root = run(filename);
     Utils::toJSON(root, std::cout);
@@ -518,4 +608,93 @@ int InfoKernel::execute()
 }
 
 
+// Describe each file with its own pipeline on a thread pool and write one
+// JSON document per file, in the order the files were given.  A file that
+// can't be read produces a document with an "error" entry rather than
+// stopping the batch.
+int InfoKernel::runBatch(const StringList& filenames)
+{
+    struct Doc
+    {
+        Doc() : m_done(false), m_ok(false)
+        {}
+
+        bool m_done;
+        bool m_ok;
+        std::string m_json;
+        std::string m_log;
+    };
+
+    std::vector<Doc> docs(filenames.size());
+    std::mutex mutex;
+    std::condition_variable done;
+    ThreadPool pool(m_threads);
+    const size_t window = 4 * pool.numThreads();
+    size_t next = 0;
+
+    auto describe = [this, &filenames, &docs, &mutex, &done](size_t i)
+    {
+        const std::string& filename = filenames[i];
+        Doc doc;
+
+        // Each file has its own log, which is written along with the file's
+        // document so that messages for different files aren't interleaved.
+        std::ostringstream logStream;
+        LogPtr log(new Log(m_log->leader(), &logStream));
+        log->setLevel(m_log->getLevel());
+        try
+        {
+            PipelineManager manager;
+            manager.setLog(log);
+            manager.commonOptions() = m_manager.commonOptions();
+            manager.stageOptions() = m_manager.stageOptions();
+
+            Job job(manager);
+            job.m_log = log;
+            setup(job, filename);
+            doc.m_json = Utils::toJSON(run(job, filename));
+            doc.m_ok = true;
+        }
+        catch (const std::exception& err)
+        {
+            MetadataNode root;
+            root.add("filename", filename);
+            root.add("error", err.what());
+            doc.m_json = Utils::toJSON(root);
+        }
+        doc.m_log = logStream.str();
+        doc.m_done = true;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        docs[i] = std::move(doc);
+        done.notify_all();
+    };
+
+    size_t failed = 0;
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        for (; next < filenames.size() && next < i + window; ++next)
+            pool.add(std::bind(describe, next));
+
+        Doc doc;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&docs, i](){ return docs[i].m_done; });
+            doc = std::move(docs[i]);
+        }
+        if (!doc.m_ok)
+            failed++;
+        if (doc.m_log.size())
+            *m_log->getLogStream() << doc.m_log << std::flush;
+        std::cout << doc.m_json << std::endl;
+    }
+    pool.await();
+
+    if (failed)
+        m_log->get(LogLevel::Error) << "Unable to describe " << failed <<
+            " of " << filenames.size() << " files." << std::endl;
+    return failed ? 1 : 0;
+}
+
+
 } // namespace pdal
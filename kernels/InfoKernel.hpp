@@ -49,6 +49,21 @@ namespace pdal
 
 class PDAL_DLL InfoKernel : public Kernel
 {
+    // Pipeline built to describe a single input.  In batch mode each file
+    // is described concurrently by its own pipeline.
+    struct Job
+    {
+        Job(PipelineManager& manager) : m_manager(manager),
+            m_reader(nullptr), m_statsStage(nullptr), m_hexbinStage(nullptr)
+        {}
+
+        PipelineManager& m_manager;
+        Stage *m_reader;
+        Stage *m_statsStage;
+        Stage *m_hexbinStage;
+        LogPtr m_log;   // Log for the job, if not the kernel's log.
+    };
+
 public:
     std::string getName() const;
     int execute(); // overrride
@@ -66,15 +81,18 @@ private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
 
-    void dump(MetadataNode& root);
-    MetadataNode dumpPoints(PointViewPtr inView) const;
+    void setup(Job& job, const std::string& filename);
+    MetadataNode run(Job& job, const std::string& filename);
+    int runBatch(const StringList& filenames);
+    void dump(Job& job, MetadataNode& root);
+    MetadataNode dumpPoints(PointViewPtr inView, Log& log) const;
     MetadataNode dumpStats() const;
     void dumpPipeline() const;
     MetadataNode dumpSummary(const QuickInfo& qi);
     MetadataNode dumpQuery(PointViewPtr inView) const;
-    void makePipeline(const std::string& filename, bool noPoints);
+    void makePipeline(Job& job, const std::string& filename, bool noPoints);
 
-    std::string m_inputFile;
+    StringList m_inputFiles;
     bool m_showStats;
     bool m_showSchema;
     bool m_showAll;
@@ -83,16 +101,19 @@ private:
     std::string m_pointIndexes;
     std::string m_dimensions;
     std::string m_enumerate;
+    std::string m_global;
+    std::string m_quantiles;
+    std::string m_cardinality;
+    bool m_approximate;
     std::string m_queryPoint;
     std::string m_pipelineFile;
     bool m_showSummary;
     bool m_needPoints;
     std::string m_PointCloudSchemaOutput;
     bool m_usestdin;
+    size_t m_threads;
 
-    Stage *m_statsStage;
-    Stage *m_hexbinStage;
-    Stage *m_reader;
+    Job m_job;
 
     MetadataNode m_tree;
 };
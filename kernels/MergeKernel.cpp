@@ -70,9 +70,41 @@ void MergeKernel::validateSwitches(ProgramArgs& args)
 }
 
 
+// Check that the inputs can be merged sensibly from their previews so that
+// problems are reported before any points are read.
+void MergeKernel::checkInputs()
+{
+    SpatialReference srs;
+    for (const std::string& filename : m_files)
+    {
+        PipelineManager manager;
+        manager.setLog(m_log);
+        manager.commonOptions() = m_manager.commonOptions();
+        manager.stageOptions() = m_manager.stageOptions();
+
+        QuickInfo qi = manager.makeReader(filename, m_driverOverride).preview();
+        if (!qi.valid() || qi.m_srs.empty())
+            continue;
+        if (srs.empty())
+            srs = qi.m_srs;
+        else if (qi.m_srs != srs)
+        {
+            m_log->get(LogLevel::Warning) << "Input file '" << filename <<
+                "' has a different spatial reference than previous input "
+                "files.  Points will be merged without reprojection." <<
+                std::endl;
+            break;
+        }
+    }
+}
+
+
+// Inputs are streamed one after another into the writer when all the
+// stages support it, so memory use doesn't depend on the number or size of
+// the inputs.
 int MergeKernel::execute()
 {
-    PointTable table;
+    checkInputs();
 
     MergeFilter filter;
 
@@ -83,8 +115,18 @@ int MergeKernel::execute()
     }
 
     Stage& writer = makeWriter(m_outputFile, filter, "");
-    writer.prepare(table);
-    writer.execute(table);
+    if (writer.pipelineStreamable())
+    {
+        FixedPointTable table(10000);
+        writer.prepare(table);
+        writer.execute(table);
+    }
+    else
+    {
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+    }
     return 0;
 }
 
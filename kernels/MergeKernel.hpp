@@ -48,6 +48,7 @@ public:
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    void checkInputs();
 
     StringList m_files;
     std::string m_outputFile;
@@ -55,7 +55,8 @@ CREATE_STATIC_KERNEL(PipelineKernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1),
+    m_threads(1)
 {}
 
 
@@ -93,6 +94,9 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
     args.add("stdin,s", "Read pipeline from standard input", m_usestdin);
     args.add("stream", "This option is obsolete.", m_stream);
     args.add("metadata", "Metadata filename", m_metadataFile);
+    args.add("threads", "Number of threads used to run independent "
+        "branches of a pipeline that isn't streamed (0 uses all available "
+        "hardware threads)", m_threads, (size_t)1);
 }
 
 
@@ -138,7 +142,10 @@ int PipelineKernel::execute()
         m_manager.executeStream(table);
     }
     else
+    {
+        m_manager.setThreads(m_threads);
         m_manager.execute();
+    }
 
     if (m_metadataFile.size())
     {
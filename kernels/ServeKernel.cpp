@@ -0,0 +1,174 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "ServeKernel.hpp"
+
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include <json/json.h>
+
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PipelineManager.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+static StaticPluginInfo const s_info
+{
+    "kernels.serve",
+    "Serve Kernel",
+    "http://pdal.io/apps/serve.html"
+};
+
+CREATE_STATIC_KERNEL(ServeKernel, s_info)
+
+std::string ServeKernel::getName() const { return s_info.name; }
+
+ServeKernel::ServeKernel() : m_threads(0)
+{}
+
+
+bool ServeKernel::isStagePrefix(const std::string& stage)
+{
+    return Kernel::isStagePrefix(stage) || stage == "stage";
+}
+
+
+void ServeKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("threads", "Number of pipelines run at once "
+        "(0 uses all available hardware threads)", m_threads, (size_t)0);
+}
+
+
+// Read requests, one per line, from standard input until it's closed and
+// run them on a thread pool.  Plugins loaded by one request stay loaded
+// for the requests that follow.
+int ServeKernel::execute()
+{
+    ThreadPool pool(m_threads);
+
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        Utils::trim(line);
+        if (line.size())
+            pool.add(std::bind(&ServeKernel::serve, this, line));
+    }
+    pool.await();
+    return 0;
+}
+
+
+// Run a request and write its response.  Errors are reported in the
+// response rather than stopping the server.  Requests run concurrently, so
+// each logs to its own stream, which is written out with its response.
+void ServeKernel::serve(const std::string& line)
+{
+    Json::Value request;
+    Json::Value response;
+    std::ostringstream logStream;
+    LogPtr log(new Log(m_log->leader(), &logStream));
+    log->setLevel(m_log->getLevel());
+
+    try
+    {
+        Json::Reader reader;
+        if (!reader.parse(line, request) || !request.isObject())
+            throw pdal_error("Unable to parse request as a JSON object.");
+        response["id"] = request.get("id", Json::Value());
+        run(request, response, log);
+    }
+    catch (const std::exception& err)
+    {
+        response["error"] = err.what();
+    }
+    respond(response, logStream.str());
+}
+
+
+void ServeKernel::run(const Json::Value& request, Json::Value& response,
+    LogPtr log)
+{
+    PipelineManager manager;
+    manager.setLog(log);
+    manager.commonOptions() = m_manager.commonOptions();
+    manager.stageOptions() = m_manager.stageOptions();
+
+    const Json::Value& pipeline = request["pipeline"];
+    if (pipeline.isString())
+        manager.readPipeline(pipeline.asString());
+    else if (pipeline.isObject() || pipeline.isArray())
+    {
+        Json::FastWriter w;
+        std::istringstream in(w.write(pipeline));
+        manager.readPipeline(in);
+    }
+    else
+        throw pdal_error("Request has no pipeline.");
+
+    if (manager.pipelineStreamable())
+    {
+        FixedPointTable table(10000);
+        manager.executeStream(table);
+    }
+    else
+        response["num_points"] = (Json::Value::UInt64)manager.execute();
+
+    Json::Reader reader;
+    Json::Value metadata;
+    reader.parse(Utils::toJSON(manager.getMetadata()), metadata);
+    response["metadata"] = metadata;
+}
+
+
+// Write a response as a single line, after anything logged while running
+// its request.  Responses are written as requests finish, which needn't be
+// the order in which they were received.
+void ServeKernel::respond(const Json::Value& response,
+    const std::string& logText)
+{
+    Json::FastWriter w;
+    std::string s = w.write(response);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (logText.size())
+        *m_log->getLogStream() << logText << std::flush;
+    std::cout << s << std::flush;
+}
+
+} // namespace pdal
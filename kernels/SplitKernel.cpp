@@ -35,6 +35,7 @@
 #include "SplitKernel.hpp"
 
 #include <io/BufferReader.hpp>
+#include <pdal/FlexWriter.hpp>
 #include <pdal/StageFactory.hpp>
 
 namespace pdal
@@ -65,6 +66,8 @@ void SplitKernel::addSwitches(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("origin_y", "Origin in Y axis for splitter cells", m_yOrigin,
         std::numeric_limits<double>::quiet_NaN());
+    args.add("threads", "Number of output files to write concurrently "
+        "(0 uses all available hardware threads)", m_threads, (size_t)1);
 }
 
 
@@ -87,13 +90,13 @@ void SplitKernel::validateSwitches(ProgramArgs& args)
 
 namespace
 {
-std::string makeFilename(const std::string& s, int i)
+std::string makeFilename(const std::string& s, const std::string& id)
 {
     std::string out = s;
     auto pos = out.find_last_of('.');
     if (pos == out.npos)
         pos = out.length();
-    out.insert(pos, std::string("_") + std::to_string(i));
+    out.insert(pos, std::string("_") + id);
     return out;
 }
 }
@@ -121,13 +124,38 @@ int SplitKernel::execute()
     f.prepare(table);
     PointViewSet pvSet = f.execute(table);
 
+    // Writers that support filename templates write all the output files
+    // from one stage, which can write the files concurrently.  The template
+    // numbers files in view order, the same as the loop below.
+    if (m_outputFile.find('#') == std::string::npos)
+    {
+        BufferReader reader;
+        for (auto& pvp : pvSet)
+            reader.addView(pvp);
+
+        Stage& writer = makeWriter(makeFilename(m_outputFile, "#"), reader,
+            "");
+        if (dynamic_cast<FlexWriter *>(&writer))
+        {
+            Options options;
+            options.add("file_threads", m_threads);
+            writer.removeOptions(options);
+            writer.addOptions(options);
+
+            writer.prepare(table);
+            writer.execute(table);
+            return 0;
+        }
+    }
+
     int filenum = 1;
     for (auto& pvp : pvSet)
     {
         BufferReader reader;
         reader.addView(pvp);
 
-        std::string filename = makeFilename(m_outputFile, filenum++);
+        std::string filename = makeFilename(m_outputFile,
+            std::to_string(filenum++));
         Stage& writer = makeWriter(filename, reader, "");
 
         writer.prepare(table);
@@ -34,12 +34,17 @@
 
 #include "TIndexKernel.hpp"
 
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "../io/LasWriter.hpp"
 
@@ -82,6 +87,10 @@ TIndexKernel::TIndexKernel()
     , m_layer(NULL)
     , m_fastBoundary(false)
     , m_overrideASrs(false)
+    , m_threads(0)
+    , m_batchSize(1000)
+    , m_batchCount(0)
+    , m_inTransaction(false)
 {}
 
 
@@ -111,6 +120,10 @@ void TIndexKernel::addSwitches(ProgramArgs& args)
         m_merge);
     args.add("stdin,s", "Read filespec pattern from standard input",
         m_usestdin);
+    args.add("threads", "Number of files to scan concurrently "
+        "(0 uses all available hardware threads)", m_threads, (size_t)0);
+    args.add("batch_size", "Number of index entries to write per "
+        "transaction", m_batchSize, (size_t)1000);
 }
 
 
@@ -130,6 +143,8 @@ void TIndexKernel::validateSwitches(ProgramArgs& args)
         invalidArgs.push_back("src_srs_name");
         invalidArgs.push_back("stdin");
         invalidArgs.push_back("fast_boundary");
+        invalidArgs.push_back("threads");
+        invalidArgs.push_back("batch_size");
         for (auto arg : invalidArgs)
             if (args.set(arg))
             {
@@ -154,6 +169,8 @@ void TIndexKernel::validateSwitches(ProgramArgs& args)
                 "index.");
         if (args.set("a_srs"))
             m_overrideASrs = true;
+        if (m_batchSize == 0)
+            throw pdal_error("'batch_size' must be greater than 0.");
     }
 }
 
@@ -193,30 +210,42 @@ StringList readSTDIN()
 }
 
 
-bool TIndexKernel::isFileIndexed(const FieldIndexes& indexes,
-    const FileInfo& fileInfo)
+// Read the names of all files in the index at once so that checking
+// whether a file needs to be scanned doesn't require a query per file.
+std::set<std::string> TIndexKernel::indexedFiles(const FieldIndexes& indexes)
 {
-    std::ostringstream qstring;
+    std::set<std::string> files;
 
-    qstring << Utils::toupper(m_tileIndexColumnName) << "=" <<
-        "'" << fileInfo.m_filename << "'";
-    std::string query = qstring.str();
-    OGRErr err = OGR_L_SetAttributeFilter(m_layer, query.c_str());
-    if (err != OGRERR_NONE)
+    OGR_L_ResetReading(m_layer);
+    while (true)
     {
-        std::ostringstream oss;
-        oss << "Unable to set attribute filter for file '" <<
-             fileInfo.m_filename << "'";
-        throw pdal_error(oss.str());
+        OGRFeatureH feature = OGR_L_GetNextFeature(m_layer);
+        if (!feature)
+            break;
+        files.insert(OGR_F_GetFieldAsString(feature, indexes.m_filename));
+        OGR_F_Destroy(feature);
     }
-
-    bool output(false);
-    OGR_L_ResetReading(m_layer);
-    if (OGR_L_GetNextFeature(m_layer))
-        output = true;
     OGR_L_ResetReading(m_layer);
-    OGR_L_SetAttributeFilter(m_layer, NULL);
-    return output;
+    return files;
+}
+
+
+// Drivers that don't support transactions write each feature as it's
+// created.
+void TIndexKernel::startBatch()
+{
+    m_inTransaction = (OGR_L_StartTransaction(m_layer) == OGRERR_NONE);
+    m_batchCount = 0;
+}
+
+
+void TIndexKernel::commitBatch()
+{
+    if (m_inTransaction && OGR_L_CommitTransaction(m_layer) != OGRERR_NONE)
+        throw pdal_error("Unable to write entries to tile index '" +
+            m_idxFilename + "'.");
+    m_inTransaction = false;
+    m_batchCount = 0;
 }
 
 
@@ -264,27 +293,109 @@ void TIndexKernel::createFile()
         }
 
     FieldIndexes indexes = getFields();
+    std::set<std::string> indexed = indexedFiles(indexes);
 
     size_t filecount(0);
-    StageFactory factory(false);
+    StringList files;
     for (auto f : m_files)
     {
         //ABELL - Not sure why we need to get absolute path here.
         f = FileUtils::toAbsolutePath(f);
-        FileInfo info;
-        if (getFileInfo(factory, f, info))
+        if (indexed.count(f))
         {
             filecount++;
-            if (!isFileIndexed(indexes, info))
+            m_log->get(LogLevel::Debug) << "Skipping indexed file " << f <<
+                std::endl;
+        }
+        else
+            files.push_back(f);
+    }
+
+    // Files are scanned on the pool and the results are written to the
+    // index by this thread in file order.  Only a window of files is
+    // scanned ahead of the writer to bound memory use.
+    struct Scan
+    {
+        Scan() : m_done(false), m_ok(false)
+        {}
+
+        bool m_done;
+        bool m_ok;
+        FileInfo m_info;
+        std::exception_ptr m_error;
+    };
+
+    std::vector<Scan> scans(files.size());
+    std::mutex mutex;
+    std::condition_variable done;
+    ThreadPool pool(m_threads);
+    const size_t window = 4 * pool.numThreads();
+    size_t next = 0;
+
+    auto scan = [this, &files, &scans, &mutex, &done](size_t i)
+    {
+        Scan s;
+        try
+        {
+            s.m_ok = getFileInfo(files[i], s.m_info);
+        }
+        catch (...)
+        {
+            s.m_error = std::current_exception();
+        }
+        s.m_done = true;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        scans[i] = std::move(s);
+        done.notify_all();
+    };
+
+    try
+    {
+        startBatch();
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            for (; next < files.size() && next < i + window; ++next)
+                pool.add(std::bind(scan, next));
+
+            Scan s;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [&scans, i](){ return scans[i].m_done; });
+                s = std::move(scans[i]);
+            }
+            if (s.m_error)
+                std::rethrow_exception(s.m_error);
+
+            const std::string& f = files[i];
+            if (!s.m_ok)
             {
-                if (createFeature(indexes, info))
-                    m_log->get(LogLevel::Info) << "Indexed file " << f <<
+                m_log->get(LogLevel::Error) << "Skipping file '" << f <<
+                    "': can't compute boundary." << std::endl;
+                continue;
+            }
+            filecount++;
+            if (createFeature(indexes, s.m_info))
+                m_log->get(LogLevel::Info) << "Indexed file " << f <<
                     std::endl;
-                else
-                    m_log->get(LogLevel::Error) << "Failed to create feature "
-                        "for file '" << f << "'" << std::endl;
+            else
+                m_log->get(LogLevel::Error) << "Failed to create feature "
+                    "for file '" << f << "'" << std::endl;
+            if (++m_batchCount == m_batchSize)
+            {
+                commitBatch();
+                startBatch();
             }
         }
+        commitBatch();
+    }
+    catch (...)
+    {
+        // Keep what has been indexed so that a rerun can skip it.
+        if (m_inTransaction)
+            OGR_L_CommitTransaction(m_layer);
+        m_inTransaction = false;
+        throw;
     }
     if (!filecount)
         throw pdal_error("Couldn't index any files.");
@@ -526,8 +637,9 @@ bool TIndexKernel::slowBoundary(Stage& hexer, FileInfo& fileInfo)
 }
 
 
-bool TIndexKernel::getFileInfo(StageFactory& factory,
-    const std::string& filename, FileInfo& fileInfo)
+// Called concurrently for different files.  Don't log here.
+bool TIndexKernel::getFileInfo(const std::string& filename,
+    FileInfo& fileInfo)
 {
     PipelineManager manager;
     manager.commonOptions() = m_manager.commonOptions();
@@ -552,11 +664,7 @@ bool TIndexKernel::getFileInfo(StageFactory& factory,
         fast = true;
     }
     if (fast && !fastBoundary(reader, fileInfo))
-    {
-        m_log->get(LogLevel::Error) << "Skipping file '" << filename <<
-            "': can't compute boundary." << std::endl;
         return false;
-    }
     FileUtils::fileTimes(filename, &fileInfo.m_ctime, &fileInfo.m_mtime);
     fileInfo.m_filename = filename;
 
@@ -676,14 +784,6 @@ TIndexKernel::FieldIndexes TIndexKernel::getFields()
     indexes.m_ctime = OGR_FD_GetFieldIndex(fDefn, "created");
     indexes.m_mtime = OGR_FD_GetFieldIndex(fDefn, "modified");
 
-//     /* Load in memory existing file names in SHP */
-//     int nExistingFiles = (int)OGR_L_GetFeatureCount(m_layer, FALSE);
-//     for (auto i = 0; i < nExistingFiles; i++)
-//     {
-//         OGRFeatureH hFeature = OGR_L_GetNextFeature(m_layer);
-//         m_files.push_back(OGR_F_GetFieldAsString(hFeature, indexes.m_filename));
-//         OGR_F_Destroy(hFeature);
-//     }
     return indexes;
 }
 
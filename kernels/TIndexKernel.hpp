@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <set>
+
 #include <pdal/GDALUtils.hpp>
 #include <pdal/Kernel.hpp>
 #include <pdal/Stage.hpp>
@@ -42,8 +44,6 @@
 namespace pdal
 {
 
-class StageFactory;
-
 class PDAL_DLL TIndexKernel : public Kernel
 {
     struct FileInfo
@@ -79,8 +79,7 @@ private:
     bool openLayer(const std::string& layerName);
     bool createLayer(const std::string& layerName);
     FieldIndexes getFields();
-    bool getFileInfo(StageFactory& factory, const std::string& filename,
-        FileInfo& info);
+    bool getFileInfo(const std::string& filename, FileInfo& info);
     bool createFeature(const FieldIndexes& indexes, FileInfo& info);
     gdal::Geometry prepareGeometry(const FileInfo& fileInfo);
     gdal::Geometry prepareGeometry(const std::string& wkt,
@@ -89,7 +88,9 @@ private:
     bool fastBoundary(Stage& reader, FileInfo& fileInfo);
     bool slowBoundary(Stage& hexer, FileInfo& fileInfo);
 
-    bool isFileIndexed( const FieldIndexes& indexes, const FileInfo& fileInfo);
+    std::set<std::string> indexedFiles(const FieldIndexes& indexes);
+    void startBatch();
+    void commitBatch();
 
     std::string m_idxFilename;
     std::string m_filespec;
@@ -110,6 +111,10 @@ private:
     bool m_fastBoundary;
     bool m_usestdin;
     bool m_overrideASrs;
+    size_t m_threads;
+    size_t m_batchSize;
+    size_t m_batchCount;
+    bool m_inTransaction;
 };
 
 } // namespace pdal
@@ -0,0 +1,201 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <set>
+#include <sstream>
+
+#include <pdal/FlexWriter.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/StageFactory.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Reader that provides an existing view to the stage that follows.
+class ViewReader : public Reader
+{
+public:
+    ViewReader() : Reader()
+        {}
+    void setView(const PointViewPtr& view)
+        { m_view = view; }
+    std::string getName() const { return "readers.view"; }
+
+private:
+    PointViewPtr m_view;
+
+    virtual PointViewSet run(PointViewPtr /*view*/)
+    {
+        PointViewSet viewSet;
+        viewSet.insert(m_view);
+        return viewSet;
+    }
+};
+
+} // unnamed namespace
+
+
+void FlexWriter::writerAddArgs(ProgramArgs& args)
+{
+    args.add("file_threads", "Number of files to write concurrently when the "
+        "filename is a template (0 uses all available hardware threads)",
+        m_threads, (size_t)1);
+}
+
+
+// Write a view to its own file with a new instance of this writer.  The
+// view's points are copied into a table private to the instance so that
+// instances don't share table state.  The instance logs to a buffer, and
+// the log and the metadata that the instance adds while writing are saved
+// so that they can be passed to this writer in file order.
+void FlexWriter::writeClone(PointViewPtr view, const std::string& filename,
+    size_t filenum)
+{
+    std::ostringstream logStream;
+    LogPtr l(new Log(m_cloneLeader, &logStream));
+    l->setLevel(log()->getLevel());
+
+    MetadataNodeList nodes;
+    try
+    {
+        nodes = runClone(view, filename, l);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_clones[filenum].m_log = logStream.str();
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Clone& clone = m_clones[filenum];
+    clone.m_log = logStream.str();
+    clone.m_metadata = nodes;
+}
+
+
+MetadataNodeList FlexWriter::runClone(PointViewPtr view,
+    const std::string& filename, LogPtr log)
+{
+    StageFactory factory;
+    ViewReader reader;
+    PointTable table;
+    Stage *writer;
+
+    {
+        // Preparing a stage sets up logging and touches the source table's
+        // metadata, so only one instance is prepared at a time.
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        writer = factory.createStage(getName());
+        if (!writer)
+            throwError("Unable to create writer for '" + filename + "'.");
+        Options opts(m_options);
+        opts.replace("filename", filename);
+        opts.replace("file_threads", 1);
+        opts.remove(Option("log", ""));
+        writer->setOptions(opts);
+        writer->setLog(log);
+        writer->setInput(reader);
+
+        table.copyMetadata(*m_table);
+        PointLayoutPtr layout = table.layout();
+        PointLayoutPtr srcLayout = view->layout();
+        for (const DimType& dt : srcLayout->dimTypes())
+            layout->registerOrAssignDim(srcLayout->dimName(dt.m_id),
+                dt.m_type);
+        writer->prepare(table);
+    }
+
+    struct DimMap
+    {
+        Dimension::Id m_src;
+        Dimension::Id m_dst;
+        Dimension::Type m_type;
+    };
+
+    PointLayoutPtr layout = table.layout();
+    PointLayoutPtr srcLayout = view->layout();
+    std::vector<DimMap> dims;
+    for (const DimType& dt : srcLayout->dimTypes())
+    {
+        Dimension::Id dst = layout->findDim(srcLayout->dimName(dt.m_id));
+        dims.push_back({ dt.m_id, dst, dt.m_type });
+    }
+
+    PointViewPtr copy(new PointView(table, view->spatialReference()));
+    for (PointId idx = 0; idx < view->size(); ++idx)
+        for (const DimMap& d : dims)
+        {
+            Everything e;
+            view->getField((char *)&e, d.m_src, d.m_type, idx);
+            copy->setField(d.m_dst, d.m_type, idx, &e);
+        }
+
+    // Only keep the metadata added by writing, not that set in prepare().
+    std::set<std::string> prepared;
+    for (MetadataNode& m : writer->getMetadata().children())
+        prepared.insert(m.name());
+
+    reader.setView(copy);
+    writer->execute(table);
+
+    MetadataNodeList nodes;
+    for (MetadataNode& m : writer->getMetadata().children())
+        if (prepared.find(m.name()) == prepared.end())
+            nodes.push_back(m);
+    return nodes;
+}
+
+
+// Pass the logs and metadata of the instances that wrote files to this
+// writer in file order, as if the files had been written serially.
+void FlexWriter::mergeClones()
+{
+    MetadataNode m = getMetadata();
+    for (auto& entry : m_clones)
+    {
+        Clone& clone = entry.second;
+        if (clone.m_log.size())
+            *log()->getLogStream() << clone.m_log << std::flush;
+        for (MetadataNode& node : clone.m_metadata)
+            m.add(node);
+    }
+    m_clones.clear();
+}
+
+} // namespace pdal
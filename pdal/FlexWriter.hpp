@@ -33,9 +33,14 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/Scaling.hpp>
 #include <pdal/Writer.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -43,7 +48,8 @@ namespace pdal
 class PDAL_DLL FlexWriter : public Writer
 {
 protected:
-    FlexWriter() : m_filenum(1)
+    FlexWriter() : m_hashPos(std::string::npos), m_threads(1),
+        m_table(nullptr), m_filenum(1)
     {}
 
     std::string m_filename;
@@ -63,6 +69,27 @@ protected:
 
 private:
     std::string::size_type m_hashPos;
+    size_t m_threads;
+    std::mutex m_mutex;
+    BasePointTable *m_table;
+    std::unique_ptr<ThreadPool> m_pool;
+
+    // What an instance of this writer writing a file on the thread pool
+    // leaves for this writer.
+    struct Clone
+    {
+        std::string m_log;
+        MetadataNodeList m_metadata;
+    };
+    std::map<size_t, Clone> m_clones;
+    std::string m_cloneLeader;
+
+    virtual void writerAddArgs(ProgramArgs& args);
+    void writeClone(PointViewPtr view, const std::string& filename,
+        size_t filenum);
+    MetadataNodeList runClone(PointViewPtr view,
+        const std::string& filename, LogPtr log);
+    void mergeClones();
 
     virtual void writerInitialize(PointTableRef table)
     {
@@ -87,6 +114,18 @@ private:
     virtual void ready(PointTableRef table) final
     {
         readyTable(table);
+        if (m_hashPos != std::string::npos && m_threads != 1)
+        {
+            m_pool.reset(new ThreadPool(m_threads));
+            m_table = &table;
+
+            // Instances add the stage name to the leader of their log.
+            m_cloneLeader = log()->leader();
+            std::string::size_type pos = m_cloneLeader.rfind(getName());
+            if (pos != std::string::npos)
+                m_cloneLeader.erase(pos);
+            Utils::trimTrailing(m_cloneLeader);
+        }
         if (m_hashPos == std::string::npos)
         {
             if (!table.spatialReferenceUnique())
@@ -101,13 +140,23 @@ private:
     // that they get executed once for each view.  The check for m_hashPos
     // is a test to see if the filename specification is a template.  If it's
     // not a template, ready() and done() are taken care of in the ready()
-    // and done() functions in this class.
+    // and done() functions in this class.  When writing with more than one
+    // thread, each view is written by its own copy of this writer on the
+    // thread pool.
     virtual void write(const PointViewPtr view) final
     {
         if (m_hashPos != std::string::npos)
         {
             if (view->size() == 0)
                 return;
+            if (m_pool)
+            {
+                size_t filenum = m_filenum;
+                std::string filename = generateFilename();
+                m_pool->add([this, view, filename, filenum]()
+                    { writeClone(view, filename, filenum); });
+                return;
+            }
             readyFile(generateFilename(), view->spatialReference());
         }
         writeView(view);
@@ -117,6 +166,20 @@ private:
 
     virtual void done(PointTableRef table) final
     {
+        if (m_pool)
+        {
+            std::unique_ptr<ThreadPool> pool(std::move(m_pool));
+            try
+            {
+                pool->await();
+            }
+            catch (...)
+            {
+                mergeClones();
+                throw;
+            }
+            mergeClones();
+        }
         if (m_hashPos == std::string::npos)
             doneFile();
         doneTable(table);
@@ -355,6 +355,16 @@ public:
         return radius(x, y, z, r);
     }
 
+    // Search with a caller-provided nanoflann result set, which controls
+    // which points are kept and when the search can stop.  Safe to call
+    // from multiple threads once the index is built.
+    template<typename ResultSet>
+    void search(ResultSet& results, double x, double y, double z) const
+    {
+        double pt[3] = { x, y, z };
+        m_index->findNeighbors(results, pt, nanoflann::SearchParams());
+    }
+
 };
 
 template<>
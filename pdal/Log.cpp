@@ -37,14 +37,48 @@
 
 #include <fstream>
 #include <ostream>
+#include <sstream>
 
 namespace pdal
 {
 
+// Stream that collects a thread's log messages and writes them to the log
+// when flushed.
+class Log::MessageStream : public std::ostream
+{
+public:
+    MessageStream(Log& log) : std::ostream(nullptr), m_buf(log)
+        { rdbuf(&m_buf); }
+
+private:
+    class Buf : public std::stringbuf
+    {
+    public:
+        Buf(Log& log) : m_log(log)
+        {}
+
+    protected:
+        virtual int sync()
+        {
+            m_log.write(str());
+            str("");
+            return 0;
+        }
+
+    private:
+        Log& m_log;
+    };
+
+    Buf m_buf;
+};
+
+
 Log::Log(std::string const& leaderString,
          std::string const& outputName)
     : m_level(LogLevel::Warning)
     , m_deleteStreamOnCleanup(false)
+    , m_concurrent(false)
+    , m_baseLeader(leaderString)
 {
 
     if (Utils::iequals(outputName, "stdlog"))
@@ -60,7 +94,6 @@ Log::Log(std::string const& leaderString,
         m_log = Utils::createFile(outputName);
         m_deleteStreamOnCleanup = true;
     }
-    m_leaders.push(leaderString);
 }
 
 
@@ -68,15 +101,16 @@ Log::Log(std::string const& leaderString,
          std::ostream* v)
     : m_level(LogLevel::Error)
     , m_deleteStreamOnCleanup(false)
+    , m_concurrent(false)
+    , m_baseLeader(leaderString)
 {
     m_log = v;
-    m_leaders.push(leaderString);
 }
 
 
 Log::~Log()
 {
-
+    setConcurrent(false);
     if (m_deleteStreamOnCleanup)
     {
         m_log->flush();
@@ -87,15 +121,60 @@ Log::~Log()
 
 void Log::floatPrecision(int level)
 {
-    m_log->setf(std::ios_base::fixed, std::ios_base::floatfield);
-    m_log->precision(level);
+    std::ostream& out = stream();
+    out.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    out.precision(level);
 }
 
 
 void Log::clearFloat()
 {
-    m_log->unsetf(std::ios_base::fixed);
-    m_log->unsetf(std::ios_base::floatfield);
+    std::ostream& out = stream();
+    out.unsetf(std::ios_base::fixed);
+    out.unsetf(std::ios_base::floatfield);
+}
+
+
+void Log::setConcurrent(bool concurrent)
+{
+    if (!concurrent)
+    {
+        for (auto& s : m_streams)
+            s.second->flush();
+        m_streams.clear();
+    }
+    m_concurrent = concurrent;
+}
+
+
+// Return the stream to which the calling thread writes messages.
+std::ostream& Log::stream()
+{
+    if (!m_concurrent)
+        return *m_log;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_ptr<MessageStream>& s = m_streams[std::this_thread::get_id()];
+    if (!s)
+    {
+        s.reset(new MessageStream(*this));
+        s->copyfmt(*m_log);
+    }
+    return *s;
+}
+
+
+// Write collected message text to the log stream.  Different logs may
+// share a stream, such as std::clog, so all writes are serialized.
+void Log::write(const std::string& text)
+{
+    static std::mutex writeMutex;
+
+    if (text.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    *m_log << text << std::flush;
 }
 
 
@@ -107,14 +186,18 @@ std::ostream& Log::get(LogLevel level)
     if (incoming <= stored)
     {
         const std::string l = leader();
+        std::ostream& out = stream();
 
-        *m_log << "(" << l;
+        // Write out any unflushed text from a previous message first.
+        if (m_concurrent)
+            out.flush();
+        out << "(" << l;
          if (l.size())
-             *m_log << " ";
-         *m_log << getLevelString(level) <<") " <<
+             out << " ";
+         out << getLevelString(level) <<") " <<
          std::string(incoming < nativeDebug ? 0 : incoming - nativeDebug,
              '\t');
-        return *m_log;
+        return out;
     }
     return m_nullStream;
 }
@@ -35,8 +35,11 @@
 #pragma once
 
 #include <cassert>
+#include <map>
 #include <memory> // shared_ptr
+#include <mutex>
 #include <stack>
+#include <thread>
 
 #include <pdal/pdal_internal.hpp>
 #include <pdal/util/NullOStream.hpp>
@@ -91,21 +94,36 @@ public:
     void setLeader(const std::string& leader)
         { pushLeader(leader); }
 
-    /// Push the leader string onto the stack.
+    /// Push the leader string onto the stack.  Each thread has its own
+    /// stack, so that stages running concurrently on the same log don't
+    /// see each other's leaders.
     /// \param  leader  Leader string
     void pushLeader(const std::string& leader)
-        { m_leaders.push(leader); }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_leaders[std::this_thread::get_id()].push(leader);
+    }
 
     /// Get the leader string.
-    /// \return  The current leader string.
+    /// \return  The current leader string of the calling thread, or the
+    ///    leader provided on construction if none has been pushed.
     std::string leader() const
-        { return m_leaders.empty() ? std::string() : m_leaders.top(); }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_leaders.find(std::this_thread::get_id());
+        return it == m_leaders.end() ? m_baseLeader : it->second.top();
+    }
 
-    /// Pop the current leader string.
+    /// Pop the calling thread's current leader string.
     void popLeader()
     {
-        if (!m_leaders.empty())
-            m_leaders.pop();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_leaders.find(std::this_thread::get_id());
+        if (it == m_leaders.end())
+            return;
+        it->second.pop();
+        if (it->second.empty())
+            m_leaders.erase(it);
     }
 
     /// @return A string representing the LogLevel
@@ -132,16 +150,32 @@ public:
     /// Clears the floating point precision settings of the streams
     void clearFloat();
 
+    /// Set whether the log is written by more than one thread at a time.
+    /// While it is, each thread's messages are collected separately and
+    /// written whole when flushed, so that they aren't interleaved.  Must
+    /// not be called while other threads are logging.
+    /// @param concurrent  Whether the log is written concurrently.
+    void setConcurrent(bool concurrent);
+
 protected:
     std::ostream *m_log;
 
 private:
+    class MessageStream;
+
     Log(const Log&);
     Log& operator =(const Log&);
 
+    std::ostream& stream();
+    void write(const std::string& text);
+
     LogLevel m_level;
     bool m_deleteStreamOnCleanup;
-    std::stack<std::string> m_leaders;
+    bool m_concurrent;
+    std::map<std::thread::id, std::unique_ptr<MessageStream>> m_streams;
+    std::string m_baseLeader;
+    std::map<std::thread::id, std::stack<std::string>> m_leaders;
+    mutable std::mutex m_mutex;
     NullOStream m_nullStream;
 };
 
@@ -35,6 +35,8 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/pdal_features.hpp>
 
+#include <mutex>
+
 #ifdef PDAL_ARBITER_ENABLED
     #include <arbiter/arbiter.hpp>
 #endif
@@ -44,6 +46,8 @@
 #include <pdal/PointView.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Rangebuf.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 using namespace std;
 
@@ -248,6 +252,21 @@ private:
     TempFile m_localFile;
 };
 
+// Stream that reads a remote file by fetching only the byte ranges that
+// are read.
+class RangeInStream : public std::istream
+{
+public:
+    RangeInStream(uint64_t size, Rangebuf::Fetch fetch) :
+        std::istream(nullptr), m_buf(size, fetch)
+    {
+        rdbuf(&m_buf);
+    }
+
+private:
+    Rangebuf m_buf;
+};
+
 }  // unnamed namespace
 
 /**
@@ -314,6 +333,48 @@ std::istream *openFile(const std::string& path, bool asBinary)
     return FileUtils::openFile(path, asBinary);
 }
 
+/**
+  Open a file (potentially on a remote filesystem) for random access.
+  Files on HTTP-based remote filesystems (HTTP, S3, Google Storage, ...)
+  aren't downloaded.  Only the byte ranges that are read are fetched.
+  Other files are opened as with openFile().
+
+  \param path  Path (potentially remote) of file to open.
+  \return  Pointer to stream opened for binary input.
+*/
+std::istream *openRangeFile(const std::string& path)
+{
+#ifdef PDAL_ARBITER_ENABLED
+    arbiter::Arbiter a;
+    if (a.hasDriver(path) && a.isRemote(path) && a.isHttpDerived(path))
+    {
+        try
+        {
+            std::unique_ptr<std::size_t> size = a.tryGetSize(path);
+            if (!size)
+                return nullptr;
+
+            auto fetch = [path](uint64_t offset, uint64_t count)
+            {
+                arbiter::Arbiter a;
+                if (count == 0)
+                    return std::vector<char>();
+                arbiter::http::Headers headers;
+                headers["Range"] = "bytes=" + std::to_string(offset) + "-" +
+                    std::to_string(offset + count - 1);
+                return a.getBinary(path, headers);
+            };
+            return new RangeInStream(*size, fetch);
+        }
+        catch (arbiter::ArbiterError)
+        {
+            return nullptr;
+        }
+    }
+#endif
+    return openFile(path, true);
+}
+
 /**
   Close an output stream.
 
@@ -332,7 +393,10 @@ void closeFile(std::ostream *out)
 */
 void closeFile(std::istream *in)
 {
-    FileUtils::closeFile(in);
+    if (dynamic_cast<RangeInStream *>(in))
+        delete in;
+    else
+        FileUtils::closeFile(in);
 }
 
 
@@ -356,45 +420,147 @@ bool fileExists(const std::string& path)
     return FileUtils::fileExists(path);
 }
 
-double computeHausdorff(PointViewPtr srcView, PointViewPtr candView)
+namespace
+{
+
+// Nearest-neighbor result set that stops the search once a neighbor no
+// farther than the cutoff has been found.  Such a point can't raise a
+// running maximum distance, so its exact distance isn't needed.  A
+// negative cutoff gives an exact nearest neighbor.
+class CutoffResultSet
+{
+public:
+    CutoffResultSet(double cutoff) : m_cutoff(cutoff),
+        m_dist((std::numeric_limits<double>::max)()), m_index(0)
+    {}
+
+    bool full() const
+        { return true; }
+    void addPoint(double dist, std::size_t index)
+    {
+        if (dist < m_dist)
+        {
+            m_dist = dist;
+            m_index = index;
+        }
+    }
+    // Returning a negative distance rejects every remaining point and
+    // tree node, which ends the search.
+    double worstDist() const
+        { return done() ? -1.0 : m_dist; }
+    bool done() const
+        { return m_dist <= m_cutoff; }
+    double dist() const
+        { return m_dist; }
+    std::size_t index() const
+        { return m_index; }
+
+private:
+    double m_cutoff;
+    double m_dist;
+    std::size_t m_index;
+};
+
+} // unnamed namespace
+
+
+double computeDirectedHausdorff(PointViewPtr srcView, PointViewPtr candView,
+    double percentile, size_t threads)
 {
     using namespace Dimension;
 
-    KD3Index srcIndex(*srcView);
-    srcIndex.build();
+    if (percentile <= 0 || percentile > 100)
+        throw pdal_error("Hausdorff percentile must be greater than 0 and "
+            "no more than 100.");
+    if (srcView->empty())
+        return 0;
+    if (candView->empty())
+        throw pdal_error("Can't compute Hausdorff distance to an empty "
+            "point set.");
 
     KD3Index candIndex(*candView);
     candIndex.build();
 
-    double maxDistSrcToCand = std::numeric_limits<double>::lowest();
-    double maxDistCandToSrc = std::numeric_limits<double>::lowest();
-
-    for (PointId i = 0; i < srcView->size(); ++i)
+    // With the maximum, each point only needs to be searched until it's
+    // known not to raise the running maximum.  A percentile needs every
+    // exact distance.
+    const bool exact = (percentile < 100);
+    std::vector<double> sqrDists(exact ? srcView->size() : 0);
+    double maxSqrDist = 0;
+    std::mutex mutex;
+
+    const point_count_t chunkSize = 65536;
+    ThreadPool pool(threads);
+    for (PointId begin = 0; begin < srcView->size(); begin += chunkSize)
     {
-        std::vector<PointId> indices(1);
-        std::vector<double> sqr_dists(1);
-        PointRef srcPoint = srcView->point(i);
-        candIndex.knnSearch(srcPoint, 1, &indices, &sqr_dists);
-
-        if (sqr_dists[0] > maxDistSrcToCand)
-            maxDistSrcToCand = sqr_dists[0];
+        PointId end = (std::min)(begin + chunkSize, srcView->size());
+        pool.add([&, begin, end]()
+        {
+            double localMax;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                localMax = maxSqrDist;
+            }
+
+            // The nearest candidate of the previous point is usually close
+            // to the current point as well, so its distance is tried first.
+            bool seeded = false;
+            std::size_t seed = 0;
+            for (PointId i = begin; i < end; ++i)
+            {
+                double x = srcView->getFieldAs<double>(Id::X, i);
+                double y = srcView->getFieldAs<double>(Id::Y, i);
+                double z = srcView->getFieldAs<double>(Id::Z, i);
+
+                CutoffResultSet results(exact ? -1.0 : localMax);
+                if (seeded)
+                {
+                    double dx = x - candView->getFieldAs<double>(Id::X, seed);
+                    double dy = y - candView->getFieldAs<double>(Id::Y, seed);
+                    double dz = z - candView->getFieldAs<double>(Id::Z, seed);
+                    results.addPoint(dx * dx + dy * dy + dz * dz, seed);
+                }
+                if (!results.done())
+                    candIndex.search(results, x, y, z);
+                seed = results.index();
+                seeded = true;
+
+                if (exact)
+                    sqrDists[i] = results.dist();
+                else
+                    localMax = (std::max)(localMax, results.dist());
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            maxSqrDist = (std::max)(maxSqrDist, localMax);
+        });
     }
+    pool.await();
 
-    for (PointId i = 0; i < candView->size(); ++i)
+    if (exact)
     {
-        std::vector<PointId> indices(1);
-        std::vector<double> sqr_dists(1);
-        PointRef candPoint = candView->point(i);
-        srcIndex.knnSearch(candPoint, 1, &indices, &sqr_dists);
-
-        if (sqr_dists[0] > maxDistCandToSrc)
-            maxDistCandToSrc = sqr_dists[0];
+        size_t rank = (size_t)std::ceil(percentile * sqrDists.size() / 100);
+        rank = (std::max)(rank, (size_t)1) - 1;
+        std::nth_element(sqrDists.begin(), sqrDists.begin() + rank,
+            sqrDists.end());
+        maxSqrDist = sqrDists[rank];
     }
+    return std::sqrt(maxSqrDist);
+}
+
 
-    maxDistSrcToCand = std::sqrt(maxDistSrcToCand);
-    maxDistCandToSrc = std::sqrt(maxDistCandToSrc);
+double computeHausdorff(PointViewPtr srcView, PointViewPtr candView,
+    double percentile, size_t threads)
+{
+    return (std::max)(
+        computeDirectedHausdorff(srcView, candView, percentile, threads),
+        computeDirectedHausdorff(candView, srcView, percentile, threads));
+}
 
-    return std::max(maxDistSrcToCand, maxDistCandToSrc);
+
+double computeHausdorff(PointViewPtr srcView, PointViewPtr candView)
+{
+    return computeHausdorff(srcView, candView, 100.0, 1);
 }
 
 } // namespace Utils
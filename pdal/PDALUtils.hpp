@@ -263,6 +263,7 @@ inline void writeProgress(int fd, const std::string& type,
 std::string PDAL_DLL toJSON(const MetadataNode& m);
 void PDAL_DLL toJSON(const MetadataNode& m, std::ostream& o);
 std::istream PDAL_DLL *openFile(const std::string& path, bool asBinary = true);
+std::istream PDAL_DLL *openRangeFile(const std::string& path);
 std::ostream PDAL_DLL *createFile(const std::string& path,
     bool asBinary = true);
 void PDAL_DLL closeFile(std::istream *in);
@@ -271,5 +272,12 @@ bool PDAL_DLL fileExists(const std::string& path);
 std::vector<std::string> PDAL_DLL maybeGlob(const std::string& path);
 double PDAL_DLL computeHausdorff(PointViewPtr srcView, PointViewPtr candView);
 
+// A percentile below 100 gives the partial Hausdorff distance, which
+// ignores the farthest points.  Zero threads uses all hardware threads.
+double PDAL_DLL computeHausdorff(PointViewPtr srcView, PointViewPtr candView,
+    double percentile, size_t threads);
+double PDAL_DLL computeDirectedHausdorff(PointViewPtr srcView,
+    PointViewPtr candView, double percentile = 100.0, size_t threads = 1);
+
 } // namespace Utils
 } // namespace pdal
@@ -38,6 +38,12 @@
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
 
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 
@@ -46,7 +52,7 @@ namespace pdal
 
 PipelineManager::PipelineManager() : m_factory(new StageFactory),
     m_tablePtr(new PointTable()), m_table(*m_tablePtr),
-    m_progressFd(-1), m_input(nullptr)
+    m_progressFd(-1), m_input(nullptr), m_threads(1)
 {}
 
 
@@ -204,7 +210,10 @@ point_count_t PipelineManager::execute()
     Stage *s = getStage();
     if (!s)
         return 0;
-    m_viewSet = s->execute(m_table);
+    if (m_threads == 1)
+        m_viewSet = s->execute(m_table);
+    else
+        m_viewSet = executeParallel(*s);
     point_count_t cnt = 0;
     for (auto pi = m_viewSet.begin(); pi != m_viewSet.end(); ++pi)
     {
@@ -215,6 +224,131 @@ point_count_t PipelineManager::execute()
 }
 
 
+// Run the stages feeding 'leaf', running stages whose inputs are complete
+// concurrently.  A stage runs as soon as all of its inputs have run, so
+// independent branches (the inputs of a merge, for instance) proceed in
+// parallel.  The result is the same as that of Stage::execute().
+PointViewSet PipelineManager::executeParallel(Stage& leaf)
+{
+    struct Node
+    {
+        Stage *m_consumer;  // The stage this stage feeds.
+        size_t m_position;  // Position of this stage in the consumer's inputs.
+        size_t m_pending;   // Number of inputs that haven't yet run.
+        std::vector<PointViewSet> m_inputs;
+        PointViewSet m_views;
+    };
+
+    std::map<Stage *, Node> nodes;
+    std::vector<Stage *> roots;
+    bool shared = false;
+    bool branched = false;
+
+    std::function<void(Stage *, Stage *, size_t)> visit =
+        [&](Stage *s, Stage *consumer, size_t position)
+    {
+        if (nodes.count(s))
+        {
+            shared = true;
+            return;
+        }
+        const std::vector<Stage *>& inputs = s->getInputs();
+        Node& node = nodes[s];
+        node.m_consumer = consumer;
+        node.m_position = position;
+        node.m_pending = inputs.size();
+        node.m_inputs.resize(inputs.size());
+        if (inputs.empty())
+            roots.push_back(s);
+        if (inputs.size() > 1)
+            branched = true;
+        for (size_t i = 0; i < inputs.size(); ++i)
+            visit(inputs[i], s, i);
+    };
+    visit(&leaf, nullptr, 0);
+
+    // A stage that feeds more than one stage is run once for each when run
+    // sequentially, so leave those pipelines, and those without independent
+    // branches, to Stage::execute().
+    if (shared || !branched)
+        return leaf.execute(m_table);
+
+    m_table.finalize();
+
+    ThreadPool pool(m_threads);
+    std::mutex mutex;
+    std::function<void(Stage *)> run = [&](Stage *s)
+    {
+        Node& node = nodes.at(s);
+
+        PointViewSet views;
+        if (node.m_inputs.empty())
+            views.insert(PointViewPtr(new PointView(m_table)));
+        else if (node.m_inputs.size() == 1)
+            views = std::move(node.m_inputs.front());
+        else
+        {
+            // Views from different branches were created in no particular
+            // order.  Renumber them so that they're ordered by input, as
+            // they would be when run sequentially.
+            for (PointViewSet& in : node.m_inputs)
+            {
+                std::vector<PointViewPtr> temp(in.begin(), in.end());
+                in.clear();
+                for (PointViewPtr& v : temp)
+                {
+                    v->renumber();
+                    views.insert(v);
+                }
+            }
+        }
+        node.m_views = s->execute(m_table, views);
+
+        Stage *consumer = node.m_consumer;
+        if (!consumer)
+            return;
+
+        bool ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Node& next = nodes.at(consumer);
+            next.m_inputs[node.m_position] = std::move(node.m_views);
+            ready = (--next.m_pending == 0);
+        }
+        if (ready)
+            pool.add([&run, consumer](){ run(consumer); });
+    };
+
+    // Stages on different threads can share a log, so have the logs
+    // collect each thread's messages and write them whole.
+    std::set<Log *> logs;
+    for (auto& n : nodes)
+        if (n.first->log())
+            logs.insert(n.first->log().get());
+    auto setConcurrent = [this, &logs](bool concurrent)
+    {
+        m_table.setConcurrent(concurrent);
+        for (Log *l : logs)
+            l->setConcurrent(concurrent);
+    };
+
+    setConcurrent(pool.numThreads() > 1);
+    for (Stage *s : roots)
+        pool.add([&run, s](){ run(s); });
+    try
+    {
+        pool.await();
+    }
+    catch (...)
+    {
+        setConcurrent(false);
+        throw;
+    }
+    setConcurrent(false);
+    return std::move(nodes.at(&leaf).m_views);
+}
+
+
 void PipelineManager::executeStream(FixedPointTable& table)
 {
     validateStageOptions();
@@ -112,6 +112,11 @@ public:
     void setLog(LogPtr& log)
         { m_log = log; }
 
+    // Set the number of threads used to run independent branches of
+    // the pipeline in execute().  Zero uses all hardware threads.
+    void setThreads(size_t threads)
+        { m_threads = threads; }
+
     QuickInfo preview() const;
     void prepare() const;
     point_count_t execute();
@@ -143,6 +148,7 @@ public:
 private:
     void setOptions(Stage& stage, const Options& addOps);
     Options stageOptions(Stage& stage);
+    PointViewSet executeParallel(Stage& leaf);
 
     std::unique_ptr<StageFactory> m_factory;
     std::unique_ptr<PointTable> m_tablePtr;
@@ -154,6 +160,7 @@ private:
     int m_progressFd;
     std::istream *m_input;
     LogPtr m_log;
+    size_t m_threads;
 
     PipelineManager& operator=(const PipelineManager&); // not implemented
     PipelineManager(const PipelineManager&); // not implemented
@@ -33,9 +33,16 @@
 ****************************************************************************/
 
 #include <pdal/PluginDirectory.hpp>
+#include <pdal/PluginManager.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/pdal_config.hpp>
 
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include <json/json.h>
+
 namespace pdal
 {
 
@@ -103,30 +110,161 @@ std::string validPlugin(const std::string& path, const StringList& types)
     return type + "s." + plugin;
 }
 
+std::string manifestFilename(const std::string& dir)
+{
+    return FileUtils::toAbsolutePath("pdal_plugins.json", dir);
+}
+
 } // unnamed namespace;
 
 
 PluginDirectory::PluginDirectory()
 {
     for (const auto& dir : pluginSearchPaths())
+        if (!readManifest(dir))
+            scan(dir);
+}
+
+
+// Find the plugins in a directory by listing its files.
+void PluginDirectory::scan(const std::string& dir)
+{
+    StringList files = FileUtils::directoryList(dir);
+    for (auto& file : files)
     {
-        StringList files = FileUtils::directoryList(dir);
-        for (auto& file : files)
+        file = FileUtils::toAbsolutePath(file);
+
+        std::string plugin;
+        plugin = validPlugin(file, {"kernel"});
+        if (plugin.size())
         {
-            file = FileUtils::toAbsolutePath(file);
-
-            std::string plugin;
-            plugin = validPlugin(file, {"kernel"});
-            if (plugin.size())
-            {
-                m_kernels.insert(std::make_pair(plugin, file));
-                continue;
-            }
-            plugin = validPlugin(file, {"reader", "writer", "filter"});
-            if (plugin.size())
-                m_drivers.insert(std::make_pair(plugin, file));
+            m_kernels.insert(std::make_pair(plugin, file));
+            continue;
         }
+        plugin = validPlugin(file, {"reader", "writer", "filter"});
+        if (plugin.size())
+            m_drivers.insert(std::make_pair(plugin, file));
+    }
+}
+
+
+// Find the plugins in a directory from the directory's manifest.  A
+// manifest is used only if it's newer than its directory, so that plugins
+// added, removed or renamed after it was written aren't missed.  Times
+// are whole seconds, so a change made in the same second as the manifest
+// makes the manifest stale.  writeManifest() makes sure that a manifest
+// it writes is strictly newer than its directory.
+bool PluginDirectory::readManifest(const std::string& dir)
+{
+    std::string filename = manifestFilename(dir);
+    std::time_t manifestTime = FileUtils::lastWriteTime(filename);
+    if (manifestTime == 0 || manifestTime <= FileUtils::lastWriteTime(dir))
+        return false;
+
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(FileUtils::readFileIntoString(filename), root) ||
+        !root.isObject() || !root["plugins"].isArray())
+        return false;
+
+    std::map<std::string, std::string> kernels;
+    std::map<std::string, std::string> drivers;
+    std::map<std::string, StringList> extensions;
+    for (const Json::Value& plugin : root["plugins"])
+    {
+        if (!plugin.isObject() || !plugin["name"].isString() ||
+            !plugin["library"].isString())
+            return false;
+        std::string name = plugin["name"].asString();
+        std::string path =
+            FileUtils::toAbsolutePath(plugin["library"].asString(), dir);
+
+        if (validPlugin(path, {"kernel"}) == name)
+            kernels.insert(std::make_pair(name, path));
+        else if (validPlugin(path, {"reader", "writer", "filter"}) == name)
+            drivers.insert(std::make_pair(name, path));
+        else
+            return false;
+        for (const Json::Value& ext : plugin["extensions"])
+            extensions[name].push_back(ext.asString());
     }
+
+    // Like the search paths, plugins in earlier manifests take precedence.
+    m_kernels.insert(kernels.begin(), kernels.end());
+    m_drivers.insert(drivers.begin(), drivers.end());
+    m_extensions.insert(extensions.begin(), extensions.end());
+    return true;
+}
+
+
+/**
+  Write a manifest of the plugins in a directory.  Plugins found through
+  the manifest needn't be found by listing the directory.  Stage plugins
+  are loaded to find the file extensions associated with them.
+
+  \param dir  Directory containing plugins.
+*/
+void PluginDirectory::writeManifest(const std::string& dir)
+{
+    StringList files = FileUtils::directoryList(dir);
+
+    Json::Value plugins(Json::arrayValue);
+    for (const std::string& file : files)
+    {
+        std::string name = validPlugin(file,
+            {"kernel", "reader", "writer", "filter"});
+        if (name.empty())
+            continue;
+
+        Json::Value plugin;
+        plugin["name"] = name;
+        plugin["library"] = FileUtils::getFilename(file);
+        if (!Utils::startsWith(name, "kernels."))
+        {
+            PluginManager<Stage>::loadPlugin(FileUtils::toAbsolutePath(file));
+            StageExtensions& exts = PluginManager<Stage>::get().extensions();
+            for (const std::string& ext : exts.extensions(name))
+                plugin["extensions"].append(ext);
+        }
+        plugins.append(plugin);
+    }
+
+    Json::Value root;
+    root["plugins"] = plugins;
+
+    std::string filename = manifestFilename(dir);
+    auto write = [&filename, &root]()
+    {
+        std::ostream *out = FileUtils::createFile(filename, false);
+        if (!out)
+            throw pdal_error("Unable to create plugin manifest '" +
+                filename + "'.");
+        *out << root;
+        FileUtils::closeFile(out);
+    };
+
+    // Creating the manifest changes its directory, usually in the same
+    // second.  Rewrite the manifest until it's newer than the directory,
+    // which doesn't change the directory, so that readManifest() uses it.
+    write();
+    while (FileUtils::lastWriteTime(filename) <= FileUtils::lastWriteTime(dir))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        write();
+    }
+
+    // A plugin added or removed while the manifest was being written would
+    // be missed, so start over if the directory's files have changed.
+    auto names = [&filename](const StringList& files)
+    {
+        std::set<std::string> names;
+        for (const std::string& file : files)
+            names.insert(FileUtils::getFilename(file));
+        names.insert(FileUtils::getFilename(filename));
+        return names;
+    };
+    if (names(files) != names(FileUtils::directoryList(dir)))
+        writeManifest(dir);
 }
 
 StringList PluginDirectory::test_pluginSearchPaths()
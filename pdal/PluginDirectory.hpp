@@ -50,6 +50,7 @@ namespace pdal
 class PluginDirectory
 {
     FRIEND_TEST(PluginManagerTest, SearchPaths);
+    FRIEND_TEST(PluginManagerTest, Manifest);
 
 private:
     PluginDirectory();
@@ -63,10 +64,16 @@ public:
         return instance;
     }
 
+    PDAL_DLL static void writeManifest(const std::string& dir);
+
     std::map<std::string, std::string> m_kernels;
     std::map<std::string, std::string> m_drivers;
+    std::map<std::string, StringList> m_extensions;
 
 private:
+    bool readManifest(const std::string& dir);
+    void scan(const std::string& dir);
+
     static PluginDirectory *m_instance;
     PDAL_DLL static StringList test_pluginSearchPaths();
 };
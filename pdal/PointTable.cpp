@@ -39,7 +39,7 @@ namespace pdal
 {
 
 BasePointTable::BasePointTable(PointLayout& layout) :
-    m_metadata(new Metadata()), m_layoutRef(layout)
+    m_metadata(new Metadata()), m_layoutRef(layout), m_concurrent(false)
 {}
 
 
@@ -70,6 +70,15 @@ void BasePointTable::addSpatialReference(const SpatialReference& spatialRef)
 }
 
 
+// Copy the public and private metadata of another table.  Nodes added to
+// this table's metadata afterward aren't seen by the source table.
+void BasePointTable::copyMetadata(const BasePointTable& src)
+{
+    m_metadata->m_root = src.m_metadata->m_root.clone("root");
+    m_metadata->m_private = src.m_metadata->m_private.clone("private");
+}
+
+
 ArtifactManager& BasePointTable::artifactManager()
 {
     if (!m_artifactManager)
@@ -101,18 +110,32 @@ void SimplePointTable::getFieldInternal(Dimension::Id id, PointId idx,
 
 PointTable::~PointTable()
 {
-    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+    for (auto& blocks : m_blocks)
+        if (blocks)
+            for (size_t i = 0; i < m_blockListCnt && blocks[i]; ++i)
+                delete [] blocks[i];
 }
 
 PointId PointTable::addPoint()
 {
+    // Only pay for the lock when stages are run concurrently.
+    std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+    if (m_concurrent)
+        lock.lock();
+
     if (m_numPts % m_blockPtCnt == 0)
     {
+        point_count_t block = m_numPts / m_blockPtCnt;
+        if (block >= m_blockListCnt * m_blockListCnt)
+            throw pdal_error("Point table capacity exceeded.");
+        BlockList& blocks = m_blocks[block / m_blockListCnt];
+        if (!blocks)
+            blocks.reset(new char *[m_blockListCnt]());
+
         size_t size = pointsToBytes(m_blockPtCnt);
         char *buf = new char[size];
         memset(buf, 0, size);
-        m_blocks.push_back(buf);
+        blocks[block % m_blockListCnt] = buf;
     }
     return m_numPts++;
 }
@@ -120,7 +143,8 @@ PointId PointTable::addPoint()
 
 char *PointTable::getPoint(PointId idx)
 {
-    char *buf = m_blocks[idx / m_blockPtCnt];
+    point_count_t block = idx / m_blockPtCnt;
+    char *buf = m_blocks[block / m_blockListCnt][block % m_blockListCnt];
     return buf + pointsToBytes(idx % m_blockPtCnt);
 }
 
@@ -36,6 +36,8 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "pdal/SpatialReference.hpp"
@@ -53,6 +55,7 @@ class PDAL_DLL BasePointTable : public PointContainer
 {
     FRIEND_TEST(PointTable, srs);
     friend class PointView;
+    friend class Stage;
 
 protected:
     BasePointTable(PointLayout& layout);
@@ -92,9 +95,15 @@ public:
     virtual bool supportsView() const
         { return false; }
     MetadataNode privateMetadata(const std::string& name);
+    void copyMetadata(const BasePointTable& src);
     MetadataNode toMetadata() const;
     ArtifactManager& artifactManager();
 
+    // Set whether stages may add points to the table from more than one
+    // thread at a time.
+    void setConcurrent(bool concurrent)
+        { m_concurrent = concurrent; }
+
 private:
     // Point data operations.
     virtual PointId addPoint() = 0;
@@ -107,6 +116,11 @@ protected:
     std::list<SpatialReference> m_spatialRefs;
     PointLayout& m_layoutRef;
     std::unique_ptr<ArtifactManager> m_artifactManager;
+    bool m_concurrent;
+
+private:
+    // Serializes stages that are run concurrently on the table.
+    std::mutex m_mutex;
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -144,13 +158,19 @@ private:
 class PDAL_DLL PointTable : public SimplePointTable
 {
 private:
-    // Point storage.
-    std::vector<char *> m_blocks;
+    // Point storage.  Blocks are found through a fixed directory whose
+    // entries are never moved once allocated, so points can be added by
+    // one thread while others access existing points.
+    typedef std::unique_ptr<char *[]> BlockList;
+    std::vector<BlockList> m_blocks;
     point_count_t m_numPts;
+    std::mutex m_mutex;
     static const point_count_t m_blockPtCnt = 65536;
+    static const point_count_t m_blockListCnt = 1024;
 
 public:
-    PointTable() : SimplePointTable(m_layout), m_numPts(0)
+    PointTable() : SimplePointTable(m_layout), m_blocks(m_blockListCnt),
+        m_numPts(0)
         {}
     virtual ~PointTable();
     virtual bool supportsView() const
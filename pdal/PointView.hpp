@@ -43,6 +43,7 @@
 #include <pdal/PointTable.hpp>
 #include <pdal/util/Bounds.hpp>
 
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
@@ -63,6 +64,7 @@ class PointView;
 class PointViewIter;
 class KD2Index;
 class KD3Index;
+class PipelineManager;
 
 typedef std::shared_ptr<PointView> PointViewPtr;
 typedef std::set<PointViewPtr, PointViewLess> PointViewSet;
@@ -70,6 +72,7 @@ typedef std::set<PointViewPtr, PointViewLess> PointViewSet;
 class PDAL_DLL PointView : public PointContainer
 {
     friend class plang::Invocation;
+    friend class PipelineManager;
     friend class PointIdxRef;
     friend struct PointViewLess;
 public:
@@ -309,7 +312,12 @@ protected:
     std::unique_ptr<KD2Index> m_index2;
 
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
+
+    // Give the view a new ID, placing it after all existing views in
+    // a PointViewSet.
+    void renumber()
+        { m_id = ++m_lastId; }
 
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id dim, PointId idx, T_IN in);
@@ -0,0 +1,260 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include <pdal/Dimension.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Limits on point values outside of which downstream stages discard points.
+  Readers may use a hint to skip points, blocks of points or entire files.
+  Hints are conservative: points within the limits may still be discarded
+  downstream, but no point outside the limits would be kept.
+*/
+class ReadHint
+{
+public:
+    /**
+      Construct an unbounded hint.
+    */
+    ReadHint() : m_bounds(lowest(), lowest(), lowest(), max(), max(), max()),
+        m_minTime(lowest()), m_maxTime(max())
+    {}
+
+    /**
+      Determine whether the hint limits any value.
+
+      \return  Whether the hint can exclude points.
+    */
+    bool bounded() const
+    {
+        return m_bounds.minx != lowest() || m_bounds.miny != lowest() ||
+            m_bounds.minz != lowest() || m_bounds.maxx != max() ||
+            m_bounds.maxy != max() || m_bounds.maxz != max() ||
+            timeBounded();
+    }
+
+    /**
+      Determine whether the hint limits both X and Y on both sides.
+
+      \return  Whether the hint has a finite 2D extent.
+    */
+    bool boundedXY() const
+    {
+        return m_bounds.minx != lowest() && m_bounds.maxx != max() &&
+            m_bounds.miny != lowest() && m_bounds.maxy != max();
+    }
+
+    /**
+      Determine whether the hint limits GPS time.
+
+      \return  Whether the hint limits GPS time.
+    */
+    bool timeBounded() const
+        { return m_minTime != lowest() || m_maxTime != max(); }
+
+    /**
+      Limit the hint to a 2D box.  Z is left unchanged.
+
+      \param box  Bounding box of points to keep.
+    */
+    void limit(const BOX2D& box)
+    {
+        m_bounds.minx = (std::max)(m_bounds.minx, box.minx);
+        m_bounds.maxx = (std::min)(m_bounds.maxx, box.maxx);
+        m_bounds.miny = (std::max)(m_bounds.miny, box.miny);
+        m_bounds.maxy = (std::min)(m_bounds.maxy, box.maxy);
+    }
+
+    /**
+      Limit the hint to a box.
+
+      \param box  Bounding box of points to keep.
+    */
+    void limit(const BOX3D& box)
+    {
+        limit(box.to2d());
+        m_bounds.minz = (std::max)(m_bounds.minz, box.minz);
+        m_bounds.maxz = (std::min)(m_bounds.maxz, box.maxz);
+    }
+
+    /**
+      Limit the values of a dimension.  Only X, Y, Z and GpsTime are
+      tracked.  Limits on other dimensions are ignored.
+
+      \param dim  Dimension to limit.
+      \param minVal  Minimum value of points to keep.
+      \param maxVal  Maximum value of points to keep.
+    */
+    void limit(Dimension::Id dim, double minVal, double maxVal)
+    {
+        using namespace Dimension;
+
+        auto clamp = [minVal, maxVal](double& lo, double& hi)
+        {
+            lo = (std::max)(lo, minVal);
+            hi = (std::min)(hi, maxVal);
+        };
+
+        if (dim == Id::X)
+            clamp(m_bounds.minx, m_bounds.maxx);
+        else if (dim == Id::Y)
+            clamp(m_bounds.miny, m_bounds.maxy);
+        else if (dim == Id::Z)
+            clamp(m_bounds.minz, m_bounds.maxz);
+        else if (dim == Id::GpsTime)
+            clamp(m_minTime, m_maxTime);
+    }
+
+    /**
+      Restrict the hint to points also allowed by another hint.
+
+      \param other  Hint to intersect with this one.
+    */
+    void intersect(const ReadHint& other)
+    {
+        limit(other.m_bounds);
+        limit(Dimension::Id::GpsTime, other.m_minTime, other.m_maxTime);
+    }
+
+    /**
+      Extend the hint to points allowed by another hint.
+
+      \param other  Hint to combine with this one.
+    */
+    void grow(const ReadHint& other)
+    {
+        if (other.empty())
+            return;
+        if (empty())
+        {
+            *this = other;
+            return;
+        }
+        m_bounds.grow(other.m_bounds);
+        m_minTime = (std::min)(m_minTime, other.m_minTime);
+        m_maxTime = (std::max)(m_maxTime, other.m_maxTime);
+    }
+
+    /**
+      Determine whether the hint excludes all points.
+
+      \return  Whether no point can be kept.
+    */
+    bool empty() const
+    {
+        return m_bounds.minx > m_bounds.maxx || m_bounds.miny > m_bounds.maxy ||
+            m_bounds.minz > m_bounds.maxz || m_minTime > m_maxTime;
+    }
+
+    /**
+      Determine whether points within a box may be kept.
+
+      \param box  Bounds of a set of points.
+      \return  Whether any point in the box may be kept.
+    */
+    bool overlaps(const BOX3D& box) const
+    {
+        return !empty() &&
+            box.minx <= m_bounds.maxx && box.maxx >= m_bounds.minx &&
+            box.miny <= m_bounds.maxy && box.maxy >= m_bounds.miny &&
+            box.minz <= m_bounds.maxz && box.maxz >= m_bounds.minz;
+    }
+
+    /**
+      Determine whether points in a range of GPS time may be kept.
+
+      \param minTime  Minimum time of a set of points.
+      \param maxTime  Maximum time of a set of points.
+      \return  Whether any point in the range may be kept.
+    */
+    bool overlapsTime(double minTime, double maxTime) const
+        { return minTime <= m_maxTime && maxTime >= m_minTime; }
+
+    /**
+      Determine whether a point may be kept.
+
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+      \param z  Z coordinate of the point.
+      \return  Whether the point may be kept.
+    */
+    bool contains(double x, double y, double z) const
+    {
+        return x >= m_bounds.minx && x <= m_bounds.maxx &&
+            y >= m_bounds.miny && y <= m_bounds.maxy &&
+            z >= m_bounds.minz && z <= m_bounds.maxz;
+    }
+
+    /**
+      Determine whether a point with a GPS time may be kept.
+
+      \param time  GPS time of the point.
+      \return  Whether the point may be kept.
+    */
+    bool containsTime(double time) const
+        { return time >= m_minTime && time <= m_maxTime; }
+
+    /**
+      Get the bounds of points that may be kept.
+
+      \return  Bounds of points that may be kept.
+    */
+    const BOX3D& bounds() const
+        { return m_bounds; }
+
+    double minTime() const
+        { return m_minTime; }
+    double maxTime() const
+        { return m_maxTime; }
+
+private:
+    static double lowest()
+        { return std::numeric_limits<double>::lowest(); }
+    static double max()
+        { return (std::numeric_limits<double>::max)(); }
+
+    BOX3D m_bounds;
+    double m_minTime;
+    double m_maxTime;
+};
+
+} // namespace pdal
@@ -45,4 +45,18 @@ void Reader::readerAddArgs(ProgramArgs& args)
         std::numeric_limits<point_count_t>::max());
 }
 
+
+bool Reader::projected(const std::string& name) const
+{
+    if (!m_projected)
+        return true;
+    if (Utils::iequals(name, "X") || Utils::iequals(name, "Y") ||
+        Utils::iequals(name, "Z"))
+        return true;
+    for (const std::string& dim : m_projection)
+        if (Utils::iequals(dim, name))
+            return true;
+    return false;
+}
+
 } // namespace pdal
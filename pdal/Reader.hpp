@@ -49,12 +49,44 @@ class PDAL_DLL Reader : public virtual Stage
 public:
     typedef std::function<void(PointView&, PointId)> PointReadFunc;
 
-    Reader()
+    Reader() : m_projected(false)
     {}
 
     void setReadCb(PointReadFunc cb)
         { m_cb = cb; }
 
+    /**
+      Limit the dimensions loaded by the reader to those used by downstream
+      stages.  Set when a pipeline is prepared.  Readers that support
+      projection skip other dimensions when adding dimensions.
+
+      \param dims  Names of dimensions used downstream.
+    */
+    void setProjection(const StringList& dims)
+    {
+        m_projected = true;
+        m_projection = dims;
+    }
+
+    /**
+      Clear any projection so that all dimensions are loaded.
+    */
+    void clearProjection()
+    {
+        m_projected = false;
+        m_projection.clear();
+    }
+
+    /**
+      Set limits on the points kept by downstream stages.  Set when a
+      pipeline is prepared.  Readers that support hints may skip points
+      outside the limits.
+
+      \param hint  Limits of points kept downstream.
+    */
+    void setHint(const ReadHint& hint)
+        { m_hint = hint; }
+
 protected:
     std::string m_filename;
     point_count_t m_count;
@@ -62,7 +94,28 @@ protected:
     Arg *m_filenameArg;
     Arg *m_countArg;
 
+    /**
+      Determine whether a dimension should be loaded.  X, Y and Z are always
+      loaded.
+
+      \param name  Name of the dimension.
+      \return  Whether the dimension is used downstream.
+    */
+    bool projected(const std::string& name) const;
+
+    /**
+      Get the limits of points kept downstream.
+
+      \return  Hint set when the pipeline was prepared.
+    */
+    const ReadHint& hint() const
+        { return m_hint; }
+
 private:
+    bool m_projected;
+    StringList m_projection;
+    ReadHint m_hint;
+
     virtual PointViewSet run(PointViewPtr view)
     {
         PointViewSet viewSet;
@@ -35,16 +35,21 @@
 #include <pdal/GDALUtils.hpp>
 #include <pdal/GEOSUtils.hpp>
 #include <pdal/PipelineManager.hpp>
+#include <pdal/Reader.hpp>
 #include <pdal/Stage.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/util/Algorithm.hpp>
 #include <pdal/util/ProgramArgs.hpp>
+#include <pdal/Writer.hpp>
 
 #include "private/StageRunner.hpp"
 
+#include <functional>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <set>
 
 namespace pdal
 {
@@ -136,12 +141,20 @@ QuickInfo Stage::preview()
 
 
 void Stage::prepare(PointTableRef table)
+{
+    pushProjection();
+    pushHints();
+    l_prepare(table);
+}
+
+
+void Stage::l_prepare(PointTableRef table)
 {
     m_args.reset(new ProgramArgs);
     for (size_t i = 0; i < m_inputs.size(); ++i)
     {
         Stage *prev = m_inputs[i];
-        prev->prepare(table);
+        prev->l_prepare(table);
     }
     handleOptions();
     startLogging();
@@ -153,9 +166,100 @@ void Stage::prepare(PointTableRef table)
 }
 
 
+// Determine the dimensions used downstream of each reader so that readers
+// can skip others.  Views returned by a writer are discarded, so only
+// the dimensions used by the writer and the stages before it are needed.
+// Any other terminal stage needs all dimensions.
+void Stage::pushProjection()
+{
+    struct Projection
+    {
+        Projection() : m_all(false)
+        {}
+
+        bool m_all;
+        std::set<std::string> m_dims;
+    };
+
+    std::map<Stage *, Projection> projections;
+    std::function<void(Stage *, const Projection&)> push =
+        [&projections, &push](Stage *stage, const Projection& downstream)
+    {
+        bool visited = projections.count(stage);
+        Projection& p = projections[stage];
+
+        // Stages with several consumers need the union of their needs.
+        size_t count = p.m_dims.size();
+        bool all = p.m_all;
+        p.m_all = p.m_all || downstream.m_all;
+        p.m_dims.insert(downstream.m_dims.begin(), downstream.m_dims.end());
+        if (visited && p.m_all == all && p.m_dims.size() == count)
+            return;
+
+        Projection upstream(p);
+        StringList used;
+        if (stage->usedDimensions(used))
+            upstream.m_dims.insert(used.begin(), used.end());
+        else
+            upstream.m_all = true;
+        for (Stage *input : stage->m_inputs)
+            push(input, upstream);
+    };
+
+    Projection root;
+    root.m_all = (dynamic_cast<Writer *>(this) == nullptr);
+    push(this, root);
+
+    for (auto& p : projections)
+    {
+        Reader *reader = dynamic_cast<Reader *>(p.first);
+        if (!reader)
+            continue;
+        if (p.second.m_all)
+            reader->clearProjection();
+        else
+            reader->setProjection(StringList(p.second.m_dims.begin(),
+                p.second.m_dims.end()));
+    }
+}
+
+
+// Hand readers the limits of points kept by the stages downstream.  Limits
+// pass through stages that only discard points.  A reader reached along
+// several paths must keep the points wanted along any of them.
+void Stage::pushHints()
+{
+    std::map<Reader *, ReadHint> hints;
+    std::function<void(Stage *, const ReadHint&)> push =
+        [&hints, &push](Stage *stage, const ReadHint& downstream)
+    {
+        Reader *reader = dynamic_cast<Reader *>(stage);
+        if (reader)
+        {
+            auto it = hints.find(reader);
+            if (it == hints.end())
+                hints.insert(std::make_pair(reader, downstream));
+            else
+                it->second.grow(downstream);
+        }
+
+        ReadHint upstream;
+        if (stage->readHint(upstream))
+            upstream.intersect(downstream);
+        else
+            upstream = ReadHint();
+        for (Stage *input : stage->m_inputs)
+            push(input, upstream);
+    };
+
+    push(this, ReadHint());
+    for (auto& h : hints)
+        h.first->setHint(h.second);
+}
+
+
 PointViewSet Stage::execute(PointTableRef table)
 {
-    startLogging();
     table.finalize();
 
     PointViewSet views;
@@ -174,6 +278,17 @@ PointViewSet Stage::execute(PointTableRef table)
             views.insert(temp.begin(), temp.end());
         }
     }
+    return execute(table, views);
+}
+
+
+// Run this stage on the views produced by its inputs.  Stages in
+// independent branches of a pipeline may be run concurrently, so the
+// table's spatial references are set under the table's lock, along with
+// the ready and done operations that use them.
+PointViewSet Stage::execute(PointTableRef table, PointViewSet& views)
+{
+    startLogging();
 
     PointViewSet outViews;
     std::vector<StageRunnerPtr> runners;
@@ -184,12 +299,14 @@ PointViewSet Stage::execute(PointTableRef table)
     // ABELL - Should we clear the references once the stage run has
     //   completed?  Wondering if that would break something where a
     //   writer wants to check a table's SRS.
-    SpatialReference srs;
-    table.clearSpatialReferences();
-    // Iterating backwards will ensure that the SRS for the first view is
-    // first on the list for table.
-    for (auto it = views.rbegin(); it != views.rend(); it++)
-        table.addSpatialReference((*it)->spatialReference());
+    auto setSpatialReferences = [&table, &views]()
+    {
+        table.clearSpatialReferences();
+        // Iterating backwards will ensure that the SRS for the first view is
+        // first on the list for table.
+        for (auto it = views.rbegin(); it != views.rend(); it++)
+            table.addSpatialReference((*it)->spatialReference());
+    };
 
     // Count the number of views and the number of points and faces so they're
     // available to stages.
@@ -204,7 +321,11 @@ PointViewSet Stage::execute(PointTableRef table)
     }
     // Do the ready operation and then start running all the views
     // through the stage.
-    ready(table);
+    {
+        std::lock_guard<std::mutex> lock(table.m_mutex);
+        setSpatialReferences();
+        ready(table);
+    }
     for (auto const& it : views)
     {
         StageRunnerPtr runner(new StageRunner(this, it));
@@ -214,7 +335,7 @@ PointViewSet Stage::execute(PointTableRef table)
 
     // As the stages complete (synchronously at this time), propagate the
     // spatial reference and merge the output views.
-    srs = getSpatialReference();
+    SpatialReference srs = getSpatialReference();
     for (auto const& it : runners)
     {
         StageRunnerPtr runner(it);
@@ -227,7 +348,11 @@ PointViewSet Stage::execute(PointTableRef table)
                 v->setSpatialReference(srs);
         outViews.insert(temp.begin(), temp.end());
     }
-    l_done(table);
+    {
+        std::lock_guard<std::mutex> lock(table.m_mutex);
+        setSpatialReferences();
+        l_done(table);
+    }
     stopLogging();
     m_pointCount = 0;
     m_faceCount = 0;
@@ -250,6 +375,7 @@ void Stage::l_addArgs(ProgramArgs& args)
     args.add("option_file", "File from which to read additional options",
         m_optionFile);
     readerAddArgs(args);
+    writerAddArgs(args);
 }
 
 
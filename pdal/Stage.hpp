@@ -49,6 +49,7 @@
 #include <pdal/PointRef.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
+#include <pdal/ReadHint.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/ProgramArgs.hpp>
 
@@ -56,6 +57,7 @@ namespace pdal
 {
 
 class ProgramArgs;
+class PipelineManager;
 class StageRunner;
 class StageWrapper;
 class Streamable;
@@ -72,6 +74,7 @@ class Streamable;
 class PDAL_DLL Stage
 {
     FRIEND_TEST(OptionsTest, conditional);
+    friend class PipelineManager;
     friend class StageWrapper;
     friend class StageRunner;
     friend class Streamable;
@@ -131,6 +134,34 @@ public:
     virtual bool pipelineStreamable() const
     { return false; }
 
+    /**
+      Determine the dimensions that this stage reads from its input.  When
+      the terminal stage of a pipeline is a writer, readers load only the
+      dimensions used by downstream stages.  Called before options are
+      processed, so implementations must inspect the stage's options
+      directly.
+
+      \param[out] dims  Names of dimensions read by the stage.
+      \return  Whether \a dims is complete.  If false, the stage may read
+        any dimension of its input.
+    */
+    virtual bool usedDimensions(StringList& /*dims*/) const
+    { return false; }
+
+    /**
+      Limit a hint to the points that this stage passes.  Hints are handed
+      to upstream readers so that they can skip points that would be
+      discarded.  Called before options are processed, so implementations
+      must inspect the stage's options directly.
+
+      \param[in,out] hint  Hint to limit.
+      \return  Whether the stage only discards points, based on values
+        that it doesn't change.  If false, the stage may change values or
+        select points in other ways and no hint is passed upstream.
+    */
+    virtual bool readHint(ReadHint& /*hint*/) const
+    { return false; }
+
     /**
       Set the spatial reference of a stage.
 
@@ -353,9 +384,15 @@ private:
 
     void setupLog();
     void handleOptions();
+    void l_prepare(PointTableRef table);
+    PointViewSet execute(PointTableRef table, PointViewSet& views);
+    void pushProjection();
+    void pushHints();
 
     virtual void readerAddArgs(ProgramArgs& /*args*/)
         {}
+    virtual void writerAddArgs(ProgramArgs& /*args*/)
+        {}
     void l_addArgs(ProgramArgs& args);
     void l_done(PointTableRef table);
 
@@ -36,6 +36,7 @@
 
 #include <json/json.h>
 
+#include <pdal/PluginDirectory.hpp>
 #include <pdal/StageExtensions.hpp>
 #include <pdal/util/FileUtils.hpp>
 
@@ -142,23 +143,71 @@ void StageExtensions::set(const std::string& stage, const StringList& exts)
             m_writers[ext] = stage;
 }
 
+// Add the extensions of plugins listed in plugin manifests.  This is only
+// done when an extension isn't otherwise known, since it requires finding
+// the plugin directories.
+void StageExtensions::loadManifests()
+{
+    std::call_once(m_manifestsLoaded, [this]()
+    {
+        for (auto& p : PluginDirectory::get().m_extensions)
+            set(p.first, p.second);
+    });
+}
+
+
+std::string StageExtensions::find(std::map<std::string, std::string>& stages,
+    const std::string& extension)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = stages.find(extension);
+    return it == stages.end() ? std::string() : it->second;
+}
+
+
 // Get the default reader associated with an extension.  Extensions
 // are specified without the leading '.'
 std::string StageExtensions::defaultReader(const std::string& extension)
 {
     load();
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return (m_readers[extension]);
+    std::string stage = find(m_readers, extension);
+    if (stage.empty())
+    {
+        loadManifests();
+        stage = find(m_readers, extension);
+    }
+    return stage;
 }
 
 
 // Get the default writer associated with an extension.  Extensions
 // are specified without the leading '.'
 std::string StageExtensions::defaultWriter(const std::string& extension)
+{
+    load();
+    std::string stage = find(m_writers, extension);
+    if (stage.empty())
+    {
+        loadManifests();
+        stage = find(m_writers, extension);
+    }
+    return stage;
+}
+
+
+// Get the extensions associated with a stage.
+StringList StageExtensions::extensions(const std::string& stage)
 {
     load();
     std::lock_guard<std::mutex> lock(m_mutex);
-    return (m_writers[extension]);
+    StringList exts;
+    for (auto& p : m_readers)
+        if (p.second == stage)
+            exts.push_back(p.first);
+    for (auto& p : m_writers)
+        if (p.second == stage)
+            exts.push_back(p.first);
+    return exts;
 }
 
 } // namespace pdal
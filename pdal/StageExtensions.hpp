@@ -32,6 +32,9 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#pragma once
+
+#include <map>
 #include <mutex>
 
 #include <pdal/Log.hpp>
@@ -48,11 +51,16 @@ public:
     void set(const std::string& stage, const StringList& exts);
     std::string defaultReader(const std::string& filename);
     std::string defaultWriter(const std::string& filename);
+    StringList extensions(const std::string& stage);
 private:
     void load();
+    void loadManifests();
+    std::string find(std::map<std::string, std::string>& stages,
+        const std::string& extension);
 
     LogPtr m_log;
     std::mutex m_mutex;
+    std::once_flag m_manifestsLoaded;
     std::map<std::string, std::string> m_readers;
     std::map<std::string, std::string> m_writers;
 };
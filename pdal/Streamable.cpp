@@ -32,7 +32,11 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
+#include <map>
+#include <memory>
 
 #include <pdal/Streamable.hpp>
 
@@ -57,22 +61,19 @@ void Streamable::execute(StreamPointTable& table)
 {
     struct StreamableList : public std::list<Streamable *>
     {
+        // Stages in this list that aren't in 'other', in order.
         StreamableList operator - (const StreamableList& other) const
         {
             StreamableList resultList;
-            auto ti = rbegin();
-            auto oi = other.rbegin();
-
-            while (oi != other.rend() && ti != rend() && *ti == *oi)
-            {
-                oi++;
-                ti++;
-            }
-            while (ti != rend())
-                resultList.push_front(*ti++);
+            for (Streamable *s : *this)
+                if (!other.contains(s))
+                    resultList.push_back(s);
             return resultList;
         };
 
+        bool contains(const Streamable *s) const
+            { return std::find(begin(), end(), s) != end(); }
+
         void ready(PointTableRef& table)
         {
             for (auto s : *this)
@@ -100,10 +101,9 @@ void Streamable::execute(StreamPointTable& table)
     if (!pipelineStreamable())
         return;
 
-    SpatialReference srs;
     std::list<StreamableList> lists;
+    std::list<StreamableList> paths;
     StreamableList stages;
-    StreamableList lastRunStages;
 
     table.finalize();
 
@@ -111,29 +111,20 @@ void Streamable::execute(StreamPointTable& table)
     // the list of stages and push it on a list.  We then pull a list from the
     // back of list and keep going.  Pushing on the front and pulling from the
     // back insures that the stages will be executed in the order that they
-    // were added.  If we hit stage with no previous stages, we execute
-    // the stage list.
+    // were added.  If we hit stage with no previous stages, we've found
+    // a path from a reader to the end stage.
     // All this often amounts to a bunch of list copying for
     // no reason, but it's more simple than what we might otherwise do and
     // this should be a nit in the grand scheme of execution time.
     //
     // As an example, if there are four paths from the end stage (writer) to
-    // reader stages, there will be four stage lists and execute(table, stages)
-    // will be called four times.
+    // reader stages, there will be four stage lists.
     Streamable *s = this;
     stages.push_front(s);
     while (true)
     {
         if (s->m_inputs.empty())
-        {
-            // Call done on all the stages we ran last time and aren't
-            // using this time.
-            (lastRunStages - stages).done(table);
-            // Call ready on all the stages we didn't run last time.
-            (stages - lastRunStages).ready(table);
-            execute(table, stages);
-            lastRunStages = stages;
-        }
+            paths.push_back(stages);
         else
         {
             for (auto s2 : s->m_inputs)
@@ -144,45 +135,187 @@ void Streamable::execute(StreamPointTable& table)
             }
         }
         if (lists.empty())
-        {
-            lastRunStages.done(table);
             break;
-        }
         stages = lists.back();
         lists.pop_back();
         s = stages.front();
     }
+
+    // Run the paths that start at the same reader together so that the
+    // reader's points are read once and passed to each path.  Readers are
+    // run in the order in which their first path was found.  The spatial
+    // reference last seen by each stage is kept across readers so that
+    // stages are only told of real changes.
+    StreamableList lastRunStages;
+    SrsMap srsMap;
+    while (paths.size())
+    {
+        Streamable *reader = paths.front().front();
+        std::list<std::list<Streamable *>> readerPaths;
+        StreamableList readerStages;
+        for (auto pi = paths.begin(); pi != paths.end();)
+        {
+            if (pi->front() != reader)
+            {
+                pi++;
+                continue;
+            }
+            for (Streamable *ps : *pi)
+                if (!readerStages.contains(ps))
+                    readerStages.push_back(ps);
+            readerPaths.push_back(*pi);
+            pi = paths.erase(pi);
+        }
+
+        // Call done on all the stages we ran last time and aren't
+        // using this time.
+        (lastRunStages - readerStages).done(table);
+        // Call ready on all the stages we didn't run last time.
+        (readerStages - lastRunStages).ready(table);
+        execute(table, readerPaths, srsMap);
+        lastRunStages = readerStages;
+    }
+    lastRunStages.done(table);
+}
+
+
+void Streamable::execute(StreamPointTable& table,
+    std::list<Streamable *>& stages, SrsMap& srsMap)
+{
+    std::list<std::list<Streamable *>> paths { stages };
+
+    execute(table, paths, srsMap);
 }
 
 
+// Stream points through a set of paths that all start at the same reader.
+// The paths form a tree rooted at the reader.  Each chunk of points is
+// read once and passed down every branch of the tree.  Where the tree
+// branches, the point data, skip mask and spatial reference are saved
+// and restored before each branch after the first runs, so that every
+// branch sees the points as they were at the branch point.
 void Streamable::execute(StreamPointTable& table,
-    std::list<Streamable *>& stages)
+    std::list<std::list<Streamable *>>& paths, SrsMap& srsMap)
 {
+    struct Branch
+    {
+        Branch(Streamable *stage) : m_stage(stage)
+        {}
+
+        Streamable *m_stage;
+        std::vector<std::unique_ptr<Branch>> m_children;
+    };
+
+    if (paths.empty())
+        return;
+
+    // Build the tree of stages.
+    Branch root(paths.front().front());
+    for (auto& path : paths)
+    {
+        Branch *b = &root;
+        auto si = path.begin();
+        for (si++; si != path.end(); si++)
+        {
+            auto& children = b->m_children;
+            auto ci = std::find_if(children.begin(), children.end(),
+                [si](const std::unique_ptr<Branch>& c)
+                { return c->m_stage == *si; });
+            if (ci == children.end())
+            {
+                children.emplace_back(new Branch(*si));
+                ci = children.end() - 1;
+            }
+            b = ci->get();
+        }
+    }
+
     std::vector<bool> skips(table.capacity());
-    std::list<Streamable *> filters;
-    SpatialReference srs;
-    std::map<Streamable *, SpatialReference> srsMap;
+    const DimTypeList dims = table.layout()->dimTypes();
+    const size_t pointSize = table.layout()->pointSize();
+    PointRef point(table, 0);
+    point_count_t pointLimit = 0;
+
+    // Run the stages below branch 'b' on the points in the table.
+    // When we get a false back from a filter, we're filtering out a
+    // point, so add it to the list of skips so that it doesn't get
+    // processed by subsequent filters.
+    std::function<void(Branch&, const SpatialReference&)> run =
+        [&](Branch& b, const SpatialReference& srs)
+    {
+        std::vector<char> savedPoints;
+        std::vector<bool> savedSkips;
+        SpatialReference savedTableSrs;
+
+        if (b.m_children.size() > 1)
+        {
+            savedPoints.resize(pointLimit * pointSize);
+            char *pos = savedPoints.data();
+            for (PointId idx = 0; idx < pointLimit; idx++, pos += pointSize)
+            {
+                if (skips[idx])
+                    continue;
+                point.setPointId(idx);
+                point.getPackedData(dims, pos);
+            }
+            savedSkips = skips;
+            savedTableSrs = table.anySpatialReference();
+        }
 
-    // Separate out the first stage.
-    Streamable *reader = stages.front();
+        for (size_t i = 0; i < b.m_children.size(); ++i)
+        {
+            if (i > 0)
+            {
+                skips = savedSkips;
+                const char *pos = savedPoints.data();
+                for (PointId idx = 0; idx < pointLimit;
+                        idx++, pos += pointSize)
+                {
+                    if (skips[idx])
+                        continue;
+                    point.setPointId(idx);
+                    point.setPackedData(dims, pos);
+                }
+                if (savedTableSrs.empty())
+                    table.clearSpatialReferences();
+                else
+                    table.setSpatialReference(savedTableSrs);
+            }
 
-    // Build a list of all stages except the first.  We may have a writer in
-    // this list in addition to filters, but we treat them in the same way.
-    auto begin = stages.begin();
-    begin++;
-    std::copy(begin, stages.end(), std::back_inserter(filters));
+            Branch& child = *b.m_children[i];
+            Streamable *s = child.m_stage;
+            if (srsMap[s] != srs)
+            {
+                s->spatialReferenceChanged(srs);
+                srsMap[s] = srs;
+            }
+            s->startLogging();
+            for (PointId idx = 0; idx < pointLimit; idx++)
+            {
+                if (skips[idx])
+                    continue;
+                point.setPointId(idx);
+                if (!s->processOne(point))
+                    skips[idx] = true;
+            }
+            SpatialReference childSrs = s->getSpatialReference();
+            if (!childSrs.empty())
+                table.setSpatialReference(childSrs);
+            s->stopLogging();
+            run(child, childSrs);
+        }
+    };
 
     // Loop until we're finished.  We handle the number of points up to
     // the capacity of the StreamPointTable that we've been provided.
 
+    Streamable *reader = root.m_stage;
     bool finished = false;
     while (!finished)
     {
         // Clear the spatial reference when processing starts.
         table.clearSpatialReferences();
-        PointId idx = 0;
-        PointRef point(table, idx);
-        point_count_t pointLimit = table.capacity();
+        pointLimit = table.capacity();
 
         reader->startLogging();
         // When we get false back from a reader, we're done, so set
@@ -199,34 +332,11 @@ void Streamable::execute(StreamPointTable& table,
                 pointLimit = idx;
         }
         reader->stopLogging();
-        srs = reader->getSpatialReference();
+        SpatialReference srs = reader->getSpatialReference();
         if (!srs.empty())
             table.setSpatialReference(srs);
 
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
-        for (Streamable *s : filters)
-        {
-            if (srsMap[s] != srs)
-            {
-                s->spatialReferenceChanged(srs);
-                srsMap[s] = srs;
-            }
-            s->startLogging();
-            for (PointId idx = 0; idx < pointLimit; idx++)
-            {
-                if (skips[idx])
-                    continue;
-                point.setPointId(idx);
-                if (!s->processOne(point))
-                    skips[idx] = true;
-            }
-            srs = s->getSpatialReference();
-            if (!srs.empty())
-                table.setSpatialReference(srs);
-            s->stopLogging();
-        }
+        run(root, srs);
 
         // Yes, vector<bool> is terrible.  Can do something better later.
         for (size_t i = 0; i < skips.size(); ++i)
@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <map>
+
 #include <pdal/pdal_internal.hpp>
 #include <pdal/Stage.hpp>
 
@@ -57,6 +59,9 @@ public:
       Streaming points can reduce memory consumption, but may limit access
       to algorithms that need to operate on full point sets.
 
+      A stage that feeds more than one stage is run once for each set of
+      points; its output is passed to each of the stages it feeds.
+
       \param table  Streming point table used for stage pipeline.  This must be
         the same \ref table used in the \ref prepare function.
 
@@ -75,7 +80,12 @@ protected:
     Streamable& operator=(const Streamable&) = delete;
     Streamable(const Streamable&); // not implemented
 
-    void execute(StreamPointTable& table, std::list<Streamable *>& stages);
+    typedef std::map<Streamable *, SpatialReference> SrsMap;
+
+    void execute(StreamPointTable& table, std::list<Streamable *>& stages,
+        SrsMap& srsMap);
+    void execute(StreamPointTable& table,
+        std::list<std::list<Streamable *>>& paths, SrsMap& srsMap);
 
     /**
       Process a single point (streaming mode).  Implement in sublcass.
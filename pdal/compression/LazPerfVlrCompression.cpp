@@ -139,6 +139,9 @@ public:
         encoder.done();
     }
 
+    const std::vector<uint32_t>& chunkSizes() const
+        { return m_chunkTable; }
+
 private:
     void resetCompressor()
     {
@@ -191,13 +194,19 @@ void LazPerfVlrCompressor::done()
 }
 
 
+const std::vector<uint32_t>& LazPerfVlrCompressor::chunkSizes() const
+{
+    return m_impl->chunkSizes();
+}
+
+
 class LazPerfVlrDecompressorImpl
 {
 public:
     LazPerfVlrDecompressorImpl(std::istream& stream, const char *vlrData,
         std::streamoff pointOffset) :
-        m_stream(stream), m_inputStream(stream), m_chunksize(0),
-        m_chunkPointsRead(0)
+        m_stream(stream), m_inputStream(new InputStream(stream)),
+        m_chunksize(0), m_chunkPointsRead(0)
     {
         laszip::io::laz_vlr zipvlr(vlrData);
         m_chunksize = zipvlr.chunk_size;
@@ -219,10 +228,22 @@ public:
         m_chunkPointsRead++;
     }
 
+    // The input stream wrapper buffers data, so it's replaced after
+    // seeking.  The decoder is reset when the next point is read.
+    void seekChunk(std::streamoff chunkOffset)
+    {
+        m_decompressor.reset();
+        m_decoder.reset();
+        m_stream.clear();
+        m_stream.seekg(chunkOffset);
+        m_inputStream.reset(new InputStream(m_stream));
+        m_chunkPointsRead = 0;
+    }
+
 private:
     void resetDecompressor()
     {
-        m_decoder.reset(new Decoder(m_inputStream));
+        m_decoder.reset(new Decoder(*m_inputStream));
         m_decompressor =
             laszip::factory::build_decompressor(*m_decoder, m_schema);
     }
@@ -233,7 +254,7 @@ private:
     typedef laszip::factory::record_schema Schema;
 
     std::istream& m_stream;
-    InputStream m_inputStream;
+    std::unique_ptr<InputStream> m_inputStream;
     std::unique_ptr<Decoder> m_decoder;
     Decompressor::ptr m_decompressor;
     Schema m_schema;
@@ -262,5 +283,11 @@ void LazPerfVlrDecompressor::decompress(char *outbuf)
     m_impl->decompress(outbuf);
 }
 
+
+void LazPerfVlrDecompressor::seekChunk(std::streamoff chunkOffset)
+{
+    m_impl->seekChunk(chunkOffset);
+}
+
 } // namespace pdal
 
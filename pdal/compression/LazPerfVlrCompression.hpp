@@ -34,6 +34,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <pdal/util/OStream.hpp>
 
 namespace laszip
@@ -70,6 +71,11 @@ public:
     PDAL_DLL void compress(const char *inbuf);
     PDAL_DLL void done();
 
+    // Sizes in bytes of the chunks written.  Chunks start after the
+    // chunk table offset at the beginning of the data.  Only complete
+    // after done() is called.
+    PDAL_DLL const std::vector<uint32_t>& chunkSizes() const;
+
 private:
     std::unique_ptr<LazPerfVlrCompressorImpl> m_impl;
 };
@@ -87,6 +93,9 @@ public:
     PDAL_DLL size_t pointSize() const;
     PDAL_DLL void decompress(char *outbuf);
 
+    // Position the decompressor at the start of a chunk.
+    PDAL_DLL void seekChunk(std::streamoff chunkOffset);
+
 private:
     std::unique_ptr<LazPerfVlrDecompressorImpl> m_impl;
 };
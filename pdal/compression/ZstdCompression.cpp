@@ -47,10 +47,10 @@ public:
     char m_tmpbuf[CHUNKSIZE];
     BlockCb m_cb;
 
-    ZstdCompressorImpl(BlockCb cb) : m_cb(cb)
+    ZstdCompressorImpl(BlockCb cb, int level) : m_cb(cb)
     {
         m_strm = ZSTD_createCStream();
-        ZSTD_initCStream(m_strm, 15);
+        ZSTD_initCStream(m_strm, level);
     }
 
     ~ZstdCompressorImpl()
@@ -91,8 +91,8 @@ public:
     }
 };
 
-ZstdCompressor::ZstdCompressor(BlockCb cb) :
-    m_impl(new ZstdCompressorImpl(cb))
+ZstdCompressor::ZstdCompressor(BlockCb cb, int level) :
+    m_impl(new ZstdCompressorImpl(cb, level))
 {}
 
 
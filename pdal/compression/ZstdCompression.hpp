@@ -43,7 +43,7 @@ class ZstdCompressorImpl;
 class ZstdCompressor : public Compressor
 {
 public:
-    PDAL_DLL ZstdCompressor(BlockCb cb);
+    PDAL_DLL ZstdCompressor(BlockCb cb, int level = 15);
     PDAL_DLL ~ZstdCompressor();
 
     PDAL_DLL void compress(const char *buf, size_t bufsize);
@@ -359,6 +359,14 @@ void fileTimes(const std::string& filename, struct tm *createTime,
 }
 
 
+std::time_t lastWriteTime(const std::string& path)
+{
+    pdalboost::system::error_code ec;
+    std::time_t t = pdalboost::filesystem::last_write_time(path, ec);
+    return ec ? 0 : t;
+}
+
+
 std::string extension(const std::string& filename)
 {
     auto idx = filename.find_last_of('.');
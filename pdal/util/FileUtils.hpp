@@ -37,6 +37,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <ctime>
 #include <istream>
 #include <ostream>
 #include <stdexcept>
@@ -225,6 +226,14 @@ namespace FileUtils
     PDAL_DLL void fileTimes(const std::string& filename, struct tm *createTime,
         struct tm *modTime);
 
+    /**
+      Get the time a file or directory was last modified.
+
+      \param path  Path to file or directory.
+      \return  Modification time, or 0 if it can't be determined.
+    */
+    PDAL_DLL std::time_t lastWriteTime(const std::string& path);
+
     /**
       Return the extension of the filename, including the separator (.).
 
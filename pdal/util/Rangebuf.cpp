@@ -0,0 +1,171 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include <pdal/util/Rangebuf.hpp>
+
+namespace pdal
+{
+
+Rangebuf::Rangebuf(uint64_t size, Fetch fetch, uint64_t blockSize) :
+    m_size(size), m_fetch(fetch), m_blockSize(std::max<uint64_t>(blockSize, 1)),
+    m_blockStart(0), m_fetched(0), m_requests(0)
+{
+    setg(nullptr, nullptr, nullptr);
+}
+
+
+// Position in the source of the get pointer.
+uint64_t Rangebuf::position() const
+{
+    return m_blockStart + (gptr() - eback());
+}
+
+
+// Move the get pointer.  Data is only fetched when it's read.
+void Rangebuf::setPosition(uint64_t pos)
+{
+    if (pos >= m_blockStart && pos <= m_blockStart + m_block.size() &&
+        m_block.size())
+    {
+        char *start = m_block.data();
+        setg(start, start + (pos - m_blockStart), start + m_block.size());
+    }
+    else
+    {
+        m_block.clear();
+        m_blockStart = pos;
+        setg(nullptr, nullptr, nullptr);
+    }
+}
+
+
+// Fetch a range of the source into the buffer.
+void Rangebuf::fill(uint64_t pos, uint64_t count)
+{
+    count = std::min(count, m_size - pos);
+    m_block = m_fetch(pos, count);
+    m_blockStart = pos;
+    m_fetched += m_block.size();
+    m_requests++;
+    if (m_block.empty())
+        setg(nullptr, nullptr, nullptr);
+    else
+    {
+        char *start = m_block.data();
+        setg(start, start, start + m_block.size());
+    }
+}
+
+
+Rangebuf::int_type Rangebuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    uint64_t pos = position();
+    if (pos >= m_size)
+        return traits_type::eof();
+    fill(pos, m_blockSize);
+    if (gptr() == egptr())
+        return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+}
+
+
+// Reads larger than the block size are fetched with a single request.
+std::streamsize Rangebuf::xsgetn(char *s, std::streamsize count)
+{
+    std::streamsize total = 0;
+    while (count > 0)
+    {
+        std::streamsize avail = egptr() - gptr();
+        if (avail == 0)
+        {
+            uint64_t pos = position();
+            if (pos >= m_size)
+                break;
+            fill(pos, std::max<uint64_t>(m_blockSize, (uint64_t)count));
+            avail = egptr() - gptr();
+            if (avail == 0)
+                break;
+        }
+        std::streamsize n = std::min(avail, count);
+        std::memcpy(s, gptr(), (size_t)n);
+        setg(eback(), gptr() + n, egptr());
+        s += n;
+        count -= n;
+        total += n;
+    }
+    return total;
+}
+
+
+Rangebuf::pos_type Rangebuf::seekpos(pos_type pos,
+    std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+
+Rangebuf::pos_type Rangebuf::seekoff(off_type off,
+    std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in))
+        return pos_type(off_type(-1));
+
+    off_type pos;
+    switch (dir)
+    {
+    case std::ios_base::beg:
+        pos = off;
+        break;
+    case std::ios_base::cur:
+        pos = (off_type)position() + off;
+        break;
+    case std::ios_base::end:
+        pos = (off_type)m_size + off;
+        break;
+    default:
+        return pos_type(off_type(-1));
+    }
+    if (pos < 0 || (uint64_t)pos > m_size)
+        return pos_type(off_type(-1));
+    setPosition((uint64_t)pos);
+    return pos_type(pos);
+}
+
+} // namespace pdal
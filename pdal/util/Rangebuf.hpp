@@ -0,0 +1,110 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <streambuf>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A read-only streambuf that fetches data in blocks through a callback
+  rather than reading an entire source.  This allows a seekable stream to
+  be built over a source that supports reads of byte ranges, like an
+  object store or HTTP server.  Only the blocks that are touched are
+  fetched.
+*/
+class PDAL_DLL Rangebuf : public std::streambuf
+{
+public:
+    /**
+      Function that fetches \a count bytes starting at \a offset.
+    */
+    using Fetch = std::function<std::vector<char>(uint64_t offset,
+        uint64_t count)>;
+
+    /**
+      Construct a Rangebuf.
+
+      \param size  Size of the source in bytes.
+      \param fetch  Function used to fetch byte ranges of the source.
+      \param blockSize  Number of bytes fetched by each request.
+    */
+    Rangebuf(uint64_t size, Fetch fetch, uint64_t blockSize = 1 << 20);
+
+    /**
+      Get the total number of bytes fetched.
+
+      \return  Number of bytes fetched.
+    */
+    uint64_t fetched() const
+        { return m_fetched; }
+
+    /**
+      Get the number of fetch requests made.
+
+      \return  Number of requests.
+    */
+    uint64_t requests() const
+        { return m_requests; }
+
+protected:
+    int_type underflow();
+    std::streamsize xsgetn(char *s, std::streamsize count);
+    pos_type seekpos(pos_type pos,
+        std::ios_base::openmode which = std::ios_base::in);
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which = std::ios_base::in);
+
+private:
+    uint64_t m_size;
+    Fetch m_fetch;
+    uint64_t m_blockSize;
+    std::vector<char> m_block;
+    uint64_t m_blockStart;
+    uint64_t m_fetched;
+    uint64_t m_requests;
+
+    uint64_t position() const;
+    void setPosition(uint64_t pos);
+    void fill(uint64_t pos, uint64_t count);
+};
+
+} // namespace pdal
@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A simple fixed-size pool of worker threads.  Tasks are queued with add()
+  and run on the first available thread.  await() blocks until all queued
+  tasks have completed.  A pool with a single thread runs tasks inline in
+  the calling thread.
+
+  Tasks may add further tasks to the pool.  Tasks must not call await().
+*/
+class PDAL_DLL ThreadPool
+{
+public:
+    /**
+      Create a thread pool.
+
+      \param numThreads  Number of worker threads.  If zero, the number of
+        hardware threads is used.
+    */
+    ThreadPool(std::size_t numThreads);
+    ~ThreadPool();
+
+    /**
+      Queue a task to run on a worker thread.
+
+      \param task  Task to run.
+    */
+    void add(std::function<void()> task);
+
+    /**
+      Wait for all queued and running tasks to complete.  If a task threw
+      an exception, the first such exception is rethrown.
+    */
+    void await();
+
+    /**
+      Return the number of threads in the pool.
+
+      \return  Number of worker threads.
+    */
+    std::size_t numThreads() const
+        { return m_numThreads; }
+
+    /**
+      Return the number of hardware threads, or one if it can't be
+      determined.
+
+      \return  Number of hardware threads.
+    */
+    static std::size_t hardwareThreads();
+
+private:
+    std::size_t m_numThreads;
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::size_t m_outstanding;
+    bool m_stop;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_produceCv;
+    std::condition_variable m_consumeCv;
+
+    void work();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+} // namespace pdal
@@ -32,6 +32,10 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <sstream>
+#include <thread>
+#include <vector>
+
 #include <pdal/pdal_test_main.hpp>
 #include <pdal/Log.hpp>
 #include <pdal/util/FileUtils.hpp>
@@ -86,4 +90,58 @@ TEST(Log, t2)
     FileUtils::deleteFile(out);
 }
 
+// Make sure that leaders pushed by one thread aren't seen or popped by
+// another.
+TEST(Log, threadLeaders)
+{
+    Log l("base", "devnull");
+
+    l.pushLeader("main");
+    std::string other;
+    std::thread t([&l, &other]()
+    {
+        l.pushLeader("other");
+        l.popLeader();
+        l.popLeader();
+        other = l.leader();
+    });
+    t.join();
+    EXPECT_EQ(other, "base");
+    EXPECT_EQ(l.leader(), "main");
+    l.popLeader();
+    EXPECT_EQ(l.leader(), "base");
+}
+
+// Make sure that messages written concurrently aren't interleaved.
+TEST(Log, concurrent)
+{
+    std::ostringstream out;
+    Log l("", &out);
+    l.setLevel(LogLevel::Debug);
+
+    l.setConcurrent(true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&l, t]()
+        {
+            for (int i = 0; i < 1000; ++i)
+                l.get(LogLevel::Debug) << "thread " << t << " message " <<
+                    i << std::endl;
+        });
+    for (auto& t : threads)
+        t.join();
+    l.setConcurrent(false);
+
+    std::istringstream in(out.str());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(in, line))
+    {
+        EXPECT_EQ(line.find("(Debug) thread "), 0u);
+        EXPECT_EQ(line.find("(", 1), std::string::npos);
+        count++;
+    }
+    EXPECT_EQ(count, 4000u);
+}
+
 }
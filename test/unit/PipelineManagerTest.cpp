@@ -198,3 +198,43 @@ TEST(PipelineManagerTest, replace)
     EXPECT_EQ(w2->getInputs().size(), 1U);
     EXPECT_EQ(w2->getInputs().front(), f2);
 }
+
+TEST(PipelineManagerTest, threads)
+{
+    // The views refer to their manager's point table, so the managers must
+    // outlive them.
+    auto run = [](PipelineManager& mgr, size_t threads) -> PointViewPtr
+    {
+        Stage& merge = mgr.makeFilter("filters.merge");
+        for (auto file : { "las/1.2-with-color.las", "las/100-points.las",
+            "las/simple.las" })
+        {
+            Stage& r = mgr.makeReader(Support::datapath(file), "readers.las");
+            Options opts;
+            opts.add("dimension", "Z");
+            opts.add("order", "DESC");
+            Stage& f = mgr.makeFilter("filters.sort", r, opts);
+            merge.setInput(f);
+        }
+        mgr.setThreads(threads);
+        mgr.execute();
+
+        PointViewSet s = mgr.views();
+        EXPECT_EQ(s.size(), 1U);
+        return *s.begin();
+    };
+
+    PipelineManager mgr1;
+    PipelineManager mgr4;
+    PointViewPtr v1 = run(mgr1, 1);
+    PointViewPtr v4 = run(mgr4, 4);
+    EXPECT_EQ(v1->size(), 1065U + 100U + 1065U);
+    ASSERT_EQ(v1->size(), v4->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, i),
+            v4->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Z, i),
+            v4->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+}
@@ -40,6 +40,11 @@
 #include <pdal/pdal_config.hpp>
 #include <pdal/Filter.hpp>
 #include <pdal/util/Algorithm.hpp>
+#include <pdal/util/FileUtils.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <thread>
 
 #include "Support.hpp"
 
@@ -116,5 +121,73 @@ TEST(PluginManagerTest, SearchPaths)
         Utils::setenv("PDAL_DRIVER_PATH", curPath);
 }
 
+// Plugins are found through a manifest unless the plugin directory has
+// changed since the manifest was written.
+TEST(PluginManagerTest, Manifest)
+{
+#if defined(_WIN32)
+    std::string ext(".dll");
+#elif defined(__APPLE__)
+    std::string ext(".dylib");
+#else
+    std::string ext(".so");
+#endif
+
+    std::string curPath;
+    int set = Utils::getenv("PDAL_DRIVER_PATH", curPath);
+
+    std::string dir(Support::temppath("plugin_manifest"));
+    FileUtils::deleteDirectory(dir);
+    FileUtils::createDirectory(dir);
+    Utils::setenv("PDAL_DRIVER_PATH", dir);
+
+    std::string reader("libpdal_plugin_reader_manifesttest" + ext);
+    auto writeManifest = [&dir, &reader]()
+    {
+        std::ofstream out(dir + "/pdal_plugins.json");
+        out << "{ \"plugins\": [ { \"name\": \"readers.manifesttest\", "
+            "\"library\": \"" << reader << "\", "
+            "\"extensions\": [ \"mtest\" ] } ] }";
+    };
+
+    // Creating the manifest changes the directory, so the manifest isn't
+    // used until it's been rewritten in a later second.  Modification
+    // times have a resolution of a second on some systems.
+    writeManifest();
+    {
+        PluginDirectory d;
+        EXPECT_TRUE(d.m_drivers.empty());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    writeManifest();
+
+    {
+        PluginDirectory d;
+        EXPECT_EQ(d.m_drivers.size(), 1U);
+        EXPECT_EQ(d.m_drivers["readers.manifesttest"],
+            FileUtils::toAbsolutePath(reader, dir));
+        EXPECT_EQ(d.m_extensions["readers.manifesttest"],
+            StringList { "mtest" });
+    }
+
+    // A plugin added in the same second the manifest was written makes
+    // the manifest stale.
+    std::string filter("libpdal_plugin_filter_manifesttest" + ext);
+    std::ofstream(dir + "/" + filter);
+
+    {
+        PluginDirectory d;
+        EXPECT_EQ(d.m_drivers.size(), 1U);
+        EXPECT_EQ(d.m_drivers.count("filters.manifesttest"), 1U);
+        EXPECT_TRUE(d.m_extensions.empty());
+    }
+
+    FileUtils::deleteDirectory(dir);
+    if (set == 0)
+        Utils::setenv("PDAL_DRIVER_PATH", curPath);
+    else
+        Utils::unsetenv("PDAL_DRIVER_PATH");
+}
+
 } // namespace pdal
 
@@ -0,0 +1,92 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <istream>
+#include <numeric>
+
+#include <pdal/util/Rangebuf.hpp>
+
+using namespace pdal;
+
+TEST(RangebufTest, read)
+{
+    std::vector<char> src(10000);
+    std::iota(src.begin(), src.end(), 0);
+
+    auto fetch = [&src](uint64_t offset, uint64_t count)
+    {
+        return std::vector<char>(src.begin() + offset,
+            src.begin() + offset + count);
+    };
+
+    Rangebuf buf(src.size(), fetch, 100);
+    std::istream in(&buf);
+
+    // Only the blocks that are read are fetched.
+    in.seekg(5000);
+    char c;
+    in.get(c);
+    EXPECT_EQ(c, src[5000]);
+    EXPECT_EQ(buf.requests(), 1u);
+    EXPECT_EQ(buf.fetched(), 100u);
+
+    // Reads within a block don't fetch.
+    in.seekg(5050);
+    in.get(c);
+    EXPECT_EQ(c, src[5050]);
+    EXPECT_EQ(buf.requests(), 1u);
+
+    // Large reads are fetched with one request.
+    std::vector<char> data(1000);
+    in.seekg(8000);
+    in.read(data.data(), data.size());
+    EXPECT_EQ(in.gcount(), 1000);
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), src.begin() + 8000));
+    EXPECT_EQ(buf.requests(), 2u);
+    EXPECT_EQ(in.tellg(), 9000);
+
+    // Reads stop at the end of the source.
+    in.seekg(9950);
+    in.read(data.data(), data.size());
+    EXPECT_EQ(in.gcount(), 50);
+    EXPECT_TRUE(in.eof());
+
+    in.clear();
+    in.seekg(-10, std::ios::end);
+    EXPECT_EQ(in.tellg(), 9990);
+    in.seekg(20000);
+    EXPECT_TRUE(in.fail());
+}
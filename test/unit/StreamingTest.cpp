@@ -106,3 +106,73 @@ TEST(Streaming, filter)
     f.execute(t);
     EXPECT_EQ(cnt, 400);
 }
+
+// Make sure that a stage feeding more than one branch runs once and that
+// each branch sees the points as they were before any other branch ran.
+TEST(Streaming, fanout)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 99, 99, 99));
+    ro.add("mode", "ramp");
+    ro.add("count", 100);
+    FauxReader r;
+    r.setOptions(ro);
+
+    StreamCallbackFilter shared;
+    int sharedCnt = 0;
+    shared.setCallback([&sharedCnt](PointRef&)
+    {
+        sharedCnt++;
+        return true;
+    });
+    shared.setInput(r);
+
+    // Move and drop half the points.
+    StreamCallbackFilter a;
+    int aCnt = 0;
+    a.setCallback([&aCnt](PointRef& point)
+    {
+        int x = point.getFieldAs<int>(Dimension::Id::X);
+        EXPECT_EQ(x, point.getFieldAs<int>(Dimension::Id::Y));
+        point.setField(Dimension::Id::X, x + 1000);
+        aCnt++;
+        return x % 2 == 0;
+    });
+    a.setInput(shared);
+
+    StreamCallbackFilter b;
+    int bCnt = 0;
+    b.setCallback([&bCnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X),
+            point.getFieldAs<int>(Dimension::Id::Y));
+        bCnt++;
+        return true;
+    });
+    b.setInput(shared);
+
+    MergeFilter m;
+    m.setInput(a);
+    m.setInput(b);
+
+    StreamCallbackFilter f;
+    int moved = 0;
+    int cnt = 0;
+    f.setCallback([&moved, &cnt](PointRef& point)
+    {
+        if (point.getFieldAs<int>(Dimension::Id::X) >= 1000)
+            moved++;
+        cnt++;
+        return true;
+    });
+    f.setInput(m);
+
+    FixedPointTable t(20);
+    f.prepare(t);
+    f.execute(t);
+    EXPECT_EQ(sharedCnt, 100);
+    EXPECT_EQ(aCnt, 100);
+    EXPECT_EQ(bCnt, 100);
+    EXPECT_EQ(moved, 50);
+    EXPECT_EQ(cnt, 150);
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <pdal/util/ThreadPool.hpp>
+
+using namespace pdal;
+
+TEST(ThreadPoolTest, run)
+{
+    for (size_t threads : { 1, 4 })
+    {
+        ThreadPool pool(threads);
+        EXPECT_EQ(pool.numThreads(), threads);
+
+        std::atomic<int> count(0);
+        for (int i = 0; i < 1000; ++i)
+            pool.add([&count](){ count++; });
+        pool.await();
+        EXPECT_EQ(count, 1000);
+
+        // Tasks that add tasks.
+        count = 0;
+        std::function<void(int)> recurse = [&](int depth)
+        {
+            count++;
+            if (depth)
+            {
+                pool.add([&recurse, depth](){ recurse(depth - 1); });
+                pool.add([&recurse, depth](){ recurse(depth - 1); });
+            }
+        };
+        pool.add([&recurse](){ recurse(9); });
+        pool.await();
+        EXPECT_EQ(count, 1023);
+    }
+}
+
+TEST(ThreadPoolTest, error)
+{
+    for (size_t threads : { 1, 4 })
+    {
+        ThreadPool pool(threads);
+
+        pool.add([](){ throw std::runtime_error("Task error."); });
+        EXPECT_THROW(pool.await(), std::runtime_error);
+
+        // The error is cleared once reported.
+        pool.add([](){});
+        EXPECT_NO_THROW(pool.await());
+    }
+}
@@ -0,0 +1,103 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc., (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+std::string appName()
+{
+    return Support::binpath("pdal diff");
+}
+
+} // unnamed namespace
+
+TEST(Diff, same)
+{
+    std::string file(Support::datapath("las/simple.las"));
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(appName() + " " + file + " " + file,
+        output), 0);
+    EXPECT_EQ(output, "");
+}
+
+TEST(Diff, count)
+{
+    std::string cmd = appName() + " " + Support::datapath("las/simple.las") +
+        " " + Support::datapath("las/100-points.las");
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 1);
+    EXPECT_NE(output.find("count.error"), std::string::npos);
+}
+
+// Points that differ by less than the tolerance are equal, and the points
+// reported don't depend on the number of threads.
+TEST(Diff, tolerance)
+{
+    std::string source(Support::datapath("las/simple.las"));
+    std::string candidate(Support::temppath("diff_tolerance.las"));
+
+    FileUtils::deleteFile(candidate);
+    std::string output;
+    std::string cmd = Support::binpath("pdal translate") + " " + source +
+        " " + candidate + " --writers.las.forward=all " +
+        "--writers.las.scale_x=0.1 --writers.las.scale_y=0.1 " +
+        "--writers.las.scale_z=0.1";
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+
+    cmd = appName() + " " + source + " " + candidate;
+
+    std::string output1;
+    EXPECT_EQ(Utils::run_shell_command(cmd + " --threads=1", output1), 1);
+    EXPECT_NE(output1.find("data.error"), std::string::npos);
+
+    std::string output2;
+    EXPECT_EQ(Utils::run_shell_command(cmd + " --threads=4", output2), 1);
+    EXPECT_EQ(output1, output2);
+
+    std::string output3;
+    Utils::run_shell_command(cmd + " --tolerance=0.06", output3);
+    EXPECT_EQ(output3.find("data.error"), std::string::npos);
+
+    FileUtils::deleteFile(candidate);
+}
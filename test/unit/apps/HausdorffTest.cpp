@@ -32,6 +32,8 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <algorithm>
+#include <limits>
 #include <string>
 
 #include <pdal/pdal_test_main.hpp>
@@ -92,3 +94,58 @@ TEST(Hausdorff, distance)
 
     EXPECT_EQ(std::sqrt(6.0), Utils::computeHausdorff(src, cand));
 }
+
+// Compare with brute force over enough points to use several chunks.
+TEST(Hausdorff, directed)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Y);
+    layout->registerDim(Id::Z);
+
+    PointViewPtr src(new PointView(table));
+    for (PointId i = 0; i < 150000; ++i)
+    {
+        src->setField(Id::X, i, (double)(i % 500));
+        src->setField(Id::Y, i, (double)(i / 500));
+        src->setField(Id::Z, i, (double)((i * 7919) % 13));
+    }
+
+    PointViewPtr cand(new PointView(table));
+    for (PointId i = 0; i < 300; ++i)
+    {
+        cand->setField(Id::X, i, (double)((i * 37) % 500));
+        cand->setField(Id::Y, i, (double)((i * 53) % 300));
+        cand->setField(Id::Z, i, 5.0);
+    }
+
+    std::vector<double> dists;
+    for (PointId i = 0; i < src->size(); ++i)
+    {
+        double best = (std::numeric_limits<double>::max)();
+        for (PointId j = 0; j < cand->size(); ++j)
+        {
+            double dx = src->getFieldAs<double>(Id::X, i) -
+                cand->getFieldAs<double>(Id::X, j);
+            double dy = src->getFieldAs<double>(Id::Y, i) -
+                cand->getFieldAs<double>(Id::Y, j);
+            double dz = src->getFieldAs<double>(Id::Z, i) -
+                cand->getFieldAs<double>(Id::Z, j);
+            best = (std::min)(best, dx * dx + dy * dy + dz * dz);
+        }
+        dists.push_back(std::sqrt(best));
+    }
+    std::sort(dists.begin(), dists.end());
+
+    for (size_t threads : { 1, 4 })
+    {
+        EXPECT_DOUBLE_EQ(dists.back(),
+            Utils::computeDirectedHausdorff(src, cand, 100, threads));
+        EXPECT_DOUBLE_EQ(dists[dists.size() * 9 / 10 - 1],
+            Utils::computeDirectedHausdorff(src, cand, 90, threads));
+    }
+}
@@ -0,0 +1,237 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <fstream>
+#include <string>
+
+#include <pdal/pdal_test_main.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+#include <pdal/util/Utils.hpp>
+#include <io/LasIndex.hpp>
+#include <io/LasReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// The table holds the points of the view, so it must outlive the view.
+PointViewPtr readBounds(const std::string& filename, bool useIndex,
+    PointTableRef t)
+{
+    Options o;
+    o.add("filename", filename);
+    o.add("bounds", "([636200, 636400], [849000, 849200])");
+    o.add("use_index", useIndex);
+
+    LasReader r;
+    r.setOptions(o);
+
+    r.prepare(t);
+    PointViewSet s = r.execute(t);
+    EXPECT_EQ(s.size(), 1u);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(IndexTest, query)
+{
+    LasIndex index(BOX2D(0, 0, 100, 100), 4000, 10);
+    EXPECT_EQ(index.numCells(), 100u);
+
+    // Points are added in runs of 1000 in each corner cell.
+    for (PointId i = 0; i < 4000; ++i)
+    {
+        double x = (i / 1000) % 2 ? 95 : 5;
+        double y = (i / 2000) ? 95 : 5;
+        index.add(i, x, y);
+    }
+
+    std::vector<LasIndex::Range> ranges = index.query(BOX2D(0, 0, 9, 9));
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].second, 1000u);
+
+    ranges = index.query(BOX2D(0, 0, 100, 9));
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].second, 2000u);
+
+    ranges = index.query(BOX2D(90, 0, 100, 100));
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].first, 1000u);
+    EXPECT_EQ(ranges[1].first, 3000u);
+
+    ranges = index.query(BOX2D(40, 40, 60, 60));
+    EXPECT_EQ(ranges.size(), 0u);
+
+    // Roundtrip through a file.
+    std::string filename(Support::temppath("index.pdx"));
+    {
+        OLeStream out(filename);
+        index.write(out);
+    }
+    LasIndex index2;
+    ILeStream in(filename);
+    index2.read(in);
+    EXPECT_EQ(index2.numPoints(), 4000u);
+    EXPECT_EQ(index2.numCells(), 100u);
+    EXPECT_EQ(index2.query(BOX2D(90, 0, 100, 100)), index.query(
+        BOX2D(90, 0, 100, 100)));
+    FileUtils::deleteFile(filename);
+}
+
+TEST(IndexTest, kernel)
+{
+    std::string filename(Support::temppath("indexed.las"));
+    std::string indexFilename(LasIndex::filename(filename));
+    {
+        std::ifstream in(Support::datapath("las/autzen_trim.las"),
+            std::ios::binary);
+        std::ofstream out(filename, std::ios::binary);
+        out << in.rdbuf();
+    }
+    FileUtils::deleteFile(indexFilename);
+
+    PointTable fullTable;
+    PointViewPtr full = readBounds(filename, true, fullTable);
+    EXPECT_GT(full->size(), 0u);
+
+    const std::string cmd = Support::binpath("pdal") + " index " +
+        filename + " --cell_size=50";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    ASSERT_TRUE(FileUtils::fileExists(indexFilename));
+
+    LasIndex index;
+    {
+        ILeStream in(indexFilename);
+        index.read(in);
+    }
+    EXPECT_EQ(index.numPoints(), 110000u);
+    point_count_t count = 0;
+    for (auto& r : index.query(BOX2D(636200, 849000, 636400, 849200)))
+        count += r.second - r.first;
+    EXPECT_LT(count, 110000u);
+
+    // Reading with the index must give the same points.
+    PointTable indexedTable;
+    PointViewPtr indexed = readBounds(filename, true, indexedTable);
+    PointTable scannedTable;
+    PointViewPtr scanned = readBounds(filename, false, scannedTable);
+    ASSERT_EQ(indexed->size(), full->size());
+    ASSERT_EQ(scanned->size(), full->size());
+    for (PointId i = 0; i < indexed->size(); ++i)
+    {
+        EXPECT_EQ(indexed->getFieldAs<double>(Dimension::Id::X, i),
+            scanned->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(indexed->getFieldAs<double>(Dimension::Id::Y, i),
+            scanned->getFieldAs<double>(Dimension::Id::Y, i));
+    }
+
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(indexFilename);
+}
+
+// An index isn't used once its file has been rewritten, even if the number
+// of points is the same.
+TEST(IndexTest, stale)
+{
+    std::string filename(Support::temppath("stale.las"));
+    std::string indexFilename(LasIndex::filename(filename));
+    std::string shifted(Support::temppath("shifted.las"));
+
+    auto copy = [](const std::string& src, const std::string& dst)
+    {
+        std::ifstream in(src, std::ios::binary);
+        std::ofstream out(dst, std::ios::binary);
+        out << in.rdbuf();
+    };
+
+    // Write the points moved 100 units in X and Y.
+    {
+        StageFactory f;
+        Stage *r = f.createStage("readers.las");
+        Options ro;
+        ro.add("filename", Support::datapath("las/autzen_trim.las"));
+        r->setOptions(ro);
+
+        Stage *t = f.createStage("filters.transformation");
+        Options to;
+        to.add("matrix", "1 0 0 100  0 1 0 100  0 0 1 0  0 0 0 1");
+        t->setOptions(to);
+        t->setInput(*r);
+
+        Stage *w = f.createStage("writers.las");
+        Options wo;
+        wo.add("filename", shifted);
+        wo.add("forward", "all");
+        w->setOptions(wo);
+        w->setInput(*t);
+
+        PointTable table;
+        w->prepare(table);
+        w->execute(table);
+    }
+
+    copy(Support::datapath("las/autzen_trim.las"), filename);
+    const std::string cmd = Support::binpath("pdal") + " index " +
+        filename + " --cell_size=50";
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    ASSERT_TRUE(FileUtils::fileExists(indexFilename));
+
+    // Replace the indexed file with the moved points.
+    copy(shifted, filename);
+
+    PointTable indexedTable;
+    PointViewPtr indexed = readBounds(filename, true, indexedTable);
+    PointTable scannedTable;
+    PointViewPtr scanned = readBounds(filename, false, scannedTable);
+    EXPECT_GT(scanned->size(), 0u);
+    ASSERT_EQ(indexed->size(), scanned->size());
+    for (PointId i = 0; i < indexed->size(); ++i)
+        EXPECT_EQ(indexed->getFieldAs<double>(Dimension::Id::X, i),
+            scanned->getFieldAs<double>(Dimension::Id::X, i));
+
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(indexFilename);
+    FileUtils::deleteFile(shifted);
+}
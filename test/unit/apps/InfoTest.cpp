@@ -0,0 +1,112 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc., (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+std::string appName()
+{
+    return Support::binpath("pdal info");
+}
+
+} // unnamed namespace
+
+// Multiple files produce one document per file, in the order given,
+// regardless of the number of threads.
+TEST(Info, batch)
+{
+    std::string file1(Support::datapath("las/utm15.las"));
+    std::string file2(Support::datapath("las/utm17.las"));
+    std::string missing(Support::datapath("las/missing.las"));
+
+    std::string cmd = appName() + " --summary " + file1 + " " + missing +
+        " " + file2 + " 2>/dev/null";
+
+    for (std::string threads : { "1", "3" })
+    {
+        std::string output;
+        EXPECT_EQ(Utils::run_shell_command(cmd + " --threads=" + threads,
+            output), 1);
+
+        std::string::size_type pos1 = output.find("utm15.las");
+        std::string::size_type pos2 = output.find("missing.las");
+        std::string::size_type pos3 = output.find("utm17.las");
+        EXPECT_NE(pos1, std::string::npos);
+        EXPECT_LT(pos1, pos2);
+        EXPECT_LT(pos2, pos3);
+        EXPECT_NE(pos3, std::string::npos);
+        EXPECT_NE(output.find("\"error\""), std::string::npos);
+        EXPECT_NE(output.find("\"num_points\": 1"), std::string::npos);
+    }
+}
+
+TEST(Info, batch_glob)
+{
+    std::string cmd = appName() + " --summary \"" +
+        Support::datapath("las/utm1*.las") + "\"";
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    std::string::size_type pos1 = output.find("utm15.las");
+    std::string::size_type pos2 = output.find("utm17.las");
+    EXPECT_NE(pos2, std::string::npos);
+    EXPECT_LT(pos1, pos2);
+}
+
+// Options that write a single output file can't be used with a glob that
+// matches several files.
+TEST(Info, batch_glob_single_output)
+{
+    std::string outfile(Support::temppath("info_pipeline.json"));
+    FileUtils::deleteFile(outfile);
+
+    std::string cmd = appName() + " --summary \"" +
+        Support::datapath("las/utm1*.las") + "\" --pipeline-serialization " +
+        outfile + " 2>&1";
+
+    std::string output;
+    EXPECT_NE(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_NE(output.find("--pipeline-serialization option incompatible"),
+        std::string::npos);
+    EXPECT_FALSE(FileUtils::fileExists(outfile));
+}
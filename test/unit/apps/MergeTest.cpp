@@ -84,6 +84,30 @@ TEST(Merge, Simple)
 }
 
 
+// Inputs with different spatial references are reported before any
+// points are read.
+TEST(Merge, SpatialReference)
+{
+    std::string file1(Support::datapath("las/utm15.las"));
+    std::string file2(Support::datapath("las/utm17.las"));
+    std::string outfile(Support::temppath("out.las"));
+    std::string cmd = appName() + " " + file1 + " " + file1 + " " + outfile +
+        " 2>&1";
+
+    std::string output;
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_EQ(output.find("different spatial reference"), std::string::npos);
+    EXPECT_EQ(output.find("multiple point spatial references"),
+        std::string::npos);
+
+    cmd = appName() + " " + file1 + " " + file2 + " " + outfile + " 2>&1";
+    EXPECT_EQ(Utils::run_shell_command(cmd, output), 0);
+    EXPECT_NE(output.find("different spatial reference"), std::string::npos);
+
+    FileUtils::deleteFile(outfile);
+}
+
+
 TEST(Merge, Args)
 {
     std::string file1(Support::datapath("las/utm15.las"));
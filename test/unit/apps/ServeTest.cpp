@@ -0,0 +1,102 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <fstream>
+
+#include <json/json.h>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+// Each request gets a response with its id.  Bad requests get responses
+// with errors and don't stop the server.
+TEST(Serve, requests)
+{
+    std::string requestFile(Support::temppath("serve_requests.txt"));
+    {
+        Json::FastWriter w;
+        std::ofstream out(requestFile);
+
+        Json::Value good;
+        good["id"] = 1;
+        good["pipeline"].append(Support::datapath("las/simple.las"));
+        out << w.write(good);
+
+        Json::Value missing;
+        missing["id"] = 2;
+        missing["pipeline"] = Support::datapath("pipeline/missing.json");
+        out << w.write(missing);
+
+        out << "not a request\n";
+
+        Json::Value noPipeline;
+        noPipeline["id"] = "four";
+        out << w.write(noPipeline);
+    }
+
+    for (std::string threads : { "1", "3" })
+    {
+        std::string output;
+        EXPECT_EQ(Utils::run_shell_command(Support::binpath("pdal serve") +
+            " --threads=" + threads + " < " + requestFile, output), 0);
+
+        StringList lines = Utils::split2(output, '\n');
+        EXPECT_EQ(lines.size(), 4u);
+
+        size_t errors = 0;
+        for (auto& line : lines)
+        {
+            Json::Reader reader;
+            Json::Value response;
+            EXPECT_TRUE(reader.parse(line, response));
+            if (response.isMember("error"))
+            {
+                errors++;
+                continue;
+            }
+            EXPECT_EQ(response["id"].asInt(), 1);
+            EXPECT_EQ(response["metadata"]["stages"]["readers.las"]
+                ["count"].asUInt64(), 1065u);
+        }
+        EXPECT_EQ(errors, 3u);
+        EXPECT_NE(output.find("\"id\":\"four\""), std::string::npos);
+    }
+    FileUtils::deleteFile(requestFile);
+}
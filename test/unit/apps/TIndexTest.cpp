@@ -36,6 +36,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
 #include <pdal/util/FileUtils.hpp>
 
 #include "Support.hpp"
@@ -144,3 +146,82 @@ TEST(TIndex, test3)
     EXPECT_NE(pos, std::string::npos);
 }
 
+
+// Files scanned concurrently are all indexed, and rerunning the command
+// skips files that are already in the index.
+TEST(TIndex, threads)
+{
+    std::string inSpec(Support::datapath("tindex/*.txt"));
+    std::string outSpec(Support::temppath("tindex.out"));
+    std::string outPoints(Support::temppath("points.txt"));
+
+    std::string cmd = Support::binpath("pdal") + " --verbose=debug tindex " +
+        outSpec + " \"" + inSpec + "\" --threads=3 --batch_size=2 2>&1";
+
+    FileUtils::deleteDirectory(outSpec);
+
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+    EXPECT_EQ(output.find("Skipping indexed file"), std::string::npos);
+
+    Utils::run_shell_command(cmd, output);
+    EXPECT_EQ(output.find("Indexed file"), std::string::npos);
+    EXPECT_NE(output.find("Skipping indexed file"), std::string::npos);
+
+    cmd = Support::binpath("pdal") + " --verbose=info tindex --merge " +
+        outSpec + " " + outPoints + " --log=stdout "
+        "--bounds=\"([1.25, 3],[1.25, 3])\"";
+
+    FileUtils::deleteFile(outPoints);
+    Utils::run_shell_command(cmd, output);
+    EXPECT_NE(output.find("Merge filecount: 3"), std::string::npos);
+}
+
+// Files read concurrently give the same points, in the same order, as
+// files read one at a time.
+TEST(TIndex, reader_threads)
+{
+    std::string inSpec(Support::datapath("tindex/*.txt"));
+    std::string outSpec(Support::temppath("tindex.out"));
+
+    FileUtils::deleteDirectory(outSpec);
+    std::string cmd = Support::binpath("pdal") + " tindex " +
+        outSpec + " \"" + inSpec + "\"";
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+
+    auto read = [&outSpec](size_t threads, const std::string& bounds)
+    {
+        Options opts;
+        opts.add("filename", outSpec);
+        opts.add("lyr_name", "tindex");
+        opts.add("threads", threads);
+        if (bounds.size())
+            opts.add("bounds", bounds);
+
+        StageFactory f;
+        Stage *r = f.createStage("readers.tindex");
+        r->setOptions(opts);
+
+        PointTable t;
+        r->prepare(t);
+        PointViewSet s = r->execute(t);
+        EXPECT_EQ(s.size(), 1u);
+
+        std::vector<double> xy;
+        PointViewPtr v = *s.begin();
+        for (PointId idx = 0; idx < v->size(); ++idx)
+        {
+            xy.push_back(v->getFieldAs<double>(Dimension::Id::X, idx));
+            xy.push_back(v->getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+        return xy;
+    };
+
+    std::vector<double> serial = read(1, "");
+    EXPECT_EQ(serial.size(), 24u);
+    EXPECT_EQ(read(3, ""), serial);
+
+    serial = read(1, "([1.25, 2.5],[1.25, 2.5])");
+    EXPECT_EQ(read(3, "([1.25, 2.5],[1.25, 2.5])"), serial);
+}
@@ -35,6 +35,7 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <pdal/Options.hpp>
+#include <pdal/StageFactory.hpp>
 #include <pdal/StageWrapper.hpp>
 #include <filters/ChipperFilter.hpp>
 #include <io/LasWriter.hpp>
@@ -120,6 +121,57 @@ TEST(ChipperTest, empty_buffer)
     EXPECT_EQ(viewSet.size(), 0u);
 }
 
+// Make sure that chipping on multiple threads gives the same chips, in the
+// same order, as chipping on a single thread.
+TEST(ChipperTest, threads)
+{
+    StageFactory f;
+    Stage *reader = f.createStage("readers.faux");
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+    readerOps.add("count", 250000);
+    readerOps.add("mode", "random");
+    reader->setOptions(readerOps);
+
+    PointTable table;
+    reader->prepare(table);
+    PointViewSet viewSet = reader->execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    auto chip = [&table, &view](size_t threads)
+    {
+        Options ops;
+        ops.add("capacity", 1000);
+        ops.add("threads", threads);
+
+        ChipperFilter chipper;
+        chipper.setOptions(ops);
+        chipper.prepare(table);
+        StageWrapper::ready(chipper, table);
+        PointViewSet viewSet = StageWrapper::run(chipper, view);
+        StageWrapper::done(chipper, table);
+        return std::vector<PointViewPtr>(viewSet.begin(), viewSet.end());
+    };
+
+    std::vector<PointViewPtr> serial = chip(1);
+    std::vector<PointViewPtr> parallel = chip(4);
+    EXPECT_EQ(serial.size(), 250u);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        PointViewPtr v1 = serial[i];
+        PointViewPtr v2 = parallel[i];
+        ASSERT_EQ(v1->size(), v2->size());
+        for (PointId idx = 0; idx < v1->size(); ++idx)
+        {
+            EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, idx),
+                v2->getFieldAs<double>(Dimension::Id::X, idx));
+            EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Y, idx),
+                v2->getFieldAs<double>(Dimension::Id::Y, idx));
+        }
+    }
+}
+
 //ABELL
 /**
 TEST(ChipperTest, test_ordering)
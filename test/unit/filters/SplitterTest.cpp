@@ -34,8 +34,11 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <set>
+
 #include <pdal/StageFactory.hpp>
 #include <pdal/StageWrapper.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <io/LasReader.hpp>
 #include <filters/SplitterFilter.hpp>
 #include "Support.hpp"
@@ -177,3 +180,62 @@ TEST(SplitterTest, test_buffer)
         EXPECT_EQ(view->size(), counts[i]);
     }
 }
+
+TEST(SplitterTest, stream)
+{
+    std::string pattern(Support::temppath("splitter_stream_#.las"));
+    for (const std::string& f :
+        FileUtils::glob(Support::temppath("splitter_stream_*.las")))
+        FileUtils::deleteFile(f);
+
+    Options readerOptions;
+    readerOptions.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(readerOptions);
+
+    Options splitterOptions;
+    splitterOptions.add("length", 1000);
+    splitterOptions.add("filename", pattern);
+    // Force spilling and eviction of open spill files.
+    splitterOptions.add("spill_points", 10);
+    splitterOptions.add("max_open", 3);
+
+    SplitterFilter splitter;
+    splitter.setOptions(splitterOptions);
+    splitter.setInput(reader);
+    EXPECT_TRUE(splitter.pipelineStreamable());
+
+    FixedPointTable table(100);
+    splitter.prepare(table);
+    splitter.execute(table);
+
+    std::vector<std::string> files =
+        FileUtils::glob(Support::temppath("splitter_stream_*.las"));
+    EXPECT_EQ(files.size(), 24u);
+
+    // Counts should match those from the standard-mode test.
+    std::multiset<point_count_t> expected {24, 25, 2, 26, 27, 10, 82, 68,
+        43, 57, 7, 71, 73, 61, 33, 84, 74, 4, 59, 70, 67, 34, 60, 4 };
+    std::multiset<point_count_t> counts;
+    for (const std::string& f : files)
+    {
+        Options ops;
+        ops.add("filename", f);
+        LasReader r;
+        r.setOptions(ops);
+
+        PointTable t;
+        r.prepare(t);
+        PointViewSet s = r.execute(t);
+        PointViewPtr v = *s.begin();
+
+        BOX2D b;
+        v->calculateBounds(b);
+        EXPECT_TRUE(b.maxx - b.minx <= 1000);
+        EXPECT_TRUE(b.maxy - b.miny <= 1000);
+        counts.insert(v->size());
+        EXPECT_FALSE(FileUtils::fileExists(f + ".spill"));
+        FileUtils::deleteFile(f);
+    }
+    EXPECT_EQ(counts, expected);
+}
@@ -304,3 +304,259 @@ TEST(Stats, global)
 	EXPECT_DOUBLE_EQ(statsZ.maximum(), 1000.0);
 
 }
+
+TEST(Stats, approximate)
+{
+    BOX3D bounds(0.0, 0.0, 0.0, 100.0, 100.0, 1000.0);
+    Options ops;
+    ops.add("bounds", bounds);
+    ops.add("count", 100000);
+    ops.add("mode", "uniform");
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options exactOps;
+    exactOps.add("dimensions", "Z");
+    exactOps.add("global", "Z");
+    exactOps.add("quantiles", "0.05,0.95");
+
+    StatsFilter exact;
+    exact.setInput(reader);
+    exact.setOptions(exactOps);
+
+    Options approxOps(exactOps);
+    approxOps.add("approximate", true);
+
+    StatsFilter approx;
+    approx.setInput(exact);
+    approx.setOptions(approxOps);
+
+    PointTable table;
+    approx.prepare(table);
+    approx.execute(table);
+
+    const stats::Summary& e = exact.getStats(Dimension::Id::Z);
+    const stats::Summary& a = approx.getStats(Dimension::Id::Z);
+
+    // The filters compute global stats when metadata is extracted.
+    EXPECT_NEAR(e.median(), a.median(), 5.0);
+    EXPECT_NEAR(e.mad(), a.mad(), 5.0);
+    ASSERT_EQ(e.quantileValues().size(), 2u);
+    ASSERT_EQ(a.quantileValues().size(), 2u);
+    EXPECT_NEAR(e.quantileValues()[0], a.quantileValues()[0], 2.0);
+    EXPECT_NEAR(e.quantileValues()[1], a.quantileValues()[1], 2.0);
+    EXPECT_NEAR(e.quantileValues()[0], 50.0, 5.0);
+    EXPECT_NEAR(e.quantileValues()[1], 950.0, 5.0);
+
+    MetadataNode m = approx.getMetadata();
+    MetadataNode q = m.findChild("statistic:quantiles");
+    EXPECT_TRUE(q.valid());
+}
+
+TEST(Stats, approximate_stream)
+{
+    BOX3D bounds(1.0, 0.0, 0.0, 10.0, 100.0, 1000.0);
+    Options ops;
+    ops.add("bounds", bounds);
+    ops.add("count", 10);
+    ops.add("mode", "ramp");
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options filterOps;
+    filterOps.add("dimensions", "X, Y, Z");
+    filterOps.add("global", "Z");
+    filterOps.add("approximate", true);
+    filterOps.add("cardinality", "X");
+
+    StatsFilter filter;
+    filter.setInput(reader);
+    filter.setOptions(filterOps);
+    EXPECT_TRUE(filter.pipelineStreamable());
+
+    FixedPointTable table(4);
+    filter.prepare(table);
+    filter.execute(table);
+
+    // The sketch interpolates between the two middle values.
+    const stats::Summary& statsZ = filter.getStats(Dimension::Id::Z);
+    EXPECT_DOUBLE_EQ(statsZ.median(), 500.0);
+    EXPECT_GE(statsZ.mad(), 222.2);
+    EXPECT_LE(statsZ.mad(), 333.4);
+
+    const stats::Summary& statsX = filter.getStats(Dimension::Id::X);
+    EXPECT_NEAR(statsX.cardinality(), 10.0, .5);
+    EXPECT_EQ(filter.getMetadata().
+        findChild("statistic:cardinality").value<int>(), 10);
+}
+
+TEST(Stats, cardinality)
+{
+    stats::HyperLogLog h1;
+    stats::HyperLogLog h2;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        h1.insert(i);
+        h2.insert(i + 50000);
+    }
+    EXPECT_NEAR(h1.estimate(), 100000, 2000);
+    h1.merge(h2);
+    EXPECT_NEAR(h1.estimate(), 150000, 3000);
+
+    stats::HyperLogLog h3(10);
+    EXPECT_THROW(h1.merge(h3), pdal_error);
+}
+
+TEST(Stats, cardinality_precision)
+{
+    auto run = [](int precision)
+    {
+        Options ops;
+        ops.add("count", 100);
+        ops.add("mode", "ramp");
+        FauxReader reader;
+        reader.setOptions(ops);
+
+        Options filterOps;
+        filterOps.add("cardinality", "X");
+        filterOps.add("cardinality_precision", precision);
+        StatsFilter filter;
+        filter.setInput(reader);
+        filter.setOptions(filterOps);
+
+        PointTable table;
+        filter.prepare(table);
+    };
+
+    EXPECT_NO_THROW(run(4));
+    EXPECT_NO_THROW(run(18));
+    EXPECT_THROW(run(3), pdal_error);
+    EXPECT_THROW(run(30), pdal_error);
+}
+
+TEST(Stats, tdigest_merge)
+{
+    stats::TDigest d1;
+    stats::TDigest d2;
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        d1.insert(i);
+        d2.insert(i + 50000);
+    }
+    d1.merge(d2);
+    EXPECT_EQ(d1.count(), 100000u);
+    EXPECT_NEAR(d1.quantile(.5), 50000, 500);
+    EXPECT_NEAR(d1.quantile(.99), 99000, 200);
+    EXPECT_NEAR(d1.cdf(25000), .25, .01);
+    EXPECT_LT(d1.centroidCount(), 1000u);
+}
+
+TEST(Stats, merge)
+{
+    std::vector<double> vals;
+    for (int i = 0; i < 10000; ++i)
+        vals.push_back(std::sqrt((double)i) * ((i % 3) ? 1 : -1));
+
+    stats::Summary whole("X", stats::Summary::Count);
+    for (double v : vals)
+        whole.insert(v);
+
+    stats::Summary s1("X", stats::Summary::Count);
+    stats::Summary s2("X", stats::Summary::Count);
+    s1.insert(vals.data(), 2500);
+    s2.insert(vals.data() + 2500, vals.size() - 2500);
+    s1.merge(s2);
+
+    EXPECT_EQ(whole.count(), s1.count());
+    EXPECT_DOUBLE_EQ(whole.minimum(), s1.minimum());
+    EXPECT_DOUBLE_EQ(whole.maximum(), s1.maximum());
+    EXPECT_NEAR(whole.average(), s1.average(), 1e-10);
+    EXPECT_NEAR(whole.variance(), s1.variance(), 1e-8);
+    EXPECT_NEAR(whole.skewness(), s1.skewness(), 1e-8);
+    EXPECT_NEAR(whole.kurtosis(), s1.kurtosis(), 1e-8);
+    EXPECT_EQ(whole.values(), s1.values());
+}
+
+// Check the moments against values computed by hand.  The deviations
+// from the mean of 4 are -3, -2, -1, 0 and 6, so the sums of the second,
+// third and fourth powers of the deviations are 50, 180 and 1394.
+TEST(Stats, moments)
+{
+    const std::vector<double> vals { 1, 2, 3, 4, 10 };
+
+    stats::Summary single("X", stats::Summary::NoEnum);
+    for (double v : vals)
+        single.insert(v);
+
+    stats::Summary block("X", stats::Summary::NoEnum);
+    block.insert(vals.data(), vals.size());
+
+    for (const stats::Summary *s : { &single, &block })
+    {
+        EXPECT_EQ(s->count(), 5u);
+        EXPECT_DOUBLE_EQ(s->average(), 4.0);
+        EXPECT_DOUBLE_EQ(s->variance(), 50.0 / 4.0);
+        EXPECT_DOUBLE_EQ(s->stddev(), std::sqrt(50.0 / 4.0));
+        EXPECT_NEAR(s->skewness(),
+            std::sqrt(5.0) * 180.0 / std::pow(50.0, 1.5), 1e-12);
+        EXPECT_NEAR(s->kurtosis(), 5.0 * 1394.0 / (50.0 * 50.0) - 3.0,
+            1e-12);
+    }
+}
+
+// Statistics are the same, to the last bit, whatever the number of threads.
+TEST(Stats, threads)
+{
+    BOX3D bounds(0.0, 0.0, 0.0, 100.0, 100.0, 1000.0);
+    Options ops;
+    ops.add("bounds", bounds);
+    ops.add("count", 2500000);
+    ops.add("mode", "uniform");
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options serialOps;
+    serialOps.add("global", "Z");
+    serialOps.add("threads", 1);
+
+    StatsFilter serial;
+    serial.setInput(reader);
+    serial.setOptions(serialOps);
+
+    Options parallelOps;
+    parallelOps.add("global", "Z");
+    parallelOps.add("threads", 4);
+
+    StatsFilter parallel;
+    parallel.setInput(serial);
+    parallel.setOptions(parallelOps);
+
+    PointTable table;
+    parallel.prepare(table);
+    parallel.execute(table);
+
+    for (Dimension::Id dim : { Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Z })
+    {
+        const stats::Summary& s = serial.getStats(dim);
+        const stats::Summary& p = parallel.getStats(dim);
+
+        EXPECT_EQ(s.count(), 2500000u);
+        EXPECT_EQ(s.count(), p.count());
+        EXPECT_DOUBLE_EQ(s.minimum(), p.minimum());
+        EXPECT_DOUBLE_EQ(s.maximum(), p.maximum());
+        EXPECT_EQ(s.average(), p.average());
+        EXPECT_EQ(s.stddev(), p.stddev());
+        EXPECT_EQ(s.skewness(), p.skewness());
+        EXPECT_EQ(s.kurtosis(), p.kurtosis());
+    }
+    EXPECT_DOUBLE_EQ(serial.getStats(Dimension::Id::Z).median(),
+        parallel.getStats(Dimension::Id::Z).median());
+    EXPECT_DOUBLE_EQ(serial.getStats(Dimension::Id::Z).mad(),
+        parallel.getStats(Dimension::Id::Z).mad());
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <io/BufferReader.hpp>
+#include <io/FauxReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <filters/VoxelDownsizeFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Run the filter over seven points in three voxels and return the X
+// values of the points kept.
+std::vector<double> downsize(const std::string& mode)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDims({Id::X, Id::Y, Id::Z});
+
+    const double pts[][3] =
+    {
+        { 0.1, 0.1, 0.1 },
+        { 0.5, 0.5, 0.5 },
+        { 0.9, 0.9, 0.9 },
+        { 1.0, 0.5, 0.5 },
+        { 1.05, 0.5, 0.5 },
+        { 1.7, 0.5, 0.5 },
+        { -0.5, -0.5, -0.5 }
+    };
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 7; ++i)
+    {
+        view->setField(Id::X, i, pts[i][0]);
+        view->setField(Id::Y, i, pts[i][1]);
+        view->setField(Id::Z, i, pts[i][2]);
+    }
+
+    BufferReader r;
+    r.addView(view);
+
+    Options o;
+    o.add("cell", 1.0);
+    o.add("mode", mode);
+
+    VoxelDownsizeFilter f;
+    f.setInput(r);
+    f.setOptions(o);
+    f.prepare(table);
+    PointViewSet s = f.execute(table);
+    EXPECT_EQ(s.size(), 1u);
+
+    std::vector<double> xs;
+    PointViewPtr out = *s.begin();
+    for (PointId i = 0; i < out->size(); ++i)
+        xs.push_back(out->getFieldAs<double>(Id::X, i));
+    return xs;
+}
+
+} // unnamed namespace
+
+TEST(VoxelDownsizeFilterTest, create)
+{
+    StageFactory f;
+    Stage* filter(f.createStage("filters.voxeldownsize"));
+    EXPECT_TRUE(filter);
+}
+
+TEST(VoxelDownsizeFilterTest, modes)
+{
+    EXPECT_EQ(downsize("center"), std::vector<double>({ 0.5, 1.7, -0.5 }));
+    EXPECT_EQ(downsize("centroid"), std::vector<double>({ 0.5, 1.05, -0.5 }));
+    EXPECT_EQ(downsize("first"), std::vector<double>({ 0.1, 1.0, -0.5 }));
+
+    std::vector<double> xs = downsize("random");
+    ASSERT_EQ(xs.size(), 3u);
+    EXPECT_TRUE(xs[0] >= 0 && xs[0] < 1);
+    EXPECT_TRUE(xs[1] >= 1 && xs[1] < 2);
+    EXPECT_EQ(xs[2], -0.5);
+
+    EXPECT_THROW(downsize("foo"), pdal_error);
+}
+
+TEST(VoxelDownsizeFilterTest, stream)
+{
+    BOX3D bounds(0.0, 0.0, 0.0, 99.0, 99.0, 99.0);
+
+    Options ops;
+    ops.add("bounds", bounds);
+    ops.add("mode", "ramp");
+    ops.add("count", 100);
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options voxelOps;
+    voxelOps.add("cell", 10.0);
+    voxelOps.add("mode", "first");
+
+    VoxelDownsizeFilter voxel;
+    voxel.setOptions(voxelOps);
+    voxel.setInput(reader);
+    EXPECT_TRUE(voxel.pipelineStreamable());
+
+    StreamCallbackFilter filter;
+
+    // The ramp places ten points in each voxel along the diagonal.
+    int count = 0;
+    auto cb = [&count](PointRef& point)
+    {
+        int x = point.getFieldAs<int>(Dimension::Id::X);
+        EXPECT_EQ(x, count * 10);
+        count++;
+        return true;
+    };
+    filter.setCallback(cb);
+    filter.setInput(voxel);
+
+    FixedPointTable t(7);
+
+    filter.prepare(t);
+    filter.execute(t);
+    EXPECT_EQ(count, 10);
+
+    // The ramp is sorted by X, so the same points are kept when voxels
+    // behind the current point are dropped.
+    voxelOps.add("sorted", true);
+    VoxelDownsizeFilter sorted;
+    sorted.setOptions(voxelOps);
+    sorted.setInput(reader);
+
+    StreamCallbackFilter sortedFilter;
+    sortedFilter.setCallback(cb);
+    sortedFilter.setInput(sorted);
+
+    count = 0;
+    FixedPointTable t2(7);
+    sortedFilter.prepare(t2);
+    sortedFilter.execute(t2);
+    EXPECT_EQ(count, 10);
+
+    Options centerOps;
+    centerOps.add("mode", "center");
+    VoxelDownsizeFilter center;
+    center.setOptions(centerOps);
+    EXPECT_FALSE(center.pipelineStreamable());
+}
@@ -38,11 +38,13 @@
 
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <io/BpfReader.hpp>
 #include <io/BpfWriter.hpp>
 #include <io/BufferReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 
 #include "Support.hpp"
 
@@ -333,8 +335,160 @@ TEST(BPFTest, roundtrip_point_compression)
     ops.add("compression", true);
     test_roundtrip(ops);
 }
+
+TEST(BPFTest, roundtrip_filters)
+{
+    for (std::string format : { "DIMENSION", "BYTE" })
+    {
+        Options ops;
+
+        ops.add("format", format);
+        ops.add("compression", "zlib");
+        ops.add("shuffle", true);
+        ops.add("delta", true);
+        test_roundtrip(ops);
+
+        Options ops2;
+
+        ops2.add("format", format);
+        ops2.add("compression", "zlib");
+        ops2.add("delta", true);
+        test_roundtrip(ops2);
+    }
+}
+
+TEST(BPFTest, invalid_filters)
+{
+    auto test = [](const std::string& format, const std::string& compression)
+    {
+        Options ops;
+        ops.add("filename", Support::temppath("tmp.bpf"));
+        ops.add("format", format);
+        ops.add("compression", compression);
+        ops.add("delta", true);
+
+        BpfWriter writer;
+        writer.setOptions(ops);
+
+        PointTable table;
+        EXPECT_THROW(writer.prepare(table), pdal_error);
+    };
+    test("POINT", "zlib");
+    test("DIMENSION", "none");
+    test("DIMENSION", "foo");
+}
+
+// Write enough data to span several compressed blocks and verify that the
+// output doesn't depend on the number of threads.
+TEST(BPFTest, compression_threads)
+{
+    const point_count_t numPoints = 300000;
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+    table.layout()->registerDim(Dimension::Id::Intensity);
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < numPoints; ++i)
+    {
+        view->setField(Dimension::Id::X, i, i % 1000);
+        view->setField(Dimension::Id::Y, i, i / 1000);
+        view->setField(Dimension::Id::Z, i, (i * 7) % 113);
+        view->setField(Dimension::Id::Intensity, i, i % 65536);
+    }
+
+    for (std::string format : { "POINT", "DIMENSION", "BYTE" })
+    {
+        std::string serial(Support::temppath("tmp_serial.bpf"));
+        std::string parallel(Support::temppath("tmp_parallel.bpf"));
+
+        auto write = [&table, &view, &format](const std::string& filename,
+            int threads)
+        {
+            BufferReader r;
+            r.addView(view);
+
+            Options ops;
+            ops.add("filename", filename);
+            ops.add("format", format);
+            ops.add("compression", true);
+            ops.add("threads", threads);
+
+            BpfWriter w;
+            w.setOptions(ops);
+            w.setInput(r);
+
+            FileUtils::deleteFile(filename);
+            w.prepare(table);
+            w.execute(table);
+        };
+        write(serial, 1);
+        write(parallel, 4);
+
+        EXPECT_EQ(FileUtils::readFileIntoString(serial),
+            FileUtils::readFileIntoString(parallel)) << format;
+
+        for (int threads : { 1, 4 })
+        {
+            Options ops;
+            ops.add("filename", parallel);
+            ops.add("threads", threads);
+
+            BpfReader r;
+            r.setOptions(ops);
+
+            PointTable t;
+            r.prepare(t);
+            PointViewSet s = r.execute(t);
+            ASSERT_EQ(s.size(), 1u);
+            PointViewPtr v = *s.begin();
+            ASSERT_EQ(v->size(), numPoints) << format;
+            for (PointId i = 0; i < numPoints; i += 997)
+            {
+                EXPECT_EQ(v->getFieldAs<int>(Dimension::Id::X, i),
+                    (int)(i % 1000));
+                EXPECT_EQ(v->getFieldAs<int>(Dimension::Id::Y, i),
+                    (int)(i / 1000));
+                EXPECT_EQ(v->getFieldAs<int>(Dimension::Id::Z, i),
+                    (int)((i * 7) % 113));
+                EXPECT_EQ(v->getFieldAs<int>(Dimension::Id::Intensity, i),
+                    (int)(i % 65536));
+            }
+        }
+        FileUtils::deleteFile(serial);
+        FileUtils::deleteFile(parallel);
+    }
+}
 #endif // PDAL_HAVE_ZLIB
 
+#ifdef PDAL_HAVE_ZSTD
+TEST(BPFTest, roundtrip_zstd)
+{
+    for (std::string format : { "POINT", "DIMENSION", "BYTE" })
+    {
+        Options ops;
+
+        ops.add("format", format);
+        ops.add("compression", "zstd");
+        test_roundtrip(ops);
+
+        Options ops2;
+
+        ops2.add("format", format);
+        ops2.add("compression", "zstd");
+        ops2.add("compression_level", -5);
+        if (format != "POINT")
+        {
+            ops2.add("shuffle", true);
+            ops2.add("delta", true);
+        }
+        test_roundtrip(ops2);
+    }
+}
+#endif // PDAL_HAVE_ZSTD
+
 TEST(BPFTest, roundtrip_scaling)
 {
     Options ops;
@@ -766,3 +920,96 @@ TEST(BPFTest, autoutm)
     SpatialReference srs = reader2.getSpatialReference();
     EXPECT_EQ(srs.getUTMZone(), 10);
 }
+
+// Points outside the limits of a downstream filter shouldn't be loaded,
+// whatever the layout of the file.
+TEST(BPFTest, hint)
+{
+    for (auto file : { "bpf/autzen-utm-chipped-25-v3-interleaved.bpf",
+        "bpf/autzen-utm-chipped-25-v3.bpf",
+        "bpf/autzen-utm-chipped-25-v3-segregated.bpf" })
+    {
+        Options ro;
+        ro.add("filename", Support::datapath(file));
+
+        // Keep the points in the lower half of the file's X range.
+        BpfReader full;
+        full.setOptions(ro);
+        PointTable fullTable;
+        full.prepare(fullTable);
+        PointViewSet fullSet = full.execute(fullTable);
+        PointViewPtr fullView = *fullSet.begin();
+        BOX3D bounds;
+        fullView->calculateBounds(bounds);
+        double split = (bounds.minx + bounds.maxx) / 2;
+
+        std::vector<double> expected;
+        for (PointId i = 0; i < fullView->size(); ++i)
+        {
+            double x = fullView->getFieldAs<double>(Dimension::Id::X, i);
+            if (x <= split)
+                expected.push_back(x);
+        }
+        ASSERT_GT(expected.size(), 0u);
+        ASSERT_LT(expected.size(), fullView->size());
+
+        Options fo;
+        fo.add("limits", "X[" + Utils::toString(bounds.minx - 1, 10) + ":" +
+            Utils::toString(split, 10) + "]");
+
+        // Standard mode.
+        {
+            BpfReader reader;
+            reader.setOptions(ro);
+            point_count_t loaded = 0;
+            reader.setReadCb([&loaded](PointView&, PointId){ loaded++; });
+
+            StageFactory factory;
+            Stage *range = factory.createStage("filters.range");
+            range->setOptions(fo);
+            range->setInput(reader);
+
+            PointTable table;
+            range->prepare(table);
+            PointViewSet s = range->execute(table);
+            PointViewPtr v = *s.begin();
+            EXPECT_EQ(loaded, expected.size()) << file;
+            ASSERT_EQ(v->size(), expected.size()) << file;
+            for (PointId i = 0; i < v->size(); ++i)
+                EXPECT_EQ(v->getFieldAs<double>(Dimension::Id::X, i),
+                    expected[i]);
+        }
+
+        // Stream mode.
+        {
+            BpfReader reader;
+            reader.setOptions(ro);
+
+            StageFactory factory;
+            Stage *range = factory.createStage("filters.range");
+            range->setOptions(fo);
+            range->setInput(reader);
+
+            StreamCallbackFilter f;
+            std::vector<double> xs;
+            f.setCallback([&xs](PointRef& p)
+            {
+                xs.push_back(p.getFieldAs<double>(Dimension::Id::X));
+                return true;
+            });
+            f.setInput(*range);
+
+            FixedPointTable table(100);
+            f.prepare(table);
+            f.execute(table);
+            // readers.bpf doesn't stream the last point of a file, so
+            // expect one less point if the last point passes.
+            double lastX = fullView->getFieldAs<double>(Dimension::Id::X,
+                fullView->size() - 1);
+            ASSERT_EQ(xs.size(), expected.size() - (lastX <= split ? 1 : 0))
+                << file;
+            for (size_t i = 0; i < xs.size(); ++i)
+                EXPECT_EQ(xs[i], expected[i]);
+        }
+    }
+}
@@ -0,0 +1,267 @@
+/******************************************************************************
+* Copyright (c) 2018, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <filters/StreamCallbackFilter.hpp>
+#include <io/ColumnarReader.hpp>
+#include <io/ColumnarWriter.hpp>
+#include <io/LasReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+PointViewPtr readLas(PointTable& table)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    LasReader r;
+    r.setOptions(ops);
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    return *s.begin();
+}
+
+void writeColumnar(const std::string& filename, const std::string& codec)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    LasReader r;
+    r.setOptions(ro);
+
+    Options wo;
+    wo.add("filename", filename);
+    wo.add("compression", codec);
+    wo.add("chunk_size", 100);
+    wo.add("threads", 4);
+
+    ColumnarWriter w;
+    w.setOptions(wo);
+    w.setInput(r);
+
+    FileUtils::deleteFile(filename);
+    PointTable t;
+    w.prepare(t);
+    w.execute(t);
+}
+
+PointViewPtr readColumnar(PointTable& table, Options ops)
+{
+    ColumnarReader r;
+    r.setOptions(ops);
+    r.prepare(table);
+    PointViewSet s = r.execute(table);
+    EXPECT_EQ(s.size(), 1u);
+    return *s.begin();
+}
+
+} // unnamed namespace
+
+TEST(ColumnarTest, roundtrip)
+{
+    std::string filename(Support::temppath("columnar.pcol"));
+
+    PointTable origTable;
+    PointViewPtr orig = readLas(origTable);
+
+    for (std::string codec : { "none", "deflate", "zstd", "lzma" })
+    {
+        std::istringstream in(codec);
+        columnar::Codec c;
+        in >> c;
+        if (!columnar::supported(c))
+            continue;
+
+        writeColumnar(filename, codec);
+
+        Options ro;
+        ro.add("filename", filename);
+        ro.add("threads", 3);
+
+        PointTable table;
+        PointViewPtr view = readColumnar(table, ro);
+
+        ASSERT_EQ(view->size(), orig->size());
+        EXPECT_EQ(table.layout()->dims().size(),
+            origTable.layout()->dims().size());
+        EXPECT_FALSE(view->spatialReference().empty());
+        for (Dimension::Id id : origTable.layout()->dims())
+        {
+            ASSERT_EQ(table.layout()->dimType(id),
+                origTable.layout()->dimType(id));
+            for (PointId idx = 0; idx < view->size(); ++idx)
+                EXPECT_EQ(view->getFieldAs<double>(id, idx),
+                    orig->getFieldAs<double>(id, idx));
+        }
+    }
+    FileUtils::deleteFile(filename);
+}
+
+TEST(ColumnarTest, dimensions)
+{
+    std::string filename(Support::temppath("columnar.pcol"));
+    writeColumnar(filename, "none");
+
+    PointTable origTable;
+    PointViewPtr orig = readLas(origTable);
+
+    Options ro;
+    ro.add("filename", filename);
+    ro.add("dimensions", "Classification, Y");
+
+    PointTable table;
+    PointViewPtr view = readColumnar(table, ro);
+
+    Dimension::IdList dims = table.layout()->dims();
+    ASSERT_EQ(dims.size(), 2u);
+    EXPECT_TRUE(table.layout()->hasDim(Dimension::Id::Y));
+    EXPECT_TRUE(table.layout()->hasDim(Dimension::Id::Classification));
+    ASSERT_EQ(view->size(), orig->size());
+    for (PointId idx = 0; idx < view->size(); ++idx)
+    {
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::Y, idx),
+            orig->getFieldAs<double>(Dimension::Id::Y, idx));
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::Classification, idx),
+            orig->getFieldAs<int>(Dimension::Id::Classification, idx));
+    }
+
+    Options bad;
+    bad.add("filename", filename);
+    bad.add("dimensions", "Foo");
+
+    ColumnarReader r;
+    r.setOptions(bad);
+    PointTable t;
+    EXPECT_THROW(r.prepare(t), pdal_error);
+    FileUtils::deleteFile(filename);
+}
+
+// Points outside the bounds are dropped, both in standard and streaming
+// mode.  Coordinates needed for the test needn't be requested.
+TEST(ColumnarTest, bounds)
+{
+    std::string filename(Support::temppath("columnar.pcol"));
+    writeColumnar(filename, "deflate");
+
+    PointTable origTable;
+    PointViewPtr orig = readLas(origTable);
+
+    BOX2D box;
+    orig->calculateBounds(box);
+    box.maxx = (box.minx + box.maxx) / 2;
+    std::ostringstream oss;
+    oss.precision(17);
+    oss << "([" << box.minx << ", " << box.maxx << "], [" << box.miny <<
+        ", " << box.maxy << "])";
+
+    point_count_t expected = 0;
+    for (PointId idx = 0; idx < orig->size(); ++idx)
+        if (box.contains(orig->getFieldAs<double>(Dimension::Id::X, idx),
+                orig->getFieldAs<double>(Dimension::Id::Y, idx)))
+            expected++;
+    ASSERT_GT(expected, 0u);
+    ASSERT_LT(expected, orig->size());
+
+    Options ro;
+    ro.add("filename", filename);
+    ro.add("bounds", oss.str());
+    ro.add("dimensions", "Intensity");
+
+    PointTable table;
+    PointViewPtr view = readColumnar(table, ro);
+    EXPECT_EQ(view->size(), expected);
+    EXPECT_EQ(table.layout()->dims().size(), 1u);
+
+    point_count_t streamed = 0;
+    ColumnarReader r;
+    r.setOptions(ro);
+
+    StreamCallbackFilter f;
+    f.setCallback([&streamed](PointRef&)
+    {
+        streamed++;
+        return true;
+    });
+    f.setInput(r);
+
+    FixedPointTable fixed(100);
+    f.prepare(fixed);
+    f.execute(fixed);
+    EXPECT_EQ(streamed, expected);
+    FileUtils::deleteFile(filename);
+}
+
+TEST(ColumnarTest, inspect)
+{
+    std::string filename(Support::temppath("columnar.pcol"));
+    writeColumnar(filename, "none");
+
+    PointTable origTable;
+    PointViewPtr orig = readLas(origTable);
+    BOX3D box;
+    orig->calculateBounds(box);
+
+    Options ro;
+    ro.add("filename", filename);
+
+    ColumnarReader r;
+    r.setOptions(ro);
+    QuickInfo qi = r.preview();
+
+    EXPECT_TRUE(qi.valid());
+    EXPECT_EQ(qi.m_pointCount, orig->size());
+    EXPECT_EQ(qi.m_bounds, box);
+    EXPECT_EQ(qi.m_dimNames.size(), origTable.layout()->dims().size());
+    FileUtils::deleteFile(filename);
+}
+
+TEST(ColumnarTest, invalid)
+{
+    Options ro;
+    ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+    ColumnarReader r;
+    r.setOptions(ro);
+    PointTable t;
+    EXPECT_THROW(r.prepare(t), pdal_error);
+}
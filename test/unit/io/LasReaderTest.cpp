@@ -39,6 +39,7 @@
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/Streamable.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <io/LasReader.hpp>
 #include "Support.hpp"
 
@@ -533,3 +534,126 @@ TEST(LasReaderTest, IgnoreVLRs)
     }
 
 }
+
+// Only dimensions used by the filters and writer of a pipeline should be
+// loaded.
+TEST(LasReaderTest, projection)
+{
+    using namespace Dimension;
+
+    std::string outfile(Support::temppath("projection.txt"));
+
+    auto run = [&outfile](bool write, PointTableRef table)
+    {
+        StageFactory f;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage *r = f.createStage("readers.las");
+        r->setOptions(ro);
+
+        Options fo;
+        fo.add("limits", "Classification[2:2]");
+        Stage *range = f.createStage("filters.range");
+        range->setOptions(fo);
+        range->setInput(*r);
+
+        Stage *last = range;
+        if (write)
+        {
+            Options wo;
+            wo.add("filename", outfile);
+            wo.add("order", "X,Y,Z,Intensity:0");
+            wo.add("keep_unspecified", false);
+            last = f.createStage("writers.text");
+            last->setOptions(wo);
+            last->setInput(*range);
+        }
+        last->prepare(table);
+        return last->execute(table);
+    };
+
+    PointTable table;
+    PointViewSet s = run(true, table);
+    PointLayoutPtr layout(table.layout());
+    EXPECT_TRUE(layout->hasDim(Id::X));
+    EXPECT_TRUE(layout->hasDim(Id::Y));
+    EXPECT_TRUE(layout->hasDim(Id::Z));
+    EXPECT_TRUE(layout->hasDim(Id::Intensity));
+    EXPECT_TRUE(layout->hasDim(Id::Classification));
+    EXPECT_FALSE(layout->hasDim(Id::ReturnNumber));
+    EXPECT_FALSE(layout->hasDim(Id::GpsTime));
+    EXPECT_FALSE(layout->hasDim(Id::Red));
+
+    // Without a writer, all dimensions are loaded.
+    PointTable fullTable;
+    PointViewSet fs = run(false, fullTable);
+    EXPECT_TRUE(fullTable.layout()->hasDim(Id::GpsTime));
+    EXPECT_TRUE(fullTable.layout()->hasDim(Id::Red));
+
+    ASSERT_EQ(s.size(), 1u);
+    ASSERT_EQ(fs.size(), 1u);
+    PointViewPtr v = *s.begin();
+    PointViewPtr fv = *fs.begin();
+    ASSERT_EQ(v->size(), 276u);
+    ASSERT_EQ(v->size(), fv->size());
+    for (PointId i = 0; i < v->size(); ++i)
+    {
+        EXPECT_EQ(v->getFieldAs<double>(Id::X, i),
+            fv->getFieldAs<double>(Id::X, i));
+        EXPECT_EQ(v->getFieldAs<int>(Id::Intensity, i),
+            fv->getFieldAs<int>(Id::Intensity, i));
+    }
+    FileUtils::deleteFile(outfile);
+}
+
+// Points outside the limits of downstream filters shouldn't be loaded.
+TEST(LasReaderTest, hint)
+{
+    auto run = [](const std::string& filter, const Options& opts,
+        point_count_t& loaded)
+    {
+        StageFactory f;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage *r = f.createStage("readers.las");
+        r->setOptions(ro);
+        loaded = 0;
+        dynamic_cast<Reader *>(r)->setReadCb(
+            [&loaded](PointView&, PointId){ loaded++; });
+
+        Stage *s = f.createStage(filter);
+        s->setOptions(opts);
+        s->setInput(*r);
+
+        PointTable table;
+        s->prepare(table);
+        PointViewSet viewSet = s->execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return (*viewSet.begin())->size();
+    };
+
+    point_count_t loaded;
+
+    Options rangeOpts;
+    rangeOpts.add("limits", "X[636000:637000]");
+    EXPECT_EQ(run("filters.range", rangeOpts, loaded), 329u);
+    EXPECT_EQ(loaded, 329u);
+
+    Options cropOpts;
+    cropOpts.add("bounds", "([636000, 637000], [849000, 850000])");
+    EXPECT_EQ(run("filters.crop", cropOpts, loaded), 57u);
+    EXPECT_EQ(loaded, 57u);
+
+    // Points outside the crop region are kept, so nothing can be skipped.
+    cropOpts.add("outside", true);
+    EXPECT_EQ(run("filters.crop", cropOpts, loaded), 1065u - 57u);
+    EXPECT_EQ(loaded, 1065u);
+
+    // The file is skipped entirely if it's outside the region.
+    Options outsideOpts;
+    outsideOpts.add("bounds", "([0, 1], [0, 1])");
+    EXPECT_EQ(run("filters.crop", outsideOpts, loaded), 0u);
+    EXPECT_EQ(loaded, 0u);
+}
@@ -35,6 +35,7 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <stdlib.h>
+#include <fstream>
 
 #include <pdal/pdal_features.hpp>
 #include <pdal/PointView.hpp>
@@ -43,6 +44,7 @@
 #include <pdal/util/FileUtils.hpp>
 #include <io/BufferReader.hpp>
 #include <io/LasHeader.hpp>
+#include <io/LasHierarchy.hpp>
 #include <io/LasReader.hpp>
 #include <io/LasWriter.hpp>
 #include <io/BpfReader.hpp>
@@ -461,6 +463,186 @@ TEST(LasWriterTest, flex)
     }
 }
 
+// Test that views written concurrently by a templated writer end up in the
+// same files as when written serially.
+TEST(LasWriterTest, flex_threads)
+{
+    std::array<std::string, 3> outname =
+        {{ "test_1.las", "test_2.las", "test_3.las" }};
+
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/simple.las"));
+
+    PointTable table;
+
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    reader.prepare(table);
+    PointViewSet views = reader.execute(table);
+    PointViewPtr v = *(views.begin());
+
+    std::vector<PointViewPtr> vs;
+    for (size_t i = 0; i < outname.size(); ++i)
+        vs.push_back(PointViewPtr(new PointView(table)));
+    for (PointId i = 0; i < v->size(); ++i)
+        vs[i % 3]->appendPoint(*v, i);
+
+    for (size_t i = 0; i < outname.size(); ++i)
+        FileUtils::deleteFile(Support::temppath(outname[i]));
+
+    BufferReader reader2;
+    for (PointViewPtr vp : vs)
+        reader2.addView(vp);
+
+    Options writerOps;
+    writerOps.add("filename", Support::temppath("test_#.las"));
+    writerOps.add("file_threads", 3);
+    writerOps.add("forward", "header");
+
+    LasWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(reader2);
+
+    writer.prepare(table);
+    writer.execute(table);
+
+    for (size_t i = 0; i < outname.size(); ++i)
+    {
+        Options ops;
+        ops.add("filename", Support::temppath(outname[i]));
+
+        LasReader r;
+        r.setOptions(ops);
+
+        PointTable t;
+        r.prepare(t);
+        PointViewSet s = r.execute(t);
+        PointViewPtr out = *s.begin();
+        PointViewPtr in = vs[i];
+        ASSERT_EQ(out->size(), in->size());
+        for (PointId idx = 0; idx < in->size(); ++idx)
+        {
+            EXPECT_EQ(out->getFieldAs<int>(Dimension::Id::X, idx),
+                in->getFieldAs<int>(Dimension::Id::X, idx));
+            EXPECT_EQ(out->getFieldAs<int>(Dimension::Id::Intensity, idx),
+                in->getFieldAs<int>(Dimension::Id::Intensity, idx));
+        }
+        MetadataNode m = r.getMetadata();
+        EXPECT_EQ(m.findChild("software_id").value(), "TerraScan");
+    }
+}
+
+// Test that the output filenames are reported in file order whether or not
+// files are written concurrently.
+TEST(LasWriterTest, flex_threads_metadata)
+{
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/simple.las"));
+
+    auto run = [&readerOps](int threads) -> std::vector<std::string>
+    {
+        PointTable table;
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        reader.prepare(table);
+        PointViewSet views = reader.execute(table);
+        PointViewPtr v = *(views.begin());
+
+        BufferReader reader2;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            PointViewPtr vp(new PointView(table));
+            for (PointId idx = i; idx < v->size(); idx += 3)
+                vp->appendPoint(*v, idx);
+            reader2.addView(vp);
+        }
+
+        Options writerOps;
+        writerOps.add("filename", Support::temppath("meta_#.las"));
+        writerOps.add("file_threads", threads);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader2);
+
+        writer.prepare(table);
+        writer.execute(table);
+
+        std::vector<std::string> names;
+        for (MetadataNode& m : writer.getMetadata().children("filename"))
+            names.push_back(m.value());
+        return names;
+    };
+
+    std::vector<std::string> serial = run(1);
+    std::vector<std::string> parallel = run(3);
+    EXPECT_EQ(serial.size(), 3u);
+    EXPECT_EQ(serial, parallel);
+    for (size_t i = 1; i <= 3; ++i)
+        FileUtils::deleteFile(
+            Support::temppath("meta_" + std::to_string(i) + ".las"));
+}
+
+// Test that files written concurrently log to the writer's log.
+TEST(LasWriterTest, flex_threads_log)
+{
+    std::string logname(Support::temppath("flex_threads.log"));
+    FileUtils::deleteFile(logname);
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/simple.las"));
+
+        PointTable table;
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        reader.prepare(table);
+        PointViewSet views = reader.execute(table);
+        PointViewPtr v = *(views.begin());
+
+        BufferReader reader2;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            PointViewPtr vp(new PointView(table));
+            for (PointId idx = i; idx < v->size(); idx += 3)
+                vp->appendPoint(*v, idx);
+            reader2.addView(vp);
+        }
+
+        Options writerOps;
+        writerOps.add("filename", Support::temppath("log_#.las"));
+        writerOps.add("file_threads", 3);
+        writerOps.add("log", logname);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader2);
+        LogPtr log(new Log("", "devnull"));
+        log->setLevel(LogLevel::Debug);
+        writer.setLog(log);
+
+        writer.prepare(table);
+        writer.execute(table);
+    }
+
+    std::ifstream in(logname);
+    std::string line;
+    size_t count = 0;
+    while (std::getline(in, line))
+        if (line.find("(writers.las Debug) Wrote ") == 0)
+            count++;
+    EXPECT_EQ(count, 3u);
+
+    FileUtils::deleteFile(logname);
+    for (size_t i = 1; i <= 3; ++i)
+        FileUtils::deleteFile(
+            Support::temppath("log_" + std::to_string(i) + ".las"));
+}
+
 // Test that data from three input views gets written to a single output file.
 TEST(LasWriterTest, flex2)
 {
@@ -1117,6 +1299,218 @@ TEST(LasWriterTest, oversize_vlr)
         pdal_error);
 }
 
+TEST(LasWriterTest, cloud_optimized)
+{
+    std::string infile(Support::datapath("las/autzen_trim.las"));
+
+    auto write = [&infile](const std::string& outfile,
+        const std::string& compression)
+    {
+        FileUtils::deleteFile(outfile);
+
+        Options ro;
+        ro.add("filename", infile);
+        LasReader r;
+        r.setOptions(ro);
+
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("cloud_optimized", true);
+        wo.add("chunk_size", 5000);
+        if (compression.size())
+            wo.add("compression", compression);
+        LasWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        PointTable t;
+        w.prepare(t);
+        w.execute(t);
+    };
+
+    auto count = [](const std::string& filename, const Options& opts)
+    {
+        Options ro(opts);
+        ro.add("filename", filename);
+        LasReader r;
+        r.setOptions(ro);
+
+        PointTable t;
+        r.prepare(t);
+        PointViewSet s = r.execute(t);
+        EXPECT_EQ(s.size(), 1u);
+        return (*s.begin())->size();
+    };
+
+    auto test = [&](const std::string& outfile, const Options& readOpts)
+    {
+        Options o(readOpts);
+        EXPECT_EQ(count(outfile, o), 110000u);
+
+        // Points read by chunk match the points read from the original file.
+        Options bounds(readOpts);
+        bounds.add("bounds", "([636200, 636400], [849000, 849200])");
+        point_count_t expected = count(infile, bounds);
+        EXPECT_GT(expected, 0u);
+        EXPECT_EQ(count(outfile, bounds), expected);
+
+        // Coarser resolutions read fewer points.
+        Options coarse(readOpts);
+        coarse.add("resolution", 100);
+        Options fine(readOpts);
+        fine.add("resolution", 5);
+        point_count_t coarseCount = count(outfile, coarse);
+        point_count_t fineCount = count(outfile, fine);
+        EXPECT_GT(coarseCount, 0u);
+        EXPECT_LT(coarseCount, fineCount);
+        EXPECT_LE(fineCount, 110000u);
+    };
+
+    std::string outfile(Support::temppath("cloud.las"));
+    write(outfile, "");
+    {
+        Options ro;
+        ro.add("filename", outfile);
+        LasReader r;
+        r.setOptions(ro);
+        PointTable t;
+        r.prepare(t);
+        const LasVLR *vlr = r.header().findVlr("PDAL", 14);
+        ASSERT_NE(vlr, nullptr);
+
+        LasHierarchy h;
+        h.read(vlr->data(), vlr->dataLen());
+        EXPECT_EQ(h.numPoints(), 110000u);
+        EXPECT_EQ(h.numChunks(), 22u);
+        EXPECT_TRUE(h.located());
+    }
+    test(outfile, Options());
+    FileUtils::deleteFile(outfile);
+
+#ifdef PDAL_HAVE_LAZPERF
+    outfile = Support::temppath("cloud.laz");
+    write(outfile, "lazperf");
+    Options lazperf;
+    lazperf.add("compression", "lazperf");
+    test(outfile, lazperf);
+    FileUtils::deleteFile(outfile);
+#endif
+}
+
+// A hierarchy too large for a VLR can only be written to LAS 1.4 output.
+TEST(LasWriterTest, cloud_optimized_evlr)
+{
+    std::string outfile(Support::temppath("cloud_evlr.las"));
+
+    auto write = [&outfile](int minorVersion)
+    {
+        FileUtils::deleteFile(outfile);
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/simple.las"));
+        LasReader r;
+        r.setOptions(ro);
+
+        // 1065 chunks of one point need more than 64K of hierarchy.
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("cloud_optimized", true);
+        wo.add("chunk_size", 1);
+        wo.add("minor_version", minorVersion);
+        LasWriter w;
+        w.setOptions(wo);
+        w.setInput(r);
+
+        PointTable t;
+        w.prepare(t);
+        w.execute(t);
+    };
+
+    EXPECT_THROW(write(2), pdal_error);
+    EXPECT_FALSE(FileUtils::fileExists(outfile));
+
+    write(4);
+    Options ro;
+    ro.add("filename", outfile);
+    LasReader r;
+    r.setOptions(ro);
+    PointTable t;
+    r.prepare(t);
+    const LasVLR *vlr = r.header().findVlr("PDAL", 14);
+    ASSERT_NE(vlr, nullptr);
+
+    LasHierarchy h;
+    h.read(vlr->data(), vlr->dataLen());
+    EXPECT_EQ(h.numChunks(), 1065u);
+    EXPECT_TRUE(h.located());
+
+    PointViewSet s = r.execute(t);
+    EXPECT_EQ((*s.begin())->size(), 1065u);
+    FileUtils::deleteFile(outfile);
+}
+
+// A LAS reader feeding a LAS writer should load only the dimensions of
+// the output point format.
+TEST(LasWriterTest, projection)
+{
+    using namespace Dimension;
+
+    std::string outfile(Support::temppath("projection.las"));
+
+    auto run = [&outfile](const Options& writerOps, PointTableRef table)
+    {
+        StageFactory f;
+
+        Options ro;
+        ro.add("filename", Support::datapath("las/1.2-with-color.las"));
+        Stage *r = f.createStage("readers.las");
+        r->setOptions(ro);
+
+        Stage *w = f.createStage("writers.las");
+        Options wo(writerOps);
+        wo.add("filename", outfile);
+        w->setOptions(wo);
+        w->setInput(*r);
+
+        w->prepare(table);
+        w->execute(table);
+    };
+
+    Options format0;
+    format0.add("dataformat_id", 0);
+    PointTable t0;
+    run(format0, t0);
+    EXPECT_TRUE(t0.layout()->hasDim(Id::X));
+    EXPECT_TRUE(t0.layout()->hasDim(Id::Intensity));
+    EXPECT_TRUE(t0.layout()->hasDim(Id::Classification));
+    EXPECT_FALSE(t0.layout()->hasDim(Id::GpsTime));
+    EXPECT_FALSE(t0.layout()->hasDim(Id::Red));
+
+    PointTable t3;
+    run(Options(), t3);
+    EXPECT_TRUE(t3.layout()->hasDim(Id::GpsTime));
+    EXPECT_TRUE(t3.layout()->hasDim(Id::Red));
+
+    // When the format is forwarded, everything is loaded.
+    Options forward;
+    forward.add("dataformat_id", 0);
+    forward.add("forward", "header");
+    PointTable tf;
+    run(forward, tf);
+    EXPECT_TRUE(tf.layout()->hasDim(Id::GpsTime));
+
+    LasReader r;
+    Options ro;
+    ro.add("filename", outfile);
+    r.setOptions(ro);
+    PointTable t;
+    r.prepare(t);
+    PointViewSet s = r.execute(t);
+    ASSERT_EQ(s.size(), 1u);
+    EXPECT_EQ((*s.begin())->size(), 1065u);
+    FileUtils::deleteFile(outfile);
+}
+
 
 /**
 
@@ -39,6 +39,7 @@
 #include <io/LasReader.hpp>
 #include <io/LasWriter.hpp>
 #include <io/TextReader.hpp>
+#include <filters/StreamCallbackFilter.hpp>
 #include <pdal/util/FileUtils.hpp>
 
 using namespace pdal;
@@ -268,3 +269,67 @@ TEST(TextReaderTest, insertHeader)
     EXPECT_TRUE(layout->findDim("C") != Dimension::Id::Unknown);
     EXPECT_TRUE(layout->findDim("G") != Dimension::Id::Unknown);
 }
+
+// Read a file on several threads and make sure the points match those
+// read by streaming.
+TEST(TextReaderTest, threads)
+{
+    std::string filename(Support::temppath("threads.txt"));
+
+    std::ostream *out = FileUtils::createFile(filename);
+    *out << "X, Y, Z\n";
+    for (int i = 0; i < 200000; ++i)
+    {
+        if (i % 1000 == 0)
+            *out << "\n";
+        if (i % 5000 == 1)
+            *out << "1,2\n";
+        *out << i << ", " << (i * .01) << ",  " << (i * 1e-5) << "e2";
+        *out << ((i % 2) ? "\r\n" : "\n");
+    }
+    FileUtils::closeFile(out);
+
+    Options options;
+    options.add("filename", filename);
+    options.add("threads", 4);
+
+    TextReader reader;
+    reader.setOptions(options);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet s = reader.execute(table);
+    EXPECT_EQ(s.size(), 1U);
+    PointViewPtr v = *s.begin();
+    ASSERT_EQ(v->size(), 200000U);
+
+    Options streamOptions;
+    streamOptions.add("filename", filename);
+
+    TextReader streamReader;
+    streamReader.setOptions(streamOptions);
+
+    PointId id = 0;
+    StreamCallbackFilter f;
+    auto cb = [&id, v](PointRef& point)
+    {
+        for (Dimension::Id dim : { Dimension::Id::X, Dimension::Id::Y,
+            Dimension::Id::Z })
+            EXPECT_DOUBLE_EQ(point.getFieldAs<double>(dim),
+                v->getFieldAs<double>(dim, id));
+        id++;
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(streamReader);
+
+    FixedPointTable t(1000);
+    f.prepare(t);
+    f.execute(t);
+    EXPECT_EQ(id, 200000U);
+
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, 12345), 12345);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Y, 12345), 123.45);
+    EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::Z, 12345), 12.345);
+    FileUtils::deleteFile(filename);
+}
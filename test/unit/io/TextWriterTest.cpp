@@ -38,6 +38,7 @@
 
 #include <pdal/util/FileUtils.hpp>
 #include <io/BufferReader.hpp>
+#include <io/LasReader.hpp>
 #include <io/TextReader.hpp>
 #include <io/TextWriter.hpp>
 
@@ -153,3 +154,56 @@ TEST(TextWriterTest, precision)
     EXPECT_NE(out.find("3,3,3,3"), std::string::npos);
 }
 
+
+// Output should be the same whether formatted on one thread, several
+// threads or when streaming.
+TEST(TextWriterTest, threads)
+{
+    std::string infile(Support::datapath("las/autzen_trim.las"));
+
+    auto writeFile = [&infile](const std::string& format, size_t threads,
+        bool stream)
+    {
+        std::string outfile(Support::temppath("threads_" + format + "_" +
+            std::to_string(threads) + (stream ? "_s" : "") + ".txt"));
+
+        LasReader r;
+        Options ro;
+        ro.add("filename", infile);
+        r.setOptions(ro);
+
+        TextWriter w;
+        Options wo;
+        wo.add("filename", outfile);
+        wo.add("format", format);
+        wo.add("order", "X:2,Y:2,Z:5,GpsTime:7");
+        wo.add("threads", threads);
+        w.setOptions(wo);
+        w.setInput(r);
+
+        if (stream)
+        {
+            FixedPointTable t(1000);
+            w.prepare(t);
+            w.execute(t);
+        }
+        else
+        {
+            PointTable t;
+            w.prepare(t);
+            w.execute(t);
+        }
+        return outfile;
+    };
+
+    for (std::string format : { "csv", "geojson" })
+    {
+        std::string serial = writeFile(format, 1, false);
+        std::string parallel = writeFile(format, 4, false);
+        std::string streamed = writeFile(format, 1, true);
+
+        EXPECT_TRUE(Support::compare_text_files(serial, parallel));
+        EXPECT_TRUE(Support::compare_text_files(serial, streamed));
+        EXPECT_GT(FileUtils::fileSize(serial), 1000000U);
+    }
+}